@@ -3,6 +3,8 @@
 // This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
 // distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
+using EpicGames.Core;
+using Microsoft.Extensions.Logging;
 using UnrealBuildTool;
 
 public class OpenPF2PlaygroundTarget : TargetRules
@@ -13,5 +15,50 @@ public class OpenPF2PlaygroundTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V4;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_3;
 		ExtraModuleNames.Add("OpenPF2Playground");
+
+		// Used by the encounter roster of the game state to only replicate when it has changed.
+		bWithPushModel = true;
+
+		ConfigurePrecompiledGameplayTags(this, Target);
+	}
+
+	// Shipping builds load gameplay tags from the data table precompiled by the OpenPF2PlaygroundGameplayTagTable
+	// commandlet instead of parsing the ini files in Config/Tags at startup. Other builds keep using the ini files, so
+	// that tags can be edited without precompiling them again. This is shared with the Server target, since clients and
+	// servers must agree on the same tags to replicate them to each other.
+	//
+	// A stale table is caught when the game is cooked (see UOpenPF2PlaygroundAssetManager::ModifyCook()) rather than
+	// here, since verifying it requires an editor build that might not exist on machines that only compile Shipping.
+	public static void ConfigurePrecompiledGameplayTags(TargetRules Rules, TargetInfo Target)
+	{
+		FileReference TablePath;
+
+		if ((Target.Configuration != UnrealTargetConfiguration.Shipping) || (Target.ProjectFile == null))
+		{
+			return;
+		}
+
+		TablePath = FileReference.Combine(
+			Target.ProjectFile.Directory,
+			"Content",
+			"OpenPF2Playground",
+			"Tags",
+			"DT_PrecompiledGameplayTags.uasset"
+		);
+
+		// Until the table has been precompiled and committed, keep importing tags from the ini files; otherwise, the
+		// game would start without any of the tags of the project.
+		if (!FileReference.Exists(TablePath))
+		{
+			Rules.Logger.LogWarning(
+				"Precompiled gameplay tag table '{TablePath}' does not exist; gameplay tags will be loaded from the " +
+				"ini files. Run the OpenPF2PlaygroundGameplayTagTable commandlet to create it.",
+				TablePath
+			);
+
+			return;
+		}
+
+		Rules.CustomConfig = "PrecompiledGameplayTags";
 	}
 }
@@ -34,9 +34,10 @@ public:
 	/**
 	 * Loads input action bindings for all of the granted, activatable abilities of this character.
 	 *
-	 * If this character has any abilities already bound to input, those bindings are cleared before the input is bound.
-	 * If the input bindings component is already wired-up to input for this character, the actions are bound to input
-	 * actions immediately.
+	 * If this character has any abilities already bound to input, implementations may either clear those bindings
+	 * before the input is bound, or only add and remove the bindings for abilities that have been granted or revoked
+	 * since the last load. If the input bindings component is already wired-up to input for this character, the
+	 * actions are bound to input actions immediately.
 	 *
 	 * On the client side, this should be invoked by the player controller whenever the abilities of this character may
 	 * have changed. At a minimum, this must be invoked when a player is taking control of a character. This is a
@@ -23,8 +23,15 @@ public class OpenPF2Playground : ModuleRules
 		PrivateDependencyModuleNames.AddRange(new string[]
 		{
 			"OpenPF2GameFramework",
+			"AIModule",
+			"AssetRegistry",
 			"EnhancedInput",
-			"GameplayAbilities"
+			"GameplayAbilities",
+			"GameplayTags",
+			"Json",
+			"NetCore",
+			"OnlineSubsystemUtils",
+			"ReplicationGraph",
 		});
 	}
 }
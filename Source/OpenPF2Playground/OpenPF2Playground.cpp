@@ -14,3 +14,30 @@ IMPLEMENT_PRIMARY_GAME_MODULE(FDefaultGameModuleImpl, OpenPF2Playground, "OpenPF
 // =====================================================================================================================
 DEFINE_LOG_CATEGORY(LogPf2Playground);
 DEFINE_LOG_CATEGORY(LogPf2PlaygroundInput);
+
+// =====================================================================================================================
+// Profiling Definitions
+// =====================================================================================================================
+UE_TRACE_CHANNEL_DEFINE(Pf2PlaygroundChannel);
+
+CSV_DEFINE_CATEGORY_MODULE(OPENPF2PLAYGROUND_API, Pf2Playground, true);
+
+DEFINE_STAT(STAT_Pf2PlaygroundLoadInputAbilityBindings);
+DEFINE_STAT(STAT_Pf2PlaygroundAbilityChangeCallback);
+DEFINE_STAT(STAT_Pf2PlaygroundBuildActivationPayload);
+DEFINE_STAT(STAT_Pf2PlaygroundPossessionRefresh);
+DEFINE_STAT(STAT_Pf2PlaygroundScreenTrace);
+DEFINE_STAT(STAT_Pf2PlaygroundScreenTraceBatch);
+DEFINE_STAT(STAT_Pf2PlaygroundScreenTraceCacheHits);
+DEFINE_STAT(STAT_Pf2PlaygroundRepGraphGatherParty);
+DEFINE_STAT(STAT_Pf2PlaygroundRepGraphGatherEncounter);
+DEFINE_STAT(STAT_Pf2PlaygroundTickBudget);
+DEFINE_STAT(STAT_Pf2PlaygroundTickBudgetThrottled);
+DEFINE_STAT(STAT_Pf2PlaygroundExecuteQueuedAbilityCommands);
+DEFINE_STAT(STAT_Pf2PlaygroundQueuedAbilityCommands);
+DEFINE_STAT(STAT_Pf2PlaygroundEncounterTriggers);
+DEFINE_STAT(STAT_Pf2PlaygroundCharacterPoolAcquire);
+DEFINE_STAT(STAT_Pf2PlaygroundCharacterPoolRefill);
+DEFINE_STAT(STAT_Pf2PlaygroundCharacterPoolHits);
+DEFINE_STAT(STAT_Pf2PlaygroundCharacterPoolMisses);
+DEFINE_STAT(STAT_Pf2PlaygroundCharacterPoolDormant);
@@ -7,5 +7,171 @@
 
 #include <CoreMinimal.h>
 
+#include <ProfilingDebugging/CpuProfilerTrace.h>
+#include <ProfilingDebugging/CsvProfiler.h>
+
+#include <Stats/Stats.h>
+
+#include <Trace/Trace.h>
+
 OPENPF2PLAYGROUND_API DECLARE_LOG_CATEGORY_EXTERN(LogPf2Playground, Log, VeryVerbose);
 OPENPF2PLAYGROUND_API DECLARE_LOG_CATEGORY_EXTERN(LogPf2PlaygroundInput, Log, VeryVerbose);
+
+// =====================================================================================================================
+// Profiling Declarations
+// =====================================================================================================================
+// Trace channel for scopes in the playground; enable it in Unreal Insights with "-trace=cpu,Pf2Playground".
+UE_TRACE_CHANNEL_EXTERN(Pf2PlaygroundChannel, OPENPF2PLAYGROUND_API);
+
+// CSV category for scopes in the playground; captured with "-csvCaptureFrames=<N>" or "csvprofile start".
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(OPENPF2PLAYGROUND_API, Pf2Playground);
+
+DECLARE_STATS_GROUP(TEXT("Pf2Playground"), STATGROUP_Pf2Playground, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Load Input Ability Bindings"),
+	STAT_Pf2PlaygroundLoadInputAbilityBindings,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Ability Change Callback"),
+	STAT_Pf2PlaygroundAbilityChangeCallback,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+// Includes the target data that is heap-allocated for every ability activation in Encounter mode; the game state and
+// controller lookups are cached, but the target data is not pooled.
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Build Ability Activation Payload"),
+	STAT_Pf2PlaygroundBuildActivationPayload,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Possession Refresh"),
+	STAT_Pf2PlaygroundPossessionRefresh,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Screen Trace"),
+	STAT_Pf2PlaygroundScreenTrace,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Screen Trace (Batch)"),
+	STAT_Pf2PlaygroundScreenTraceBatch,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(
+	TEXT("Screen Trace Cache Hits"),
+	STAT_Pf2PlaygroundScreenTraceCacheHits,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Replication Graph - Gather Party"),
+	STAT_Pf2PlaygroundRepGraphGatherParty,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Replication Graph - Gather Encounter"),
+	STAT_Pf2PlaygroundRepGraphGatherEncounter,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Tick Budget"),
+	STAT_Pf2PlaygroundTickBudget,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(
+	TEXT("Tick Budget Throttled Characters"),
+	STAT_Pf2PlaygroundTickBudgetThrottled,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Execute Queued Ability Commands"),
+	STAT_Pf2PlaygroundExecuteQueuedAbilityCommands,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(
+	TEXT("Queued Ability Commands"),
+	STAT_Pf2PlaygroundQueuedAbilityCommands,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Encounter Triggers"),
+	STAT_Pf2PlaygroundEncounterTriggers,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Character Pool - Acquire"),
+	STAT_Pf2PlaygroundCharacterPoolAcquire,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_CYCLE_STAT_EXTERN(
+	TEXT("Character Pool - Refill"),
+	STAT_Pf2PlaygroundCharacterPoolRefill,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(
+	TEXT("Character Pool Hits"),
+	STAT_Pf2PlaygroundCharacterPoolHits,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(
+	TEXT("Character Pool Misses"),
+	STAT_Pf2PlaygroundCharacterPoolMisses,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(
+	TEXT("Character Pool Dormant Characters"),
+	STAT_Pf2PlaygroundCharacterPoolDormant,
+	STATGROUP_Pf2Playground,
+	OPENPF2PLAYGROUND_API
+);
+
+/**
+ * Times the enclosing scope in the Pf2Playground stat group, trace channel, and CSV category all at once.
+ *
+ * @param Stat
+ *	The cycle stat (declared above) under which to report the scope in "stat Pf2Playground".
+ * @param Name
+ *	The name under which to report the scope in Unreal Insights and in CSV captures.
+ */
+#define PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(Stat, Name) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Pf2Playground_##Name, Pf2PlaygroundChannel); \
+	CSV_SCOPED_TIMING_STAT(Pf2Playground, Name)
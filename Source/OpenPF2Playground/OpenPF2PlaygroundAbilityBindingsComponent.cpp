@@ -5,50 +5,243 @@
 
 #include "OpenPF2PlaygroundAbilityBindingsComponent.h"
 
+#include <AbilitySystemComponent.h>
+#include <AbilitySystemGlobals.h>
+
 #include <GameFramework/GameStateBase.h>
 
 #include "OpenPF2GameFramework.h"
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundPlayerControllerBase.h"
 #include "PF2GameStateInterface.h"
 
+#include "Abilities/PF2InteractableAbilityInterface.h"
+
 #include "Libraries/PF2AbilitySystemLibrary.h"
 
+void UOpenPF2PlaygroundAbilityBindingsComponent::ExecuteBoundAbility(
+	const FName                      ActionName,
+	const FGameplayAbilitySpecHandle AbilitySpecHandle)
+{
+	UAbilitySystemComponent* Asc = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(this->GetOwner());
+
+	// When the owning character coalesces ability changes over a window, bindings can briefly outlive the abilities
+	// they are bound to. Ignore input for those, rather than sending the server an activation it will reject.
+	if ((Asc == nullptr) || (Asc->FindAbilitySpecFromHandle(AbilitySpecHandle) == nullptr))
+	{
+		UE_LOG(
+			LogPf2PlaygroundInput,
+			Verbose,
+			TEXT(
+				"Input action ('%s') is bound to an ability that is no longer granted; ignoring it until bindings are "
+				"reloaded."
+			),
+			*(ActionName.ToString())
+		);
+
+		return;
+	}
+
+	if (!this->QueueAbilityActivation(AbilitySpecHandle))
+	{
+		Super::ExecuteBoundAbility(ActionName, AbilitySpecHandle);
+	}
+}
+
 FGameplayEventData UOpenPF2PlaygroundAbilityBindingsComponent::BuildPayloadForAbilityActivation(
 	const FGameplayAbilitySpecHandle AbilitySpecHandle)
 {
-	AGameStateBase*               GameState     = this->GetWorld()->GetGameState();
-	const IPF2GameStateInterface* GameStateIntf = Cast<IPF2GameStateInterface>(GameState);
+	PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundBuildActivationPayload, BuildActivationPayload);
 
 	FGameplayEventData Result = UPF2AbilityBindingsComponent::BuildPayloadForAbilityActivation(AbilitySpecHandle);
 
 	// Only capture movement grid targets when in encounter mode. In other modes, abilities get executed immediately.
-	if ((GameStateIntf != nullptr) && (GameStateIntf->GetModeOfPlay() == EPF2ModeOfPlayType::Encounter))
+	if (this->GetCachedModeOfPlay() == EPF2ModeOfPlayType::Encounter)
 	{
-		const IPF2CharacterInterface* CharacterIntf = this->GetOwningCharacter();
+		const TScriptInterface<IPF2PlayerControllerInterface> PlayerController = this->GetCachedPlayerController();
 
-		if (CharacterIntf != nullptr)
+		if (PlayerController == nullptr)
 		{
-			const TScriptInterface<IPF2PlayerControllerInterface> PlayerController =
-				CharacterIntf->GetPlayerController();
-
-			if (PlayerController == nullptr)
-			{
-				UE_LOG(
-					LogPf2Abilities,
-					Error,
-					TEXT("Player controller is null or not compatible with OpenPF2, so ability target cannot be captured.")
-				);
-			}
-			else
-			{
-				// Add any current target from a movement grid to the ability activation.
-				Result.TargetData =
-					UPF2AbilitySystemLibrary::CreateAbilityTargetDataFromPlayerControllerTargetSelection(PlayerController);
+			UE_LOG(
+				LogPf2Abilities,
+				Error,
+				TEXT("Player controller is null or not compatible with OpenPF2, so ability target cannot be captured.")
+			);
+		}
+		else
+		{
+			// Add any current target from a movement grid to the ability activation. This allocates new target data
+			// on every activation, since the handle is given to the ability (and maybe the server) and can't be reused.
+			Result.TargetData =
+				UPF2AbilitySystemLibrary::CreateAbilityTargetDataFromPlayerControllerTargetSelection(PlayerController);
 
-				// Clear selection for next ability activation.
-				PlayerController->ClearTargetSelection();
-			}
+			// Clear selection for next ability activation.
+			PlayerController->ClearTargetSelection();
 		}
 	}
 
 	return Result;
 }
+
+void UOpenPF2PlaygroundAbilityBindingsComponent::InvalidateCachedPlayerController()
+{
+	this->CachedPlayerController = nullptr;
+}
+
+int32 UOpenPF2PlaygroundAbilityBindingsComponent::SyncBindingsWithCharacterAbilities()
+{
+	const AActor*                                         OwningActor = this->GetOwner();
+	const UAbilitySystemComponent*                        Asc         =
+		UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(OwningActor);
+	const TMap<UInputAction*, FGameplayAbilitySpecHandle> OldBindings = this->GetBindingsMap();
+	int32                                                 NumChanges  = 0;
+	TSet<UInputAction*>                                   BoundActions;
+	TSet<FGameplayAbilitySpecHandle>                      BoundHandles;
+
+	if (Asc == nullptr)
+	{
+		NumChanges = OldBindings.Num();
+
+		this->ClearBindings();
+
+		return NumChanges;
+	}
+
+	const TArray<FGameplayAbilitySpec>& ActivatableAbilities = Asc->GetActivatableAbilities();
+	TSet<FGameplayAbilitySpecHandle>    ActivatableHandles;
+
+	ActivatableHandles.Reserve(ActivatableAbilities.Num());
+
+	for (const FGameplayAbilitySpec& AbilitySpec : ActivatableAbilities)
+	{
+		ActivatableHandles.Add(AbilitySpec.Handle);
+	}
+
+	// Pass 1: Drop bindings for abilities that are no longer activatable.
+	for (const TPair<UInputAction*, FGameplayAbilitySpecHandle>& Binding : OldBindings)
+	{
+		UInputAction*                    Action = Binding.Key;
+		const FGameplayAbilitySpecHandle Handle = Binding.Value;
+
+		if (ActivatableHandles.Contains(Handle))
+		{
+			BoundActions.Add(Action);
+			BoundHandles.Add(Handle);
+		}
+		else
+		{
+			this->RemoveBinding(Action);
+			++NumChanges;
+		}
+	}
+
+	// Pass 2: Bind new abilities to their default input action, without displacing any existing binding.
+	for (const FGameplayAbilitySpec& AbilitySpec : ActivatableAbilities)
+	{
+		const IPF2InteractableAbilityInterface* AbilityIntf;
+		UInputAction*                           DefaultAction;
+
+		if (BoundHandles.Contains(AbilitySpec.Handle))
+		{
+			continue;
+		}
+
+		AbilityIntf = Cast<IPF2InteractableAbilityInterface>(AbilitySpec.Ability);
+
+		if (AbilityIntf == nullptr)
+		{
+			continue;
+		}
+
+		DefaultAction = AbilityIntf->GetDefaultInputActionMapping();
+
+		if ((DefaultAction != nullptr) && !BoundActions.Contains(DefaultAction))
+		{
+			this->SetBinding(DefaultAction, AbilitySpec.Handle);
+
+			BoundActions.Add(DefaultAction);
+			BoundHandles.Add(AbilitySpec.Handle);
+
+			++NumChanges;
+		}
+	}
+
+	return NumChanges;
+}
+
+bool UOpenPF2PlaygroundAbilityBindingsComponent::QueueAbilityActivation(
+	const FGameplayAbilitySpecHandle AbilitySpecHandle)
+{
+	const TScriptInterface<IPF2PlayerControllerInterface> PlayerController = this->GetCachedPlayerController();
+	AOpenPF2PlaygroundPlayerControllerBase*               PlaygroundController;
+
+	if (this->GetCachedModeOfPlay() != EPF2ModeOfPlayType::Encounter)
+	{
+		return false;
+	}
+
+	PlaygroundController = Cast<AOpenPF2PlaygroundPlayerControllerBase>(PlayerController.GetObject());
+
+	if (PlaygroundController == nullptr)
+	{
+		return false;
+	}
+
+	if (!PlaygroundController->QueueAbilityCommand(this->GetOwner(), AbilitySpecHandle))
+	{
+		return false;
+	}
+
+	// Clear selection for next ability activation.
+	PlayerController->ClearTargetSelection();
+
+	return true;
+}
+
+EPF2ModeOfPlayType UOpenPF2PlaygroundAbilityBindingsComponent::GetCachedModeOfPlay()
+{
+	if (this->CachedModeOfPlayFrame != GFrameCounter)
+	{
+		const IPF2GameStateInterface* GameStateIntf = this->CachedGameState.Get();
+
+		if (GameStateIntf == nullptr)
+		{
+			// The game state only changes when the world does, so we only need to look it up and cast it once.
+			this->CachedGameState = Cast<IPF2GameStateInterface>(this->GetWorld()->GetGameState());
+
+			GameStateIntf = this->CachedGameState.Get();
+		}
+
+		if (GameStateIntf == nullptr)
+		{
+			this->CachedModeOfPlay = EPF2ModeOfPlayType::None;
+		}
+		else
+		{
+			this->CachedModeOfPlay = GameStateIntf->GetModeOfPlay();
+		}
+
+		this->CachedModeOfPlayFrame = GFrameCounter;
+	}
+
+	return this->CachedModeOfPlay;
+}
+
+TScriptInterface<IPF2PlayerControllerInterface> UOpenPF2PlaygroundAbilityBindingsComponent::GetCachedPlayerController()
+{
+	if (!IsValid(this->CachedPlayerController.GetObject()))
+	{
+		const IPF2CharacterInterface* CharacterIntf = this->GetOwningCharacter();
+
+		if (CharacterIntf == nullptr)
+		{
+			this->CachedPlayerController = nullptr;
+		}
+		else
+		{
+			this->CachedPlayerController = CharacterIntf->GetPlayerController();
+		}
+	}
+
+	return this->CachedPlayerController;
+}
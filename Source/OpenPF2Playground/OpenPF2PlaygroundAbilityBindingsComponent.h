@@ -5,6 +5,11 @@
 
 #pragma once
 
+#include <UObject/WeakInterfacePtr.h>
+
+#include "PF2GameStateInterface.h"
+#include "PF2PlayerControllerInterface.h"
+
 #include "Commands/PF2AbilityBindingsComponent.h"
 
 #include "OpenPF2PlaygroundAbilityBindingsComponent.generated.h"
@@ -21,6 +26,36 @@ class UOpenPF2PlaygroundAbilityBindingsComponent : public UPF2AbilityBindingsCom
 {
 	GENERATED_BODY()
 
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * The game state of the world that contains the owning character.
+	 *
+	 * This is cached to avoid looking up and casting the game state for every ability activation.
+	 */
+	TWeakInterfacePtr<IPF2GameStateInterface> CachedGameState;
+
+	/**
+	 * The mode of play of the game, as of the frame indicated by CachedModeOfPlayFrame.
+	 */
+	EPF2ModeOfPlayType CachedModeOfPlay;
+
+	/**
+	 * The frame number during which the mode of play was last read from the game state.
+	 */
+	uint64 CachedModeOfPlayFrame;
+
+	/**
+	 * The player controller of the owning character.
+	 *
+	 * This is cached to avoid resolving the player controller for every ability activation. It must be invalidated
+	 * whenever the controller or owner of the owning character changes.
+	 */
+	UPROPERTY()
+	TScriptInterface<IPF2PlayerControllerInterface> CachedPlayerController;
+
 public:
 	// =================================================================================================================
 	// Public Constructor
@@ -28,13 +63,103 @@ public:
 	/**
 	 * Default constructor.
 	 */
-	explicit UOpenPF2PlaygroundAbilityBindingsComponent() : UPF2AbilityBindingsComponent()
+	explicit UOpenPF2PlaygroundAbilityBindingsComponent() :
+		UPF2AbilityBindingsComponent(),
+		CachedModeOfPlay(EPF2ModeOfPlayType::None),
+		CachedModeOfPlayFrame(0)
 	{
 	}
 
 	// =================================================================================================================
 	// UPF2AbilityBindingsComponent Overrides
 	// =================================================================================================================
+	/**
+	 * Activates the ability bound to an input action, batching the activation with other commands during Encounter
+	 * mode.
+	 *
+	 * During Encounter mode, the activation is first offered to QueueAbilityActivation(). Only if it cannot be queued
+	 * (or the game is in any other mode) is the ability activated immediately, as usual. Either way, the server turns
+	 * the activation into an OpenPF2 character command, so the encounter rule set still decides when it executes.
+	 *
+	 * Input for an ability that is no longer granted (e.g., while a coalesced reload of bindings is pending) is
+	 * ignored.
+	 *
+	 * @param ActionName
+	 *	The name of the input action that was triggered.
+	 * @param AbilitySpecHandle
+	 *	The handle of the ability bound to the input action.
+	 */
+	virtual void ExecuteBoundAbility(const FName                      ActionName,
+	                                 const FGameplayAbilitySpecHandle AbilitySpecHandle) override;
+
 	virtual FGameplayEventData BuildPayloadForAbilityActivation(
 		const FGameplayAbilitySpecHandle AbilitySpecHandle) override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Brings the bindings of this component in line with the activatable abilities of the owning character.
+	 *
+	 * Unlike clearing the bindings and then calling LoadAbilitiesFromCharacter(), this only touches bindings that are
+	 * affected by a change in the abilities of the character:
+	 *   - Bindings for abilities that are no longer activatable in the ASC of the character are removed.
+	 *   - Abilities that have become activatable and are not yet bound are bound to their default input action, as
+	 *     long as that input action is not already bound to a different ability.
+	 *
+	 * All other bindings (including any bindings that were re-mapped by the player) are left as-is, so the input
+	 * action for each ability that remains activatable stays stable.
+	 *
+	 * @return
+	 *	The number of bindings that were added or removed.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Ability Bindings")
+	int32 SyncBindingsWithCharacterAbilities();
+
+	/**
+	 * Queues the activation of an ability to be sent to the server in a batch with other commands for the turn.
+	 *
+	 * This is how abilities activated through their bindings are sent to the server during Encounter mode (see
+	 * ExecuteBoundAbility()). The current target selection of the player controller is captured and queued on the
+	 * player controller (see AOpenPF2PlaygroundPlayerControllerBase::QueueAbilityCommand()). The target selection is
+	 * then cleared for the next command, just as it is for an ability activated immediately.
+	 *
+	 * @param AbilitySpecHandle
+	 *	The handle of the ability to activate, in the ASC of the owning character.
+	 *
+	 * @return
+	 *	true if the activation was queued; or, false if the game is not in Encounter mode, the player controller does
+	 *	not support batching, or the target cannot be represented in a queued command. In that case, the target
+	 *	selection is left as-is so that the ability can be activated without batching.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Ability Bindings")
+	bool QueueAbilityActivation(const FGameplayAbilitySpecHandle AbilitySpecHandle);
+
+	/**
+	 * Notifies this component that the player controller of the owning character may have changed.
+	 *
+	 * This must be invoked whenever the controller or owner of the owning character changes.
+	 */
+	void InvalidateCachedPlayerController();
+
+protected:
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Gets the current mode of play, reading it from the game state at most once per frame.
+	 *
+	 * @return
+	 *	The current mode of play; or, EPF2ModeOfPlayType::None if the game state is not compatible with OpenPF2.
+	 */
+	EPF2ModeOfPlayType GetCachedModeOfPlay();
+
+	/**
+	 * Gets the player controller of the owning character, resolving it only if it is not already cached.
+	 *
+	 * @return
+	 *	The player controller of the owning character; or, nullptr if the owning character does not have a player
+	 *	controller that is compatible with OpenPF2.
+	 */
+	TScriptInterface<IPF2PlayerControllerInterface> GetCachedPlayerController();
 };
@@ -0,0 +1,22 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundAiCharacterBase.h"
+
+#include <Components/SkeletalMeshComponent.h>
+
+AOpenPF2PlaygroundAiCharacterBase::AOpenPF2PlaygroundAiCharacterBase(const FObjectInitializer& ObjectInitializer) :
+	Super(
+		ObjectInitializer
+			.DoNotCreateDefaultSubobject(CameraBoomComponentName)
+			.DoNotCreateDefaultSubobject(FollowCameraComponentName)
+			.DoNotCreateDefaultSubobject(AbilityBindingsComponentName)
+	)
+{
+	this->AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+
+	// Nobody is looking through this character, so there is no reason to animate it while it is off-screen.
+	this->GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+}
@@ -0,0 +1,36 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "OpenPF2PlaygroundCharacterBase.h"
+
+#include "OpenPF2PlaygroundAiCharacterBase.generated.h"
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * Base class for characters that are only ever controlled by AI (e.g., the enemies in an encounter).
+ *
+ * Players never possess or view the world through these characters, so they are created without a camera boom, a
+ * follow camera, or an ability bindings component. This makes each enemy cheaper to spawn, to keep in memory, and to
+ * tick. Characters that can join the party of a player should derive from AOpenPF2PlaygroundCharacterBase instead.
+ */
+UCLASS(Config=Game)
+// ReSharper disable once CppClassCanBeFinal
+class AOpenPF2PlaygroundAiCharacterBase : public AOpenPF2PlaygroundCharacterBase
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Constructor for AOpenPF2PlaygroundAiCharacterBase.
+	 *
+	 * @param ObjectInitializer
+	 *	The initializer for this character.
+	 */
+	explicit AOpenPF2PlaygroundAiCharacterBase(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+};
@@ -7,6 +7,34 @@
 
 #include <AbilitySystemGlobals.h>
 
+#include <Engine/StreamableManager.h>
+#include <Engine/World.h>
+
+#include <UObject/Package.h>
+#include <UObject/UObjectGlobals.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundGameplayTagTableCommandlet.h"
+
+const FPrimaryAssetType UOpenPF2PlaygroundAssetManager::ModeOfPlayAssetType = FName(TEXT("PlaygroundModeOfPlay"));
+const FName             UOpenPF2PlaygroundAssetManager::ExplorationBundle   = FName(TEXT("Exploration"));
+const FName             UOpenPF2PlaygroundAssetManager::EncounterBundle     = FName(TEXT("Encounter"));
+
+UOpenPF2PlaygroundAssetManager::UOpenPF2PlaygroundAssetManager()
+{
+	this->bLoadBundlesForModeOfPlay          = true;
+	this->bPreloadExplorationBundleAtStartup = true;
+	this->bHasRegisteredModeOfPlayAsset      = false;
+	this->bIsStartupPreloadInProgress        = false;
+	this->StartupPreloadDuration             = 0.0;
+	this->LoadedModeOfPlay              = EPF2ModeOfPlayType::None;
+	this->ModeOfPlayLoadStartTime       = 0.0;
+	this->bIsLoadingMap                 = false;
+	this->OutermostSyncLoadStartTime    = 0.0;
+	this->NumSyncLoads                  = 0;
+	this->SyncLoadTime                  = 0.0;
+}
+
 void UOpenPF2PlaygroundAssetManager::StartInitialLoading()
 {
 	Super::StartInitialLoading();
@@ -19,3 +47,236 @@ void UOpenPF2PlaygroundAssetManager::StartInitialLoading()
 	// - LogNet: UEngine::BroadcastNetworkFailure: FailureType = ConnectionLost, ErrorString = Your connection to the host has been lost.
 	UAbilitySystemGlobals::Get().InitGlobalData();
 }
+
+#if WITH_EDITOR
+void UOpenPF2PlaygroundAssetManager::ModifyCook(const TConstArrayView<const ITargetPlatform*> TargetPlatforms,
+                                                TArray<FName>&                                PackagesToCook,
+                                                TArray<FName>&                                PackagesToNeverCook)
+{
+	Super::ModifyCook(TargetPlatforms, PackagesToCook, PackagesToNeverCook);
+
+	// Logging an error fails the cook, so a stale precompiled tag table is never packaged into a Shipping build.
+	GetDefault<UOpenPF2PlaygroundGameplayTagTableCommandlet>()->VerifyDataTable(true);
+}
+#endif
+
+TSharedPtr<FStreamableHandle> UOpenPF2PlaygroundAssetManager::LoadBundlesForModeOfPlay(
+	const EPF2ModeOfPlayType ModeOfPlay)
+{
+	const FPrimaryAssetId         ModeOfPlayAssetId(ModeOfPlayAssetType, FName(TEXT("Playground")));
+	TArray<FName>                 Bundles;
+	TSharedPtr<FStreamableHandle> LoadHandle;
+
+	if (!this->bHasRegisteredModeOfPlayAsset ||
+	    (ModeOfPlay == EPF2ModeOfPlayType::None) ||
+	    (ModeOfPlay == this->LoadedModeOfPlay))
+	{
+		return nullptr;
+	}
+
+	// Everything needed to explore is still needed during an encounter, so that it does not have to be loaded again
+	// once the encounter ends. Switching back from an encounter releases only the "Encounter" bundle.
+	Bundles.Add(ExplorationBundle);
+
+	if (ModeOfPlay == EPF2ModeOfPlayType::Encounter)
+	{
+		Bundles.Add(EncounterBundle);
+	}
+
+	this->LoadedModeOfPlay        = ModeOfPlay;
+	this->ModeOfPlayLoadStartTime = FPlatformTime::Seconds();
+
+	// The asset manager keeps the handle of the current bundle state of the asset, and releases the previous one.
+	LoadHandle = this->LoadPrimaryAsset(
+		ModeOfPlayAssetId,
+		Bundles,
+		FStreamableDelegate::CreateUObject(
+			this,
+			&UOpenPF2PlaygroundAssetManager::Native_OnModeOfPlayBundlesLoaded,
+			ModeOfPlay
+		),
+		FStreamableManager::AsyncLoadHighPriority
+	);
+
+	if (!LoadHandle.IsValid())
+	{
+		// Either there was nothing to load, or everything was already loaded.
+		this->Native_OnModeOfPlayBundlesLoaded(ModeOfPlay);
+	}
+
+	return LoadHandle;
+}
+
+void UOpenPF2PlaygroundAssetManager::PostInitialAssetScan()
+{
+	Super::PostInitialAssetScan();
+
+	// The editor is skipped, since it loads most of this content for editing anyway, and loads much more on demand.
+	if (GIsEditor)
+	{
+		return;
+	}
+
+	// The primary asset types we load are only known once the initial scan has finished.
+	if (this->bLoadBundlesForModeOfPlay)
+	{
+		this->RegisterModeOfPlayAsset();
+
+		// Everything in the "Exploration" bundle is needed in every mode of play, so it starts loading now, behind the
+		// loading screen of the first map, instead of when the game first enters a mode of play.
+		if (this->bPreloadExplorationBundleAtStartup && this->bHasRegisteredModeOfPlayAsset)
+		{
+			this->bIsStartupPreloadInProgress = true;
+
+			this->LoadBundlesForModeOfPlay(EPF2ModeOfPlayType::Exploration);
+		}
+	}
+
+	// From now on, anything loaded synchronously outside of a map load was missed by the bundles and will hitch on
+	// first use.
+	FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &UOpenPF2PlaygroundAssetManager::Native_OnPreLoadMap);
+
+	FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(
+		this,
+		&UOpenPF2PlaygroundAssetManager::Native_OnPostLoadMap
+	);
+
+	FCoreUObjectDelegates::OnSyncLoadPackage.AddUObject(
+		this,
+		&UOpenPF2PlaygroundAssetManager::Native_OnSyncLoadPackage
+	);
+
+	FCoreUObjectDelegates::OnEndLoadPackage.AddUObject(this, &UOpenPF2PlaygroundAssetManager::Native_OnEndLoadPackage);
+}
+
+void UOpenPF2PlaygroundAssetManager::RegisterModeOfPlayAsset()
+{
+	const FPrimaryAssetId ModeOfPlayAssetId(ModeOfPlayAssetType, FName(TEXT("Playground")));
+	FAssetBundleData      BundleData;
+
+	this->AddPrimaryAssetTypesToBundle(this->ExplorationPrimaryAssetTypes, ExplorationBundle, BundleData);
+	this->AddPrimaryAssetTypesToBundle(this->EncounterPrimaryAssetTypes, EncounterBundle, BundleData);
+
+	this->bHasRegisteredModeOfPlayAsset = this->AddDynamicAsset(ModeOfPlayAssetId, FSoftObjectPath(), BundleData);
+}
+
+void UOpenPF2PlaygroundAssetManager::AddPrimaryAssetTypesToBundle(const TArray<FPrimaryAssetType>& AssetTypes,
+                                                                  const FName                      BundleName,
+                                                                  FAssetBundleData&                BundleData) const
+{
+	for (const FPrimaryAssetType& AssetType : AssetTypes)
+	{
+		TArray<FSoftObjectPath> AssetPaths;
+
+		if (!this->GetPrimaryAssetPathList(AssetType, AssetPaths))
+		{
+			UE_LOG(
+				LogPf2Playground,
+				Warning,
+				TEXT("No primary assets of type '%s' were found to load in bundle '%s'."),
+				*(AssetType.ToString()),
+				*(BundleName.ToString())
+			);
+
+			continue;
+		}
+
+		for (const FSoftObjectPath& AssetPath : AssetPaths)
+		{
+			BundleData.AddBundleAsset(BundleName, FTopLevelAssetPath(AssetPath.GetAssetPath()));
+		}
+	}
+}
+
+void UOpenPF2PlaygroundAssetManager::Native_OnModeOfPlayBundlesLoaded(const EPF2ModeOfPlayType ModeOfPlay)
+{
+	const double LoadDuration = FPlatformTime::Seconds() - this->ModeOfPlayLoadStartTime;
+
+	if (this->bIsStartupPreloadInProgress && (ModeOfPlay == EPF2ModeOfPlayType::Exploration))
+	{
+		this->bIsStartupPreloadInProgress = false;
+		this->StartupPreloadDuration      = LoadDuration;
+
+		UE_LOG(
+			LogPf2Playground,
+			Log,
+			TEXT("Preloaded the '%s' bundle at startup in %.3f ms."),
+			*(ExplorationBundle.ToString()),
+			LoadDuration * 1000.0
+		);
+	}
+	else
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Log,
+			TEXT("Loaded the bundles for mode of play (%d) in %.3f ms."),
+			static_cast<int32>(ModeOfPlay),
+			LoadDuration * 1000.0
+		);
+	}
+}
+
+void UOpenPF2PlaygroundAssetManager::Native_OnPreLoadMap(const FString& MapName)
+{
+	this->bIsLoadingMap = true;
+}
+
+void UOpenPF2PlaygroundAssetManager::Native_OnPostLoadMap(UWorld* World)
+{
+	this->bIsLoadingMap = false;
+}
+
+void UOpenPF2PlaygroundAssetManager::Native_OnSyncLoadPackage(const FString& PackageName)
+{
+	if (this->bIsLoadingMap)
+	{
+		return;
+	}
+
+	++this->NumSyncLoads;
+
+	if (this->OutermostSyncLoadPackageName.IsNone())
+	{
+		this->OutermostSyncLoadPackageName = FName(*PackageName);
+		this->OutermostSyncLoadStartTime   = FPlatformTime::Seconds();
+	}
+
+	UE_LOG(
+		LogPf2Playground,
+		Verbose,
+		TEXT("Package ('%s') is being loaded synchronously on first use (%d sync load(s) so far)."),
+		*PackageName,
+		this->NumSyncLoads
+	);
+}
+
+void UOpenPF2PlaygroundAssetManager::Native_OnEndLoadPackage(const FEndLoadPackageContext& Context)
+{
+	if (this->OutermostSyncLoadPackageName.IsNone())
+	{
+		return;
+	}
+
+	for (const UPackage* LoadedPackage : Context.LoadedPackages)
+	{
+		if ((LoadedPackage != nullptr) && (LoadedPackage->GetFName() == this->OutermostSyncLoadPackageName))
+		{
+			const double LoadDuration = FPlatformTime::Seconds() - this->OutermostSyncLoadStartTime;
+
+			this->SyncLoadTime += LoadDuration;
+
+			UE_LOG(
+				LogPf2Playground,
+				Verbose,
+				TEXT("Package ('%s') was loaded synchronously on first use in %.3f ms (%.3f ms in total so far)."),
+				*(this->OutermostSyncLoadPackageName.ToString()),
+				LoadDuration * 1000.0,
+				this->SyncLoadTime * 1000.0
+			);
+
+			this->OutermostSyncLoadPackageName = NAME_None;
+			break;
+		}
+	}
+}
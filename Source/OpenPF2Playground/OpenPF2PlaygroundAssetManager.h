@@ -7,24 +7,296 @@
 
 #include <Engine/AssetManager.h>
 
+#include "PF2GameStateInterface.h"
+
 #include "OpenPF2PlaygroundAssetManager.generated.h"
 
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class ITargetPlatform;
+
+struct FEndLoadPackageContext;
+
 /**
  * Custom asset manager that ensures ability system globals needed for target data replication are initialized properly.
  *
+ * This asset manager also streams in the data that the playground needs during each mode of play, so that it is not
+ * loaded on demand (causing hitches) the first time it is used. Once the initial asset scan has finished, the primary
+ * assets of each type configured for the "Exploration" and "Encounter" bundles are gathered into a single dynamic
+ * primary asset. The "Exploration" bundle (the item data and anything else needed in every mode of play) then starts
+ * loading asynchronously right away, so that it loads behind the loading screen of the first map. The "Encounter"
+ * bundle is loaded asynchronously when the game state reports that an encounter has started (or earlier, when something
+ * like an encounter prewarm asks for it), and is released again when the game returns to exploration.
+ *
+ * Packages that still have to be loaded synchronously outside of map loads are counted and timed, so that gaps in the
+ * bundles can be found.
+ *
  * Adapted from:
  * - https://github.com/tranek/GASDocumentation/blob/master/Source/GASDocumentation/Public/GDAssetManager.h
  * - https://github.com/tranek/GASDocumentation/blob/master/Source/GASDocumentation/Private/GDAssetManager.cpp
  */
-UCLASS()
+UCLASS(Config=Game)
 // ReSharper disable once CppClassCanBeFinal
 class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundAssetManager : public UAssetManager
 {
 	GENERATED_BODY()
 
 public:
+	// =================================================================================================================
+	// Public Constants
+	// =================================================================================================================
+	/**
+	 * The type of the dynamic primary asset that gathers the assets to load for each mode of play.
+	 */
+	static const FPrimaryAssetType ModeOfPlayAssetType;
+
+	/**
+	 * The name of the bundle containing assets that are needed while exploring.
+	 */
+	static const FName ExplorationBundle;
+
+	/**
+	 * The name of the bundle containing assets that are needed during encounters.
+	 */
+	static const FName EncounterBundle;
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * Whether to load the configured bundles when the game enters each mode of play.
+	 */
+	UPROPERTY(Config)
+	bool bLoadBundlesForModeOfPlay;
+
+	/**
+	 * The types of primary assets (e.g., item types and item slots) to load in the "Exploration" bundle.
+	 */
+	UPROPERTY(Config)
+	TArray<FPrimaryAssetType> ExplorationPrimaryAssetTypes;
+
+	/**
+	 * The types of primary assets (e.g., abilities) to load in the "Encounter" bundle.
+	 */
+	UPROPERTY(Config)
+	TArray<FPrimaryAssetType> EncounterPrimaryAssetTypes;
+
+	/**
+	 * Whether to start loading the "Exploration" bundle as soon as the initial asset scan has finished.
+	 */
+	UPROPERTY(Config)
+	bool bPreloadExplorationBundleAtStartup;
+
+	/**
+	 * Whether the dynamic primary asset containing the bundles of each mode of play has been registered.
+	 */
+	bool bHasRegisteredModeOfPlayAsset;
+
+	/**
+	 * Whether the "Exploration" bundle is being preloaded at startup and has not finished loading yet.
+	 */
+	bool bIsStartupPreloadInProgress;
+
+	/**
+	 * How long (in seconds) it took to preload the "Exploration" bundle at startup, or zero if it has not finished.
+	 */
+	double StartupPreloadDuration;
+
+	/**
+	 * The mode of play for which bundles were last loaded.
+	 */
+	EPF2ModeOfPlayType LoadedModeOfPlay;
+
+	/**
+	 * The time (in seconds) at which the bundles of the current mode of play started loading.
+	 */
+	double ModeOfPlayLoadStartTime;
+
+	/**
+	 * Whether a map is currently being loaded.
+	 *
+	 * Packages loaded synchronously as part of a map load are expected (they are hidden by the loading screen), so they
+	 * are not counted.
+	 */
+	bool bIsLoadingMap;
+
+	/**
+	 * The name of the package of the outermost synchronous load in progress; or, NAME_None if there is none.
+	 *
+	 * Synchronous loads that are triggered while loading this package are counted, but are not timed separately,
+	 * since their time is already part of the time of the outermost load.
+	 */
+	FName OutermostSyncLoadPackageName;
+
+	/**
+	 * The time (in seconds) at which the outermost synchronous load in progress was started.
+	 */
+	double OutermostSyncLoadStartTime;
+
+	/**
+	 * The number of packages that have been loaded synchronously (i.e., on first use) outside of map loads.
+	 */
+	int32 NumSyncLoads;
+
+	/**
+	 * The total time (in seconds) spent loading packages synchronously outside of map loads.
+	 */
+	double SyncLoadTime;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundAssetManager();
+
 	// =================================================================================================================
 	// Public Methods - UAssetManager Overrides
 	// =================================================================================================================
 	virtual void StartInitialLoading() override;
+
+#if WITH_EDITOR
+	virtual void ModifyCook(TConstArrayView<const ITargetPlatform*> TargetPlatforms,
+	                        TArray<FName>&                          PackagesToCook,
+	                        TArray<FName>&                          PackagesToNeverCook) override;
+#endif
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Loads the bundles needed by a mode of play asynchronously, releasing those that are no longer needed.
+	 *
+	 * This is called by the game state when the game enters a mode of play, but can be called earlier (e.g., when an
+	 * encounter is about to start) to give the bundles more time to load. Loading the bundles of the mode of play that
+	 * is already loaded does nothing.
+	 *
+	 * @param ModeOfPlay
+	 *	The mode of play for which bundles are to be loaded.
+	 *
+	 * @return
+	 *	The handle of the load; or, nullptr if there was nothing to load or everything was already loaded.
+	 */
+	TSharedPtr<FStreamableHandle> LoadBundlesForModeOfPlay(const EPF2ModeOfPlayType ModeOfPlay);
+
+	/**
+	 * Determines whether the "Exploration" bundle has finished preloading at startup.
+	 *
+	 * Loading screens can wait on this before being dismissed.
+	 *
+	 * @return
+	 *	true if the startup preload has finished or was never started; or, false if it is still in progress.
+	 */
+	FORCEINLINE bool IsStartupPreloadComplete() const
+	{
+		return !this->bIsStartupPreloadInProgress;
+	}
+
+	/**
+	 * Gets how long it took to preload the "Exploration" bundle at startup.
+	 *
+	 * @return
+	 *	The duration of the startup preload, in seconds; or, zero if it has not finished or was never started.
+	 */
+	FORCEINLINE double GetStartupPreloadDuration() const
+	{
+		return this->StartupPreloadDuration;
+	}
+
+	/**
+	 * Gets the number of packages that have been loaded on first use, outside of map loads.
+	 *
+	 * @return
+	 *	The number of synchronous package loads since the initial asset scan.
+	 */
+	FORCEINLINE int32 GetNumSyncLoads() const
+	{
+		return this->NumSyncLoads;
+	}
+
+	/**
+	 * Gets the total time spent loading packages on first use, outside of map loads.
+	 *
+	 * @return
+	 *	The total time of synchronous package loads since the initial asset scan, in seconds.
+	 */
+	FORCEINLINE double GetSyncLoadTime() const
+	{
+		return this->SyncLoadTime;
+	}
+
+protected:
+	// =================================================================================================================
+	// Protected Methods - UAssetManager Overrides
+	// =================================================================================================================
+	virtual void PostInitialAssetScan() override;
+
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Registers the dynamic primary asset that contains the bundles of each mode of play, without loading anything.
+	 */
+	void RegisterModeOfPlayAsset();
+
+	/**
+	 * Adds the paths of all primary assets of the given types to a bundle.
+	 *
+	 * @param AssetTypes
+	 *	The types of primary assets to add.
+	 * @param BundleName
+	 *	The name of the bundle to which assets are added.
+	 * @param BundleData
+	 *	The bundle data being built.
+	 */
+	void AddPrimaryAssetTypesToBundle(const TArray<FPrimaryAssetType>& AssetTypes,
+	                                  const FName                      BundleName,
+	                                  FAssetBundleData&                BundleData) const;
+
+	// =================================================================================================================
+	// Protected Native Event Callbacks
+	// =================================================================================================================
+	/**
+	 * Native callback invoked when the bundles of a mode of play have finished loading.
+	 *
+	 * @param ModeOfPlay
+	 *	The mode of play whose bundles were loaded.
+	 */
+	void Native_OnModeOfPlayBundlesLoaded(const EPF2ModeOfPlayType ModeOfPlay);
+
+	/**
+	 * Native callback invoked when a map is about to be loaded.
+	 *
+	 * @param MapName
+	 *	The name of the map being loaded.
+	 */
+	void Native_OnPreLoadMap(const FString& MapName);
+
+	/**
+	 * Native callback invoked once a map has been loaded.
+	 *
+	 * @param World
+	 *	The world of the map that was loaded.
+	 */
+	void Native_OnPostLoadMap(UWorld* World);
+
+	/**
+	 * Native callback invoked whenever a package is about to be loaded synchronously.
+	 *
+	 * @param PackageName
+	 *	The name of the package being loaded.
+	 */
+	void Native_OnSyncLoadPackage(const FString& PackageName);
+
+	/**
+	 * Native callback invoked whenever packages have finished loading.
+	 *
+	 * @param Context
+	 *	Information about the packages that were loaded.
+	 */
+	void Native_OnEndLoadPackage(const FEndLoadPackageContext& Context);
 };
@@ -0,0 +1,666 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundBenchmarkCommandlet.h"
+
+#include <AbilitySystemComponent.h>
+#include <Abilities/GameplayAbility.h>
+
+#include <Dom/JsonObject.h>
+
+#include <Engine/Engine.h>
+#include <Engine/GameInstance.h>
+#include <Engine/World.h>
+
+#include <GameFramework/GameModeBase.h>
+#include <GameFramework/GameStateBase.h>
+
+#include <GameMapsSettings.h>
+
+#include <Misc/App.h>
+#include <Misc/DateTime.h>
+#include <Misc/FileHelper.h>
+#include <Misc/Paths.h>
+
+#include <Serialization/ArchiveCountMem.h>
+#include <Serialization/JsonSerializer.h>
+#include <Serialization/JsonWriter.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundAbilityBindingsComponent.h"
+#include "OpenPF2PlaygroundAiCharacterBase.h"
+#include "OpenPF2PlaygroundCharacterBase.h"
+#include "OpenPF2PlaygroundPlayerControllerBase.h"
+
+#include "Abilities/PF2InteractableAbilityInterface.h"
+
+UOpenPF2PlaygroundBenchmarkCommandlet::UOpenPF2PlaygroundBenchmarkCommandlet()
+{
+	this->IsClient       = false;
+	this->IsServer       = false;
+	this->IsEditor       = true;
+	this->LogToConsole   = true;
+	this->ShowErrorCount = true;
+
+	this->DefaultNumCharacters = 50;
+	this->DefaultNumAbilities  = 200;
+	this->DefaultNumIterations = 100;
+	this->DefaultNumEnemies    = 200;
+}
+
+int32 UOpenPF2PlaygroundBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32                                    NumCharacters = this->DefaultNumCharacters,
+	                                         NumAbilities  = this->DefaultNumAbilities,
+	                                         NumIterations = this->DefaultNumIterations,
+	                                         NumEnemies    = this->DefaultNumEnemies;
+	FString                                  AbilityClassPath  = this->DefaultAbilityClass.ToString(),
+	                                         GameModeClassPath = this->DefaultGameModeClass.ToString(),
+	                                         OutputPath;
+	TSubclassOf<UGameplayAbility>            AbilityClass;
+	const IPF2InteractableAbilityInterface*  AbilityIntf;
+	TSubclassOf<AGameModeBase>               GameModeClass;
+	UGameInstance*                           GameInstance;
+	UWorld*                                  World;
+	TSubclassOf<APlayerController>           PlayerControllerClass;
+	AOpenPF2PlaygroundPlayerControllerBase*  PlayerController;
+	TArray<AOpenPF2PlaygroundCharacterBase*> Characters;
+	TArray<double>                           InitialBindingSamples,
+	                                         BindingSamples,
+	                                         PayloadSamples,
+	                                         PossessionSamples,
+	                                         UncachedScreenTraceSamples,
+	                                         CachedScreenTraceSamples,
+	                                         WorldTraceSamples;
+	int32                                    NumScreenTraceHits = 0;
+	const TSharedRef<FJsonObject>            Report     = CreateReport();
+	const TSharedRef<FJsonObject>            Parameters = MakeShared<FJsonObject>();
+	const TSharedRef<FJsonObject>            Metrics    = MakeShared<FJsonObject>();
+	TSharedPtr<FJsonObject>                  CharacterFootprint,
+	                                         AiCharacterFootprint;
+	FString                                  ReportJson;
+
+	FParse::Value(*Params, TEXT("Characters="), NumCharacters);
+	FParse::Value(*Params, TEXT("Abilities="), NumAbilities);
+	FParse::Value(*Params, TEXT("Iterations="), NumIterations);
+	FParse::Value(*Params, TEXT("Enemies="), NumEnemies);
+	FParse::Value(*Params, TEXT("AbilityClass="), AbilityClassPath);
+	FParse::Value(*Params, TEXT("GameMode="), GameModeClassPath);
+
+	if (!FParse::Value(*Params, TEXT("Output="), OutputPath))
+	{
+		OutputPath = FPaths::Combine(
+			FPaths::ProjectSavedDir(),
+			TEXT("Benchmarks"),
+			FString::Printf(TEXT("OpenPF2Playground-%s.json"), *(FDateTime::UtcNow().ToString()))
+		);
+	}
+
+	if ((NumCharacters < 2) || (NumAbilities < 1) || (NumIterations < 1))
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT("Benchmark requires at least 2 characters, 1 ability, and 1 iteration (got %d, %d, and %d)."),
+			NumCharacters,
+			NumAbilities,
+			NumIterations
+		);
+
+		return 1;
+	}
+
+	AbilityClass = TSoftClassPtr<UGameplayAbility>(FSoftObjectPath(AbilityClassPath)).LoadSynchronous();
+	AbilityIntf  =
+		(AbilityClass != nullptr) ? Cast<IPF2InteractableAbilityInterface>(AbilityClass->GetDefaultObject()) : nullptr;
+
+	if ((AbilityIntf == nullptr) || (AbilityIntf->GetDefaultInputActionMapping() == nullptr))
+	{
+		// Without a default input action, loading bindings never binds anything and would only time an empty loop.
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT("Ability class ('%s') must be an OpenPF2 ability with a default input action."),
+			*AbilityClassPath
+		);
+
+		return 1;
+	}
+
+	if (GameModeClassPath.IsEmpty())
+	{
+		GameModeClassPath = UGameMapsSettings::GetGlobalDefaultGameMode();
+	}
+
+	GameModeClass = TSoftClassPtr<AGameModeBase>(FSoftObjectPath(GameModeClassPath)).LoadSynchronous();
+
+	if (GameModeClass == nullptr)
+	{
+		UE_LOG(LogPf2Playground, Error, TEXT("Failed to load game mode class ('%s')."), *GameModeClassPath);
+		return 1;
+	}
+
+	World = this->CreateBenchmarkWorld(GameModeClass, GameInstance);
+
+	if (World == nullptr)
+	{
+		return 1;
+	}
+
+	if (NumEnemies > 0)
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Display,
+			TEXT("Comparing the footprint of %d full character(s) against %d AI-only character(s)."),
+			NumEnemies,
+			NumEnemies
+		);
+
+		// Run these before any other characters exist, so that ticks only measure the characters being compared.
+		//
+		// Neither native class assigns a skeletal mesh (meshes are set in Blueprint subclasses), so these numbers only
+		// cover the components and controllers that the native classes create, not the cost of rendering or animation.
+		CharacterFootprint = this->BenchmarkSpawnFootprint(
+			World,
+			AOpenPF2PlaygroundCharacterBase::StaticClass(),
+			NumEnemies,
+			NumIterations
+		);
+
+		AiCharacterFootprint = this->BenchmarkSpawnFootprint(
+			World,
+			AOpenPF2PlaygroundAiCharacterBase::StaticClass(),
+			NumEnemies,
+			NumIterations
+		);
+	}
+
+	for (int32 CharacterIndex = 0; CharacterIndex < NumCharacters; ++CharacterIndex)
+	{
+		// Space characters out so that traces against one character never hit another.
+		const FVector                    Location  = FVector(CharacterIndex * 500.0f, 0.0f, 0.0f);
+		AOpenPF2PlaygroundCharacterBase* Character =
+			this->SpawnCharacter(World, AbilityClass, NumAbilities, Location);
+
+		if (Character != nullptr)
+		{
+			Characters.Add(Character);
+		}
+	}
+
+	PlayerControllerClass = World->GetAuthGameMode()->PlayerControllerClass;
+
+	if ((PlayerControllerClass == nullptr) ||
+	    !PlayerControllerClass->IsChildOf(AOpenPF2PlaygroundPlayerControllerBase::StaticClass()))
+	{
+		PlayerControllerClass = AOpenPF2PlaygroundPlayerControllerBase::StaticClass();
+	}
+
+	PlayerController = World->SpawnActor<AOpenPF2PlaygroundPlayerControllerBase>(PlayerControllerClass);
+
+	if ((PlayerController == nullptr) || (Characters.Num() != NumCharacters))
+	{
+		UE_LOG(LogPf2Playground, Error, TEXT("Failed to spawn the actors needed for the benchmark."));
+	}
+	else
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Display,
+			TEXT("Benchmarking %d character(s) with %d ability(ies) each, over %d iteration(s)."),
+			NumCharacters,
+			NumAbilities,
+			NumIterations
+		);
+
+		this->BenchmarkLoadInputAbilityBindings(Characters, NumIterations, InitialBindingSamples, BindingSamples);
+		this->BenchmarkBuildPayloadForAbilityActivation(Characters, NumIterations, PayloadSamples);
+		this->BenchmarkPossessionSwaps(PlayerController, Characters, NumIterations, PossessionSamples);
+
+		NumScreenTraceHits = this->BenchmarkScreenTraces(
+			PlayerController,
+			Characters,
+			NumIterations,
+			UncachedScreenTraceSamples,
+			CachedScreenTraceSamples,
+			WorldTraceSamples
+		);
+	}
+
+	GameInstance->Shutdown();
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	if (PossessionSamples.Num() == 0)
+	{
+		return 1;
+	}
+
+	Parameters->SetNumberField(TEXT("Characters"), NumCharacters);
+	Parameters->SetNumberField(TEXT("AbilitiesPerCharacter"), NumAbilities);
+	Parameters->SetNumberField(TEXT("Iterations"), NumIterations);
+	Parameters->SetNumberField(TEXT("Enemies"), NumEnemies);
+	Parameters->SetStringField(TEXT("AbilityClass"), AbilityClass->GetPathName());
+	Parameters->SetStringField(TEXT("GameMode"), GameModeClass->GetPathName());
+
+	Metrics->SetObjectField(TEXT("LoadInputAbilityBindings.Initial"), SummarizeSamples(InitialBindingSamples));
+	Metrics->SetObjectField(TEXT("LoadInputAbilityBindings.Unchanged"), SummarizeSamples(BindingSamples));
+	Metrics->SetObjectField(TEXT("BuildPayloadForAbilityActivation"), SummarizeSamples(PayloadSamples));
+	Metrics->SetObjectField(TEXT("PossessionSwap"), SummarizeSamples(PossessionSamples));
+	Metrics->SetObjectField(
+		TEXT("GetHitResultForScreenPosition.Uncached"),
+		SummarizeSamples(UncachedScreenTraceSamples)
+	);
+	Metrics->SetObjectField(TEXT("GetHitResultForScreenPosition.Cached"), SummarizeSamples(CachedScreenTraceSamples));
+	Metrics->SetNumberField(TEXT("GetHitResultForScreenPosition.Hits"), NumScreenTraceHits);
+	Metrics->SetObjectField(TEXT("WorldTrace"), SummarizeSamples(WorldTraceSamples));
+
+	if (CharacterFootprint.IsValid() && AiCharacterFootprint.IsValid())
+	{
+		Metrics->SetObjectField(TEXT("SpawnFootprint.Character"), CharacterFootprint);
+		Metrics->SetObjectField(TEXT("SpawnFootprint.AiCharacter"), AiCharacterFootprint);
+	}
+
+	Report->SetObjectField(TEXT("Parameters"), Parameters);
+	Report->SetObjectField(TEXT("Metrics"), Metrics);
+
+	FJsonSerializer::Serialize(Report, TJsonWriterFactory<>::Create(&ReportJson));
+
+	if (!FFileHelper::SaveStringToFile(ReportJson, *OutputPath))
+	{
+		UE_LOG(LogPf2Playground, Error, TEXT("Failed to write benchmark results to '%s'."), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogPf2Playground, Display, TEXT("Benchmark results written to '%s':\n%s"), *OutputPath, *ReportJson);
+
+	return 0;
+}
+
+TSharedRef<FJsonObject> UOpenPF2PlaygroundBenchmarkCommandlet::CreateReport()
+{
+	const TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+
+	Report->SetStringField(TEXT("BuildVersion"), FApp::GetBuildVersion());
+	Report->SetStringField(TEXT("BuildConfiguration"), LexToString(FApp::GetBuildConfiguration()));
+	Report->SetStringField(TEXT("Platform"), FPlatformProperties::IniPlatformName());
+	Report->SetStringField(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+
+	return Report;
+}
+
+TSharedRef<FJsonObject> UOpenPF2PlaygroundBenchmarkCommandlet::SummarizeSamples(TArray<double>& Samples)
+{
+	const TSharedRef<FJsonObject> Summary = MakeShared<FJsonObject>();
+	double                        Total   = 0.0;
+
+	Samples.Sort();
+
+	for (const double Sample : Samples)
+	{
+		Total += Sample;
+	}
+
+	Summary->SetNumberField(TEXT("Samples"), Samples.Num());
+	Summary->SetNumberField(TEXT("MinMs"), (Samples.Num() != 0) ? Samples[0] * 1000.0 : 0.0);
+	Summary->SetNumberField(TEXT("MeanMs"), (Samples.Num() != 0) ? (Total / Samples.Num()) * 1000.0 : 0.0);
+	Summary->SetNumberField(TEXT("P50Ms"), GetPercentile(Samples, 50.0) * 1000.0);
+	Summary->SetNumberField(TEXT("P90Ms"), GetPercentile(Samples, 90.0) * 1000.0);
+	Summary->SetNumberField(TEXT("P99Ms"), GetPercentile(Samples, 99.0) * 1000.0);
+	Summary->SetNumberField(TEXT("MaxMs"), (Samples.Num() != 0) ? Samples.Last() * 1000.0 : 0.0);
+
+	return Summary;
+}
+
+double UOpenPF2PlaygroundBenchmarkCommandlet::GetPercentile(const TArray<double>& SortedSamples,
+                                                            const double          Percentile)
+{
+	int32 Rank;
+
+	if (SortedSamples.Num() == 0)
+	{
+		return 0.0;
+	}
+
+	Rank = FMath::CeilToInt32((Percentile / 100.0) * SortedSamples.Num());
+
+	return SortedSamples[FMath::Clamp(Rank - 1, 0, SortedSamples.Num() - 1)];
+}
+
+UWorld* UOpenPF2PlaygroundBenchmarkCommandlet::CreateBenchmarkWorld(
+	const TSubclassOf<AGameModeBase> GameModeClass,
+	UGameInstance*&                  OutGameInstance) const
+{
+	const FSoftClassPath GameInstanceClassPath = GetDefault<UGameMapsSettings>()->GameInstanceClass;
+	UClass*              GameInstanceClass     = GameInstanceClassPath.TryLoadClass<UGameInstance>();
+	UWorld*              World;
+	FURL                 Url;
+
+	if (GameInstanceClass == nullptr)
+	{
+		GameInstanceClass = UGameInstance::StaticClass();
+	}
+
+	// The game instance creates the world and its world context, and owns both, just as it would in a packaged game.
+	OutGameInstance = NewObject<UGameInstance>(GEngine, GameInstanceClass);
+	OutGameInstance->InitializeStandalone(TEXT("Pf2PlaygroundBenchmark"));
+
+	World = OutGameInstance->GetWorld();
+
+	Url.AddOption(*FString::Printf(TEXT("game=%s"), *(GameModeClass->GetPathName())));
+
+	// The game mode spawns the game state when play is initialized.
+	World->SetGameMode(Url);
+	World->InitializeActorsForPlay(Url);
+	World->BeginPlay();
+
+	if ((World->GetAuthGameMode() == nullptr) || (World->GetGameState() == nullptr))
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT("Failed to spawn the game mode ('%s') or its game state for the benchmark."),
+			*(GameModeClass->GetPathName())
+		);
+
+		OutGameInstance->Shutdown();
+
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+
+		return nullptr;
+	}
+
+	return World;
+}
+
+AOpenPF2PlaygroundCharacterBase* UOpenPF2PlaygroundBenchmarkCommandlet::SpawnCharacter(
+	UWorld*                             World,
+	const TSubclassOf<UGameplayAbility> AbilityClass,
+	const int32                         NumAbilities,
+	const FVector&                      Location) const
+{
+	FActorSpawnParameters            SpawnParameters;
+	AOpenPF2PlaygroundCharacterBase* Character;
+	UAbilitySystemComponent*         Asc;
+
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	Character = World->SpawnActor<AOpenPF2PlaygroundCharacterBase>(Location, FRotator::ZeroRotator, SpawnParameters);
+
+	if (Character == nullptr)
+	{
+		return nullptr;
+	}
+
+	Asc = Character->GetAbilitySystemComponent();
+
+	if (Asc == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (int32 AbilityIndex = 0; AbilityIndex < NumAbilities; ++AbilityIndex)
+	{
+		Asc->GiveAbility(FGameplayAbilitySpec(AbilityClass, 1, INDEX_NONE, Character));
+	}
+
+	return Character;
+}
+
+void UOpenPF2PlaygroundBenchmarkCommandlet::BenchmarkLoadInputAbilityBindings(
+	const TArray<AOpenPF2PlaygroundCharacterBase*>& Characters,
+	const int32                                    NumIterations,
+	TArray<double>&                                OutInitialSamples,
+	TArray<double>&                                OutSamples) const
+{
+	OutInitialSamples.Reserve(Characters.Num());
+	OutSamples.Reserve(Characters.Num() * NumIterations);
+
+	for (AOpenPF2PlaygroundCharacterBase* Character : Characters)
+	{
+		for (int32 Iteration = 0; Iteration <= NumIterations; ++Iteration)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+
+			Character->LoadInputAbilityBindings();
+
+			if (Iteration == 0)
+			{
+				OutInitialSamples.Add(FPlatformTime::Seconds() - StartTime);
+			}
+			else
+			{
+				OutSamples.Add(FPlatformTime::Seconds() - StartTime);
+			}
+		}
+	}
+}
+
+void UOpenPF2PlaygroundBenchmarkCommandlet::BenchmarkBuildPayloadForAbilityActivation(
+	const TArray<AOpenPF2PlaygroundCharacterBase*>& Characters,
+	const int32                                    NumIterations,
+	TArray<double>&                                OutSamples) const
+{
+	for (const AOpenPF2PlaygroundCharacterBase* Character : Characters)
+	{
+		UOpenPF2PlaygroundAbilityBindingsComponent* BindingsComponent =
+			Character->FindComponentByClass<UOpenPF2PlaygroundAbilityBindingsComponent>();
+		const UAbilitySystemComponent*              Asc               = Character->GetAbilitySystemComponent();
+
+		if ((BindingsComponent == nullptr) || (Asc == nullptr))
+		{
+			continue;
+		}
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (const FGameplayAbilitySpec& AbilitySpec : Asc->GetActivatableAbilities())
+			{
+				const double StartTime = FPlatformTime::Seconds();
+
+				BindingsComponent->BuildPayloadForAbilityActivation(AbilitySpec.Handle);
+
+				OutSamples.Add(FPlatformTime::Seconds() - StartTime);
+			}
+		}
+	}
+}
+
+void UOpenPF2PlaygroundBenchmarkCommandlet::BenchmarkPossessionSwaps(
+	AOpenPF2PlaygroundPlayerControllerBase*        PlayerController,
+	const TArray<AOpenPF2PlaygroundCharacterBase*>& Characters,
+	const int32                                    NumIterations,
+	TArray<double>&                                OutSamples) const
+{
+	OutSamples.Reserve(Characters.Num() * NumIterations);
+
+	PlayerController->Possess(Characters[0]);
+
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		for (int32 CharacterIndex = 1; CharacterIndex <= Characters.Num(); ++CharacterIndex)
+		{
+			AOpenPF2PlaygroundCharacterBase* NextCharacter = Characters[CharacterIndex % Characters.Num()];
+			const double                     StartTime     = FPlatformTime::Seconds();
+
+			PlayerController->NotifyPossessionSwapRequested();
+			PlayerController->Possess(NextCharacter);
+
+			OutSamples.Add(FPlatformTime::Seconds() - StartTime);
+		}
+	}
+
+	PlayerController->UnPossess();
+}
+
+int32 UOpenPF2PlaygroundBenchmarkCommandlet::BenchmarkScreenTraces(
+	AOpenPF2PlaygroundPlayerControllerBase*        PlayerController,
+	const TArray<AOpenPF2PlaygroundCharacterBase*>& Characters,
+	const int32                                    NumIterations,
+	TArray<double>&                                OutUncachedSamples,
+	TArray<double>&                                OutCachedSamples,
+	TArray<double>&                                OutWorldSamples) const
+{
+	const UWorld*         World       = PlayerController->GetWorld();
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(Pf2PlaygroundBenchmarkTrace), true);
+	int32                 NumHits     = 0;
+
+	OutUncachedSamples.Reserve(Characters.Num() * NumIterations);
+	OutCachedSamples.Reserve(Characters.Num() * NumIterations);
+	OutWorldSamples.Reserve(Characters.Num() * NumIterations);
+
+	for (int32 CharacterIndex = 0; CharacterIndex < Characters.Num(); ++CharacterIndex)
+	{
+		const FVector RayStart = Characters[CharacterIndex]->GetActorLocation() + FVector(0.0f, 0.0f, 1000.0f);
+		const FVector RayEnd   = RayStart + (FVector::DownVector * PlayerController->HitResultTraceDistance);
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			// The frame never advances during the benchmark, so every position is unique to keep the first trace of it
+			// from being answered by the cache of the player controller.
+			const FVector2D ScreenPosition = FVector2D(CharacterIndex, Iteration);
+			FHitResult      HitResult;
+			double          StartTime      = FPlatformTime::Seconds();
+
+			if (PlayerController->GetHitResultForScreenPosition(ScreenPosition, ECC_Visibility, true, HitResult))
+			{
+				++NumHits;
+			}
+
+			OutUncachedSamples.Add(FPlatformTime::Seconds() - StartTime);
+
+			StartTime = FPlatformTime::Seconds();
+
+			PlayerController->GetHitResultForScreenPosition(ScreenPosition, ECC_Visibility, true, HitResult);
+
+			OutCachedSamples.Add(FPlatformTime::Seconds() - StartTime);
+
+			StartTime = FPlatformTime::Seconds();
+
+			World->LineTraceSingleByChannel(HitResult, RayStart, RayEnd, ECC_Visibility, QueryParams);
+
+			OutWorldSamples.Add(FPlatformTime::Seconds() - StartTime);
+		}
+	}
+
+	return NumHits;
+}
+
+TSharedRef<FJsonObject> UOpenPF2PlaygroundBenchmarkCommandlet::BenchmarkSpawnFootprint(
+	UWorld*                                            World,
+	const TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass,
+	const int32                                        NumCharacters,
+	const int32                                        NumIterations) const
+{
+	const TSharedRef<FJsonObject>            Footprint      = MakeShared<FJsonObject>();
+	FActorSpawnParameters                    SpawnParameters;
+	TArray<AOpenPF2PlaygroundCharacterBase*> Characters;
+	TArray<double>                           SpawnSamples,
+	                                         TickSamples;
+	int64                                    NumBytes       = 0;
+	int32                                    NumComponents  = 0,
+	                                         NumControllers = 0;
+
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (int32 CharacterIndex = 0; CharacterIndex < NumCharacters; ++CharacterIndex)
+	{
+		// Keep the crowd away from the characters of the other benchmarks.
+		const FVector                    Location  = FVector(CharacterIndex * 500.0f, 10000.0f, 0.0f);
+		const double                     StartTime = FPlatformTime::Seconds();
+		AOpenPF2PlaygroundCharacterBase* Character = World->SpawnActor<AOpenPF2PlaygroundCharacterBase>(
+			CharacterClass,
+			Location,
+			FRotator::ZeroRotator,
+			SpawnParameters
+		);
+
+		// Compare like with like: every character gets an AI controller, whether or not its class possesses itself
+		// with AI on spawn. Otherwise, only the AI-only class would pay for a controller.
+		if ((Character != nullptr) && (Character->GetController() == nullptr))
+		{
+			Character->SpawnDefaultController();
+		}
+
+		SpawnSamples.Add(FPlatformTime::Seconds() - StartTime);
+
+		if (Character != nullptr)
+		{
+			Characters.Add(Character);
+		}
+	}
+
+	for (AOpenPF2PlaygroundCharacterBase* Character : Characters)
+	{
+		AController* Controller = Character->GetController();
+
+		NumBytes += FArchiveCountMem(Character).GetMax();
+
+		Character->ForEachComponent(
+			false,
+			[&NumBytes, &NumComponents](UActorComponent* Component)
+			{
+				NumBytes += FArchiveCountMem(Component).GetMax();
+				++NumComponents;
+			}
+		);
+
+		// The controller is part of what it costs to have the character in the world.
+		if (Controller != nullptr)
+		{
+			++NumControllers;
+
+			NumBytes += FArchiveCountMem(Controller).GetMax();
+
+			Controller->ForEachComponent(
+				false,
+				[&NumBytes](UActorComponent* Component)
+				{
+					NumBytes += FArchiveCountMem(Component).GetMax();
+				}
+			);
+		}
+	}
+
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		World->Tick(LEVELTICK_All, 1.0f / 60.0f);
+
+		TickSamples.Add(FPlatformTime::Seconds() - StartTime);
+	}
+
+	for (AOpenPF2PlaygroundCharacterBase* Character : Characters)
+	{
+		AController* Controller = Character->GetController();
+
+		if (Controller != nullptr)
+		{
+			Controller->Destroy();
+		}
+
+		Character->Destroy();
+	}
+
+	Footprint->SetStringField(TEXT("Class"), CharacterClass->GetPathName());
+	Footprint->SetNumberField(TEXT("Spawned"), Characters.Num());
+	Footprint->SetNumberField(TEXT("Controllers"), NumControllers);
+	Footprint->SetObjectField(TEXT("Spawn"), SummarizeSamples(SpawnSamples));
+	Footprint->SetObjectField(TEXT("Tick"), SummarizeSamples(TickSamples));
+
+	if (Characters.Num() != 0)
+	{
+		const double NumSpawned = Characters.Num();
+
+		Footprint->SetNumberField(TEXT("BytesPerCharacter"), NumBytes / NumSpawned);
+		Footprint->SetNumberField(TEXT("ComponentsPerCharacter"), NumComponents / NumSpawned);
+	}
+
+	return Footprint;
+}
@@ -0,0 +1,290 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Commandlets/Commandlet.h>
+
+#include "OpenPF2PlaygroundBenchmarkCommandlet.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class AGameModeBase;
+class AOpenPF2PlaygroundCharacterBase;
+class AOpenPF2PlaygroundPlayerControllerBase;
+class FJsonObject;
+class UGameInstance;
+class UGameplayAbility;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A commandlet that benchmarks the hot paths of playground characters and player controllers without a viewport.
+ *
+ * The benchmark creates a game world with a game instance, the game mode of the project (which spawns the game state),
+ * and a player controller. It then spawns a number of characters into that world, grants each of them a large set of
+ * abilities, and times the following through public APIs:
+ *  - Loading input bindings for abilities (LoadInputAbilityBindings()).
+ *  - Building the payload for activating an ability (BuildPayloadForAbilityActivation()).
+ *  - Swapping possession between characters (SetPawn(), by way of Possess()).
+ *  - Screen-space traces (GetHitResultForScreenPosition()), both for new screen positions and for positions that were
+ *    already traced in the same frame, plus the world-space traces that they turn into.
+ *  - Spawning, ticking, and the memory footprint of a crowd of enemies, both as full playground characters and as
+ *    AI-only characters (AOpenPF2PlaygroundAiCharacterBase), which have no camera or input binding components.
+ *
+ * The ability that is granted must have a default input action, so that loading bindings actually binds abilities.
+ *
+ * Without a viewport, screen positions cannot be projected into the world, so screen-space traces only time the work
+ * that the player controller does around the trace (caching, and the attempt to project the position). The collision
+ * cost of the trace itself is timed separately, by tracing down onto each character from above. The number of
+ * screen-space traces that hit something is included in the results, so that runs with a viewport can be told apart.
+ *
+ * The results are written as JSON, with percentiles for each operation, so that they can be compared between releases.
+ *
+ * Usage:
+ * UnrealEditor-Cmd OpenPF2Playground.uproject -run=OpenPF2PlaygroundBenchmark -nullrhi -unattended
+ *     [-Characters=<N>] [-Abilities=<N>] [-Iterations=<N>] [-Enemies=<N>] [-AbilityClass=<Class Path>]
+ *     [-GameMode=<Class Path>] [-Output=<JSON Path>]
+ */
+UCLASS(Config=Game)
+class UOpenPF2PlaygroundBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * The number of characters to spawn, unless overridden on the command line.
+	 */
+	UPROPERTY(Config)
+	int32 DefaultNumCharacters;
+
+	/**
+	 * The number of abilities to grant to each character, unless overridden on the command line.
+	 */
+	UPROPERTY(Config)
+	int32 DefaultNumAbilities;
+
+	/**
+	 * The number of times to time each operation on each character, unless overridden on the command line.
+	 */
+	UPROPERTY(Config)
+	int32 DefaultNumIterations;
+
+	/**
+	 * The number of enemies to spawn when comparing character footprints, unless overridden on the command line.
+	 */
+	UPROPERTY(Config)
+	int32 DefaultNumEnemies;
+
+	/**
+	 * The ability to grant to each character, unless overridden on the command line.
+	 *
+	 * This must be an OpenPF2 ability that has a default input action mapping.
+	 */
+	UPROPERTY(Config)
+	TSoftClassPtr<UGameplayAbility> DefaultAbilityClass;
+
+	/**
+	 * The game mode of the benchmark world, unless overridden on the command line.
+	 *
+	 * If this is not set, the global default game mode of the project is used.
+	 */
+	UPROPERTY(Config)
+	TSoftClassPtr<AGameModeBase> DefaultGameModeClass;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundBenchmarkCommandlet();
+
+	// =================================================================================================================
+	// Public Methods - UCommandlet Overrides
+	// =================================================================================================================
+	virtual int32 Main(const FString& Params) override;
+
+	// =================================================================================================================
+	// Public Static Methods
+	// =================================================================================================================
+	/**
+	 * Creates a JSON report that identifies the build and platform that produced it, and when it was produced.
+	 *
+	 * All of the reports written by the performance tools of the playground start from this, so that results from
+	 * different tools and builds can be told apart.
+	 *
+	 * @return
+	 *	A JSON object with the build version, build configuration, platform, and timestamp of the report.
+	 */
+	static TSharedRef<FJsonObject> CreateReport();
+
+	/**
+	 * Summarizes a set of timing samples as a JSON object.
+	 *
+	 * @param Samples
+	 *	The samples to summarize, in seconds. The samples are sorted in place.
+	 *
+	 * @return
+	 *	A JSON object with the number of samples, plus the minimum, mean, percentiles, and maximum (in milliseconds).
+	 */
+	static TSharedRef<FJsonObject> SummarizeSamples(TArray<double>& Samples);
+
+	/**
+	 * Gets the value at the given percentile of a set of sorted samples, using the nearest-rank method.
+	 *
+	 * @param SortedSamples
+	 *	The samples, in ascending order.
+	 * @param Percentile
+	 *	The percentile to get, from 0 to 100.
+	 *
+	 * @return
+	 *	The value at the percentile; or, zero if there are no samples.
+	 */
+	static double GetPercentile(const TArray<double>& SortedSamples, const double Percentile);
+
+protected:
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Creates a game world, with a game instance and a game mode, and begins play in it.
+	 *
+	 * @param GameModeClass
+	 *	The type of game mode to use for the world.
+	 * @param OutGameInstance
+	 *	The game instance that owns the world.
+	 *
+	 * @return
+	 *	The new world; or, nullptr if the game mode or game state could not be spawned.
+	 */
+	UWorld* CreateBenchmarkWorld(const TSubclassOf<AGameModeBase> GameModeClass, UGameInstance*& OutGameInstance) const;
+
+	/**
+	 * Spawns a character into the benchmark world and grants it abilities.
+	 *
+	 * @param World
+	 *	The world into which the character is to be spawned.
+	 * @param AbilityClass
+	 *	The type of ability to grant to the character.
+	 * @param NumAbilities
+	 *	The number of abilities to grant to the character.
+	 * @param Location
+	 *	The location at which to spawn the character.
+	 *
+	 * @return
+	 *	The new character; or, nullptr if it could not be spawned.
+	 */
+	AOpenPF2PlaygroundCharacterBase* SpawnCharacter(UWorld*                             World,
+	                                                const TSubclassOf<UGameplayAbility> AbilityClass,
+	                                                const int32                         NumAbilities,
+	                                                const FVector&                      Location) const;
+
+	/**
+	 * Times loading input bindings for abilities on each character.
+	 *
+	 * @param Characters
+	 *	The characters to benchmark.
+	 * @param NumIterations
+	 *	The number of times to load the bindings of each character.
+	 * @param OutInitialSamples
+	 *	The time taken by the first load of each character, which binds all abilities from scratch.
+	 * @param OutSamples
+	 *	The time taken by each subsequent load, when the abilities of the character have not changed.
+	 */
+	void BenchmarkLoadInputAbilityBindings(const TArray<AOpenPF2PlaygroundCharacterBase*>& Characters,
+	                                       const int32                                    NumIterations,
+	                                       TArray<double>&                                OutInitialSamples,
+	                                       TArray<double>&                                OutSamples) const;
+
+	/**
+	 * Times building the activation payload of every ability of each character.
+	 *
+	 * @param Characters
+	 *	The characters to benchmark.
+	 * @param NumIterations
+	 *	The number of times to build the payload of each ability.
+	 * @param OutSamples
+	 *	The time taken to build each payload.
+	 */
+	void BenchmarkBuildPayloadForAbilityActivation(const TArray<AOpenPF2PlaygroundCharacterBase*>& Characters,
+	                                               const int32                                    NumIterations,
+	                                               TArray<double>&                                OutSamples) const;
+
+	/**
+	 * Times swapping possession from each character to the next.
+	 *
+	 * @param PlayerController
+	 *	The player controller that is to possess each character in turn.
+	 * @param Characters
+	 *	The characters to benchmark.
+	 * @param NumIterations
+	 *	The number of times to cycle possession through all characters.
+	 * @param OutSamples
+	 *	The time taken by each swap.
+	 */
+	void BenchmarkPossessionSwaps(AOpenPF2PlaygroundPlayerControllerBase*        PlayerController,
+	                              const TArray<AOpenPF2PlaygroundCharacterBase*>& Characters,
+	                              const int32                                    NumIterations,
+	                              TArray<double>&                                OutSamples) const;
+
+	/**
+	 * Times screen-space traces through the player controller, and the world-space traces behind them.
+	 *
+	 * @param PlayerController
+	 *	The player controller through which to perform screen-space traces.
+	 * @param Characters
+	 *	The characters to trace down onto from above.
+	 * @param NumIterations
+	 *	The number of times to perform each kind of trace for each character.
+	 * @param OutUncachedSamples
+	 *	The time taken by each screen-space trace for a position that had not yet been traced during the frame.
+	 * @param OutCachedSamples
+	 *	The time taken by each screen-space trace for a position that had already been traced during the frame.
+	 * @param OutWorldSamples
+	 *	The time taken by each world-space trace.
+	 *
+	 * @return
+	 *	The number of uncached screen-space traces that hit something.
+	 */
+	int32 BenchmarkScreenTraces(AOpenPF2PlaygroundPlayerControllerBase*        PlayerController,
+	                            const TArray<AOpenPF2PlaygroundCharacterBase*>& Characters,
+	                            const int32                                    NumIterations,
+	                            TArray<double>&                                OutUncachedSamples,
+	                            TArray<double>&                                OutCachedSamples,
+	                            TArray<double>&                                OutWorldSamples) const;
+
+	/**
+	 * Times spawning and ticking a crowd of characters of the given class, and measures how much memory each takes.
+	 *
+	 * The characters are destroyed (along with any AI controllers that possessed them) before this method returns.
+	 * Every character is possessed by an AI controller, regardless of the auto-possession setting of the class, so that
+	 * the results for different classes are comparable. Spawn times and memory include the controller of each
+	 * character.
+	 *
+	 * @param World
+	 *	The world into which the characters are to be spawned.
+	 * @param CharacterClass
+	 *	The class of character to spawn.
+	 * @param NumCharacters
+	 *	The number of characters to spawn.
+	 * @param NumIterations
+	 *	The number of frames to tick the world while all of the characters are present.
+	 *
+	 * @return
+	 *	A JSON object with the spawn and tick timings, plus the number of components and bytes per character.
+	 */
+	TSharedRef<FJsonObject> BenchmarkSpawnFootprint(
+		UWorld*                                            World,
+		const TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass,
+		const int32                                        NumCharacters,
+		const int32                                        NumIterations) const;
+};
@@ -0,0 +1,128 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <GameFramework/Actor.h>
+
+#include "OpenPF2PlaygroundCameraManagementState.generated.h"
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * How a player controller manages the camera target of the player.
+ */
+UENUM(BlueprintType)
+enum class EOpenPF2PlaygroundCameraManagementMode : uint8
+{
+	/**
+	 * The player controller changes the camera target to each pawn that it possesses.
+	 */
+	Automatic,
+
+	/**
+	 * The camera target is managed manually (e.g., by an encounter camera), and is left alone during possession.
+	 */
+	Manual,
+};
+
+/**
+ * The camera management state of a player controller, replicated to the player who owns the controller.
+ */
+USTRUCT(BlueprintType)
+struct FOpenPF2PlaygroundCameraManagementState
+{
+	GENERATED_BODY()
+
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * How the camera target of the player is being managed.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="OpenPF2 Playground|Camera")
+	EOpenPF2PlaygroundCameraManagementMode Mode;
+
+	/**
+	 * The actor to use as the camera target while the camera is being managed manually.
+	 *
+	 * If this is nullptr, the camera target is left as-is when switching to manual management.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="OpenPF2 Playground|Camera")
+	AActor* ViewTarget;
+
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor for FOpenPF2PlaygroundCameraManagementState.
+	 */
+	explicit FOpenPF2PlaygroundCameraManagementState() :
+		Mode(EOpenPF2PlaygroundCameraManagementMode::Automatic),
+		ViewTarget(nullptr)
+	{
+	}
+
+	/**
+	 * Constructor for FOpenPF2PlaygroundCameraManagementState.
+	 *
+	 * @param Mode
+	 *	How the camera target of the player is being managed.
+	 * @param ViewTarget
+	 *	The actor to use as the camera target while the camera is being managed manually.
+	 */
+	explicit FOpenPF2PlaygroundCameraManagementState(const EOpenPF2PlaygroundCameraManagementMode Mode,
+	                                                 AActor*                                      ViewTarget) :
+		Mode(Mode),
+		ViewTarget(ViewTarget)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Determines whether the player controller should manage the camera target during possession.
+	 *
+	 * @return
+	 *	true if the camera target is managed automatically; or, false if it is managed manually.
+	 */
+	FORCEINLINE bool IsAutomatic() const
+	{
+		return this->Mode == EOpenPF2PlaygroundCameraManagementMode::Automatic;
+	}
+
+	// =================================================================================================================
+	// Public Operators
+	// =================================================================================================================
+	/**
+	 * Equality operator for FOpenPF2PlaygroundCameraManagementState.
+	 *
+	 * @param Other
+	 *	The other state against which to compare.
+	 *
+	 * @return
+	 *	true if both states manage the camera the same way; or, false if they do not.
+	 */
+	FORCEINLINE bool operator==(const FOpenPF2PlaygroundCameraManagementState& Other) const
+	{
+		return (this->Mode == Other.Mode) && (this->ViewTarget == Other.ViewTarget);
+	}
+
+	/**
+	 * Inequality operator for FOpenPF2PlaygroundCameraManagementState.
+	 *
+	 * @param Other
+	 *	The other state against which to compare.
+	 *
+	 * @return
+	 *	true if the states manage the camera differently; or, false if they do not.
+	 */
+	FORCEINLINE bool operator!=(const FOpenPF2PlaygroundCameraManagementState& Other) const
+	{
+		return !(*this == Other);
+	}
+};
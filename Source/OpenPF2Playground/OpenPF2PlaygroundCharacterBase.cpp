@@ -4,6 +4,7 @@
 
 #include "OpenPF2PlaygroundCharacterBase.h"
 
+#include <AbilitySystemComponent.h>
 #include <EnhancedInputComponent.h>
 
 #include <Camera/CameraComponent.h>
@@ -14,14 +15,28 @@
 #include <GameFramework/CharacterMovementComponent.h>
 #include <GameFramework/SpringArmComponent.h>
 
+#include <Misc/CoreDelegates.h>
+
 #include "OpenPF2Playground.h"
 #include "OpenPF2PlaygroundAbilityBindingsComponent.h"
+#include "OpenPF2PlaygroundCharacterPoolSubsystem.h"
+#include "OpenPF2PlaygroundEquippedInventoryComponent.h"
+#include "OpenPF2PlaygroundEventLog.h"
+#include "OpenPF2PlaygroundGameState.h"
+#include "OpenPF2PlaygroundReplicationGraph.h"
+#include "OpenPF2PlaygroundTickBudgetSubsystem.h"
 
 #include "Commands/PF2AbilityBindingsComponent.h"
 
 #include "Utilities/PF2LogUtilities.h"
 
-AOpenPF2PlaygroundCharacterBase::AOpenPF2PlaygroundCharacterBase()
+const FName AOpenPF2PlaygroundCharacterBase::CameraBoomComponentName        = TEXT("CameraBoom");
+const FName AOpenPF2PlaygroundCharacterBase::FollowCameraComponentName      = TEXT("FollowCamera");
+const FName AOpenPF2PlaygroundCharacterBase::AbilityBindingsComponentName   = TEXT("AbilityBindings");
+const FName AOpenPF2PlaygroundCharacterBase::EquippedInventoryComponentName = TEXT("EquippedInventory");
+
+AOpenPF2PlaygroundCharacterBase::AOpenPF2PlaygroundCharacterBase(const FObjectInitializer& ObjectInitializer) :
+	Super(ObjectInitializer)
 {
 	// Set size for collision capsule
 	this->GetCapsuleComponent()->InitCapsuleSize(42.0f, 96.0f);
@@ -39,31 +54,62 @@ AOpenPF2PlaygroundCharacterBase::AOpenPF2PlaygroundCharacterBase()
 	CharacterMovementComponent->JumpZVelocity             = 600.0f;
 	CharacterMovementComponent->AirControl                = 0.2f;
 
+	// The camera and input components are optional so that subclasses for characters that players never control
+	// (e.g., AOpenPF2PlaygroundAiCharacterBase) can opt out of them with DoNotCreateDefaultSubobject().
+
 	// Create a camera boom (pulls in towards the player if there is a collision)
-	USpringArmComponent* CameraBoomComponent = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
+	USpringArmComponent* CameraBoomComponent =
+		CreateOptionalDefaultSubobject<USpringArmComponent>(CameraBoomComponentName);
 
-	CameraBoomComponent->SetupAttachment(RootComponent);
-	CameraBoomComponent->TargetArmLength         = 300.0f; // The camera follows at this distance behind the character
-	CameraBoomComponent->bUsePawnControlRotation = true;   // Rotate the arm based on the controller
+	if (CameraBoomComponent != nullptr)
+	{
+		CameraBoomComponent->SetupAttachment(RootComponent);
+		CameraBoomComponent->TargetArmLength         = 300.0f; // The camera follows at this distance behind the character
+		CameraBoomComponent->bUsePawnControlRotation = true;   // Rotate the arm based on the controller
+	}
 
 	this->CameraBoom = CameraBoomComponent;
 
 	// Create a follow camera
-	UCameraComponent* FollowCameraComponent = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
-
-	// Attach the camera to the end of the boom and let the boom adjust to match the controller orientation.
-	FollowCameraComponent->SetupAttachment(CameraBoom, USpringArmComponent::SocketName);
+	UCameraComponent* FollowCameraComponent =
+		CreateOptionalDefaultSubobject<UCameraComponent>(FollowCameraComponentName);
 
-	// Camera does not rotate relative to arm
-	FollowCameraComponent->bUsePawnControlRotation = false;
+	if (FollowCameraComponent != nullptr)
+	{
+		if (CameraBoomComponent != nullptr)
+		{
+			// Attach the camera to the end of the boom and let the boom adjust to match the controller orientation.
+			FollowCameraComponent->SetupAttachment(CameraBoomComponent, USpringArmComponent::SocketName);
+		}
+		else
+		{
+			FollowCameraComponent->SetupAttachment(RootComponent);
+		}
+
+		// Camera does not rotate relative to arm
+		FollowCameraComponent->bUsePawnControlRotation = false;
+	}
 
 	this->FollowCamera = FollowCameraComponent;
 
 	// Create the component that allows binding abilities to input actions.
-	UPF2AbilityBindingsComponent* BindingsComponent =
-		CreateDefaultSubobject<UOpenPF2PlaygroundAbilityBindingsComponent>("AbilityBindings");
+	UOpenPF2PlaygroundAbilityBindingsComponent* BindingsComponent =
+		CreateOptionalDefaultSubobject<UOpenPF2PlaygroundAbilityBindingsComponent>(AbilityBindingsComponentName);
+
+	this->AbilityBindings                = BindingsComponent;
+	this->bUseIncrementalAbilityBindings = true;
+	this->LastAbilityBindingsChangeCount = 0;
+	this->AbilityChangeCoalescingWindow  = 0.0f;
+	this->NumAbilityChangeNotifications  = 0;
+	this->NumAbilityBindingsReloads      = 0;
+
+	// Create the component that tracks equipped items.
+	this->EquippedInventory =
+		CreateOptionalDefaultSubobject<UOpenPF2PlaygroundEquippedInventoryComponent>(EquippedInventoryComponentName);
 
-	this->AbilityBindings = BindingsComponent;
+	this->PossessionSwapStartTime   = 0.0;
+	this->LastPossessionSwapLatency = 0.0f;
+	this->bIsPooled                 = false;
 
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character)
 	// are set in the derived blueprint asset named MyCharacter (to avoid direct content references in C++)
@@ -71,40 +117,60 @@ AOpenPF2PlaygroundCharacterBase::AOpenPF2PlaygroundCharacterBase()
 
 void AOpenPF2PlaygroundCharacterBase::LoadInputAbilityBindings()
 {
-	UE_LOG(
-		LogPf2PlaygroundInput,
-		Verbose,
-		TEXT("[%s] Character ('%s') is loading activatable abilities."),
-		*(PF2LogUtilities::GetHostNetId(this->GetWorld())),
-		*(this->GetIdForLogs())
-	);
+	PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundLoadInputAbilityBindings, LoadInputAbilityBindings);
 
-	this->AbilityBindings->ClearBindings();
+	if (this->AbilityBindings == nullptr)
+	{
+		// This character cannot be bound to input.
+		return;
+	}
+
+	OpenPF2PlaygroundEventLog::Record(EOpenPF2PlaygroundEvent::AbilityBindingsLoading, this);
+
+	// Any pending, coalesced reload is now redundant.
+	this->GetWorldTimerManager().ClearTimer(this->PendingAbilityBindingsReloadHandle);
 
-	if (this->AbilitySystemComponent != nullptr)
+	++this->NumAbilityBindingsReloads;
+
+	if (this->bUseIncrementalAbilityBindings && (this->AbilityBindings->GetBindingsMap().Num() != 0))
+	{
+		// Only touch bindings for abilities that were granted or revoked since the last load.
+		this->LastAbilityBindingsChangeCount = this->AbilityBindings->SyncBindingsWithCharacterAbilities();
+	}
+	else
 	{
-		this->AbilityBindings->LoadAbilitiesFromCharacter();
+		const int32 NumOldBindings = this->AbilityBindings->GetBindingsMap().Num();
+
+		this->AbilityBindings->ClearBindings();
+
+		if (this->AbilitySystemComponent != nullptr)
+		{
+			this->AbilityBindings->LoadAbilitiesFromCharacter();
+		}
+
+		this->LastAbilityBindingsChangeCount = NumOldBindings + this->AbilityBindings->GetBindingsMap().Num();
 	}
+
+	OpenPF2PlaygroundEventLog::Record(
+		EOpenPF2PlaygroundEvent::AbilityBindingsLoaded,
+		this,
+		this->LastAbilityBindingsChangeCount
+	);
 }
 
 void AOpenPF2PlaygroundCharacterBase::SetupClientAbilityChangeListener()
 {
 	IPF2AbilitySystemInterface* Asc;
 
-	if (this->HasAuthority())
+	if (this->HasAuthority() || (this->AbilityBindings == nullptr))
 	{
-		// Only run this on the client.
+		// Only run this on the client, and only for characters that can be bound to input.
 		return;
 	}
 
 	Asc = Cast<IPF2AbilitySystemInterface>(this->GetAbilitySystemComponent());
 
-	UE_LOG(
-		LogPf2PlaygroundInput,
-		VeryVerbose,
-		TEXT("[%s] Client ability change listener setup."),
-		*(PF2LogUtilities::GetHostNetId(this->GetWorld()))
-	);
+	OpenPF2PlaygroundEventLog::Record(EOpenPF2PlaygroundEvent::AbilityChangeListenerSetup, this);
 
 	if (Asc == nullptr)
 	{
@@ -130,19 +196,191 @@ TScriptInterface<IPF2AbilityBindingsInterface> AOpenPF2PlaygroundCharacterBase::
 	return this->AbilityBindings;
 }
 
+void AOpenPF2PlaygroundCharacterBase::NotifyPossessionSwapStarted()
+{
+	this->PossessionSwapStartTime = FPlatformTime::Seconds();
+}
+
+void AOpenPF2PlaygroundCharacterBase::SetOwner(AActor* NewOwner)
+{
+	Super::SetOwner(NewOwner);
+
+	// The player controller of this character is derived from its owner.
+	if (this->AbilityBindings != nullptr)
+	{
+		this->AbilityBindings->InvalidateCachedPlayerController();
+	}
+}
+
+void AOpenPF2PlaygroundCharacterBase::OnRep_Owner()
+{
+	Super::OnRep_Owner();
+
+	// The player controller of this character is derived from its owner.
+	if (this->AbilityBindings != nullptr)
+	{
+		this->AbilityBindings->InvalidateCachedPlayerController();
+	}
+}
+
+void AOpenPF2PlaygroundCharacterBase::BeginPlay()
+{
+	UOpenPF2PlaygroundTickBudgetSubsystem* TickBudget =
+		UWorld::GetSubsystem<UOpenPF2PlaygroundTickBudgetSubsystem>(this->GetWorld());
+
+	Super::BeginPlay();
+
+	if (TickBudget != nullptr)
+	{
+		TickBudget->RegisterCharacter(this);
+	}
+}
+
+void AOpenPF2PlaygroundCharacterBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UOpenPF2PlaygroundTickBudgetSubsystem*    TickBudget =
+		UWorld::GetSubsystem<UOpenPF2PlaygroundTickBudgetSubsystem>(this->GetWorld());
+	UOpenPF2PlaygroundCharacterPoolSubsystem* Pool =
+		UWorld::GetSubsystem<UOpenPF2PlaygroundCharacterPoolSubsystem>(this->GetWorld());
+	AOpenPF2PlaygroundGameState*              GameState =
+		Cast<AOpenPF2PlaygroundGameState>(this->GetWorld()->GetGameState());
+
+	if (TickBudget != nullptr)
+	{
+		TickBudget->UnregisterCharacter(this);
+	}
+
+	// A combatant that dies or despawns in the middle of an encounter leaves it.
+	if ((EndPlayReason == EEndPlayReason::Destroyed) && this->HasAuthority() && (GameState != nullptr))
+	{
+		GameState->RemoveCombatant(this);
+	}
+
+	// Characters that die or despawn (e.g., when their life span expires) free up a slot in the pool they came from.
+	if (this->bIsPooled && (Pool != nullptr))
+	{
+		Pool->NotifyPooledCharacterEndPlay(this, EndPlayReason);
+	}
+
+	FCoreDelegates::OnEndFrame.Remove(this->PendingAbilityBindingsReloadEndFrameHandle);
+	this->PendingAbilityBindingsReloadEndFrameHandle.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AOpenPF2PlaygroundCharacterBase::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
 	UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerInputComponent);
 
 	check(PlayerInputComponent != nullptr);
 
-	this->AbilityBindings->ConnectToInput(EnhancedInputComponent);
+	if (this->AbilityBindings != nullptr)
+	{
+		this->AbilityBindings->ConnectToInput(EnhancedInputComponent);
+	}
+}
+
+void AOpenPF2PlaygroundCharacterBase::NotifyControllerChanged()
+{
+	const bool bWasPlayerControlled =
+		(this->PreviousController != nullptr) && this->PreviousController->IsPlayerController();
+
+	UOpenPF2PlaygroundTickBudgetSubsystem* TickBudget =
+		UWorld::GetSubsystem<UOpenPF2PlaygroundTickBudgetSubsystem>(this->GetWorld());
+
+	Super::NotifyControllerChanged();
+
+	if (this->AbilityBindings != nullptr)
+	{
+		this->AbilityBindings->InvalidateCachedPlayerController();
+	}
+
+	if (TickBudget != nullptr)
+	{
+		// A character that a player has just taken over needs to tick at full rate right away.
+		TickBudget->RequestEvaluation(this);
+	}
+
+	// Keep the party lists of the replication graph up to date, so it does not have to scan for party members.
+	UOpenPF2PlaygroundReplicationGraph::NotifyCharacterPartyChanged(this);
+
+	// BUGBUG (UE-78453): If the ASC is refreshed before the change of controller is visible on this machine, the ASC
+	// caches the old controller as the controller of this character. This breaks execution of abilities and montages.
+	// By the time we get here, the controller of this character has already been changed on this machine (on clients,
+	// this is invoked from OnRep_Controller()), so we refresh as soon as a player releases this character, even if no
+	// other controller takes it over.
+	if (bWasPlayerControlled)
+	{
+		PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundPossessionRefresh, PossessionRefresh);
+
+		this->InitializeOrRefreshAbilities();
+
+		if (this->PossessionSwapStartTime != 0.0)
+		{
+			this->LastPossessionSwapLatency = FPlatformTime::Seconds() - this->PossessionSwapStartTime;
+			this->PossessionSwapStartTime   = 0.0;
+
+			OpenPF2PlaygroundEventLog::Record(
+				EOpenPF2PlaygroundEvent::PossessionSwapCompleted,
+				this,
+				0,
+				0,
+				this->LastPossessionSwapLatency * 1000.0f
+			);
+		}
+	}
 }
 
 void AOpenPF2PlaygroundCharacterBase::Native_OnAbilitiesLoaded(const TScriptInterface<IPF2AbilitySystemInterface>& Asc)
 {
+	PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundAbilityChangeCallback, AbilityChangeCallback);
+
 	// We don't expect an ASC from another character to notify this character.
 	check(Asc.GetObject() == this->AbilitySystemComponent);
 
+	FTimerManager& TimerManager = this->GetWorldTimerManager();
+
+	++this->NumAbilityChangeNotifications;
+
+	// Replicating several ability grants at once (e.g., when equipping an item, leveling up, or starting an encounter)
+	// fires this event several times in a row, so we collect all of them and then reload bindings only once.
+	if (TimerManager.TimerExists(this->PendingAbilityBindingsReloadHandle) ||
+	    this->PendingAbilityBindingsReloadEndFrameHandle.IsValid())
+	{
+		return;
+	}
+
+	if (this->AbilityChangeCoalescingWindow > 0.0f)
+	{
+		TimerManager.SetTimer(
+			this->PendingAbilityBindingsReloadHandle,
+			this,
+			&AOpenPF2PlaygroundCharacterBase::ReloadCoalescedAbilityBindings,
+			this->AbilityChangeCoalescingWindow
+		);
+	}
+	else
+	{
+		// Reload at the end of this frame rather than on the next tick, so that input processed next frame never
+		// reaches a binding for an ability that was revoked this frame.
+		this->PendingAbilityBindingsReloadEndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(
+			this,
+			&AOpenPF2PlaygroundCharacterBase::ReloadCoalescedAbilityBindings
+		);
+	}
+}
+
+void AOpenPF2PlaygroundCharacterBase::ReloadCoalescedAbilityBindings()
+{
+	FCoreDelegates::OnEndFrame.Remove(this->PendingAbilityBindingsReloadEndFrameHandle);
+	this->PendingAbilityBindingsReloadEndFrameHandle.Reset();
+
+	OpenPF2PlaygroundEventLog::Record(
+		EOpenPF2PlaygroundEvent::AbilityBindingsReloadCoalesced,
+		this,
+		this->NumAbilityChangeNotifications,
+		this->NumAbilityBindingsReloads
+	);
+
 	this->LoadInputAbilityBindings();
 }
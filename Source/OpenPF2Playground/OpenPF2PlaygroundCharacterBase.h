@@ -15,7 +15,8 @@
 // =====================================================================================================================
 // Forward Declarations (to minimize header dependencies)
 // =====================================================================================================================
-class UPF2AbilityBindingsComponent;
+class UOpenPF2PlaygroundAbilityBindingsComponent;
+class UOpenPF2PlaygroundEquippedInventoryComponent;
 
 // =====================================================================================================================
 // Normal Declarations
@@ -29,30 +30,139 @@ class AOpenPF2PlaygroundCharacterBase : public APF2CharacterBase, public IInputB
 {
 	GENERATED_BODY()
 
+public:
+	// =================================================================================================================
+	// Public Constants
+	// =================================================================================================================
+	/**
+	 * The name of the camera boom sub-object.
+	 */
+	static const FName CameraBoomComponentName;
+
+	/**
+	 * The name of the "follow camera" sub-object.
+	 */
+	static const FName FollowCameraComponentName;
+
+	/**
+	 * The name of the sub-object that binds abilities to input.
+	 */
+	static const FName AbilityBindingsComponentName;
+
+	/**
+	 * The name of the sub-object that tracks the items that this character has equipped.
+	 */
+	static const FName EquippedInventoryComponentName;
+
 protected:
 	/**
 	 * Camera boom positioning the camera behind the character.
+	 *
+	 * This is nullptr for characters that players never control.
 	 */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
 	USpringArmComponent* CameraBoom;
 
 	/**
 	 * Camera that follows the player in third-person when outside of encounters.
+	 *
+	 * This is nullptr for characters that players never control.
 	 */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
 	UCameraComponent* FollowCamera;
 
 	/**
 	 * Component that enables character abilities to be bound to input in a dynamic/configurable way at run-time.
+	 *
+	 * This is nullptr for characters that players never control.
 	 */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
-	UPF2AbilityBindingsComponent* AbilityBindings;
+	UOpenPF2PlaygroundAbilityBindingsComponent* AbilityBindings;
+
+	/**
+	 * Component that tracks the items that this character has equipped, and the effects that those items grant.
+	 *
+	 * This is nullptr for characters that opt out of it with DoNotCreateDefaultSubobject().
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="OpenPF2 Playground|Inventory")
+	UOpenPF2PlaygroundEquippedInventoryComponent* EquippedInventory;
+
+	/**
+	 * Whether ability bindings should be updated incrementally when the abilities of this character change.
+	 *
+	 * When this is enabled, reloading ability bindings only adds bindings for abilities that have been granted and
+	 * removes bindings for abilities that have been revoked since the last load, leaving all other bindings untouched.
+	 * When this is disabled, all bindings are cleared and then reloaded from scratch.
+	 */
+	UPROPERTY(EditAnywhere, Config, BlueprintReadOnly, Category="OpenPF2 Playground|Ability Bindings")
+	bool bUseIncrementalAbilityBindings;
+
+	/**
+	 * The number of bindings that were added or removed the last time that ability bindings were loaded.
+	 */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="OpenPF2 Playground|Ability Bindings")
+	int32 LastAbilityBindingsChangeCount;
+
+	/**
+	 * How long (in seconds) to collect ability change notifications from the ASC before reloading ability bindings.
+	 *
+	 * All notifications received within this window result in a single reload of the ability bindings. If this is
+	 * zero, notifications are coalesced until the end of the current frame, so bindings never lag behind the ASC by a
+	 * frame.
+	 */
+	UPROPERTY(EditAnywhere, Config, BlueprintReadOnly, Category="OpenPF2 Playground|Ability Bindings", meta=(ClampMin=0))
+	float AbilityChangeCoalescingWindow;
+
+	/**
+	 * The number of ability change notifications this character has received from its ASC.
+	 */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="OpenPF2 Playground|Ability Bindings")
+	int32 NumAbilityChangeNotifications;
+
+	/**
+	 * The number of times that ability bindings have been reloaded for this character.
+	 */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="OpenPF2 Playground|Ability Bindings")
+	int32 NumAbilityBindingsReloads;
+
+	/**
+	 * The handle of the timer for a pending, coalesced reload of ability bindings (if any).
+	 */
+	FTimerHandle PendingAbilityBindingsReloadHandle;
+
+	/**
+	 * The handle of the end-of-frame callback for a pending, coalesced reload of ability bindings (if any).
+	 */
+	FDelegateHandle PendingAbilityBindingsReloadEndFrameHandle;
+
+	/**
+	 * The time (in seconds) at which the player controlling this character last asked to swap to a different character.
+	 *
+	 * This is recorded on the machine that sent the request, and is zero if no swap is in progress.
+	 */
+	double PossessionSwapStartTime;
+
+	/**
+	 * How long (in seconds) it took for the abilities of this character to become usable the last time that a player
+	 * swapped away from this character.
+	 */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="OpenPF2 Playground|Abilities")
+	float LastPossessionSwapLatency;
+
+	/**
+	 * Whether this character was spawned by the character pool, which recycles its slot when it ends play.
+	 */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="OpenPF2 Playground|Pooling")
+	bool bIsPooled;
 
 public:
 	/**
-	 * Default constructor.
+	 * Constructor for AOpenPF2PlaygroundCharacterBase.
+	 *
+	 * @param ObjectInitializer
+	 *	The initializer for this character, through which subclasses can opt out of the optional sub-objects.
 	 */
-	explicit AOpenPF2PlaygroundCharacterBase();
+	explicit AOpenPF2PlaygroundCharacterBase(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
 	// =================================================================================================================
 	// Public Methods - IInputBindableCharacterInterface Implementation
@@ -70,7 +180,7 @@ public:
 	 * Gets the camera boom sub-object.
 	 *
 	 * @return
-	 *	The camera boom.
+	 *	The camera boom; or, nullptr if this character does not have one.
 	 */
 	FORCEINLINE USpringArmComponent* GetCameraBoom() const
 	{
@@ -83,19 +193,76 @@ public:
 	 * This is a camera that provides the player with a view behind the third-person character.
 	 *
 	 * @return
-	 *	The camera.
+	 *	The camera; or, nullptr if this character does not have one.
 	 */
 	FORCEINLINE UCameraComponent* GetFollowCamera() const
 	{
 		return this->FollowCamera;
 	}
 
+	/**
+	 * Gets the equipped inventory sub-object.
+	 *
+	 * @return
+	 *	The equipped inventory; or, nullptr if this character does not have one.
+	 */
+	FORCEINLINE UOpenPF2PlaygroundEquippedInventoryComponent* GetEquippedInventory() const
+	{
+		return this->EquippedInventory;
+	}
+
+	/**
+	 * Notifies this character that the player controlling it has asked to swap to a different character.
+	 *
+	 * This starts the clock on measuring how long it takes for the abilities of this character to be refreshed on this
+	 * machine after the swap. It must be invoked on the machine that sends the request, before the request is sent.
+	 */
+	void NotifyPossessionSwapStarted();
+
+	/**
+	 * Determines whether this character was spawned by the character pool.
+	 *
+	 * @return
+	 *	true if this character came from the character pool; or, false if it was spawned or placed normally.
+	 */
+	FORCEINLINE bool IsPooled() const
+	{
+		return this->bIsPooled;
+	}
+
+	/**
+	 * Sets whether this character was spawned by the character pool.
+	 *
+	 * @param bInIsPooled
+	 *	Whether this character came from the character pool.
+	 */
+	FORCEINLINE void SetIsPooled(const bool bInIsPooled)
+	{
+		this->bIsPooled = bInIsPooled;
+	}
+
+	// =================================================================================================================
+	// Public Methods - AActor Overrides
+	// =================================================================================================================
+	virtual void SetOwner(AActor* NewOwner) override;
+
+	virtual void OnRep_Owner() override;
+
 protected:
+	// =================================================================================================================
+	// Protected Methods - AActor Overrides
+	// =================================================================================================================
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// =================================================================================================================
 	// Protected Methods - APawn Overrides
 	// =================================================================================================================
 	virtual void SetupPlayerInputComponent(UInputComponent* PlayerInputComponent) override;
 
+	virtual void NotifyControllerChanged() override;
+
 	// =================================================================================================================
 	// Protected Native Event Callbacks
 	// =================================================================================================================
@@ -107,4 +274,12 @@ protected:
 	 */
 	UFUNCTION()
 	virtual void Native_OnAbilitiesLoaded(const TScriptInterface<IPF2AbilitySystemInterface>& Asc);
+
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Reloads ability bindings after one or more ability change notifications have been coalesced.
+	 */
+	void ReloadCoalescedAbilityBindings();
 };
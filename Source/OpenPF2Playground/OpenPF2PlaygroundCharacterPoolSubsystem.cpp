@@ -0,0 +1,377 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundCharacterPoolSubsystem.h"
+
+#include <AIController.h>
+#include <BrainComponent.h>
+
+#include <Engine/World.h>
+
+#include <GameFramework/CharacterMovementComponent.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundCharacterBase.h"
+#include "OpenPF2PlaygroundTickBudgetSubsystem.h"
+
+void UOpenPF2PlaygroundCharacterPoolSubsystem::Deinitialize()
+{
+	int32 NumDormantCharacters = 0;
+
+	for (const TPair<TSubclassOf<AOpenPF2PlaygroundCharacterBase>, FOpenPF2PlaygroundCharacterPool>& Pool : this->Pools)
+	{
+		NumDormantCharacters += Pool.Value.DormantCharacters.Num();
+	}
+
+	if ((this->NumPoolHits != 0) || (this->NumPoolMisses != 0))
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Log,
+			TEXT(
+				"Character pool: %d hit(s), %d miss(es), %d wake(s) averaging %.3f ms, %d refill(s) averaging %.3f ms, "
+				"%d dormant character(s)."
+			),
+			this->NumPoolHits,
+			this->NumPoolMisses,
+			this->NumWakes,
+			this->GetAverageWakeTime() * 1000.0f,
+			this->NumRefills,
+			this->GetAverageRefillTime() * 1000.0f,
+			NumDormantCharacters
+		);
+	}
+
+	DEC_DWORD_STAT_BY(STAT_Pf2PlaygroundCharacterPoolDormant, NumDormantCharacters);
+
+	// The dormant characters are destroyed along with the world.
+	this->Pools.Empty();
+
+	this->NumPendingRefills = 0;
+
+	Super::Deinitialize();
+}
+
+void UOpenPF2PlaygroundCharacterPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (!this->CanManagePool())
+	{
+		return;
+	}
+
+	for (const TPair<TSoftClassPtr<AOpenPF2PlaygroundCharacterBase>, int32>& InitialPoolSize : this->InitialPoolSizes)
+	{
+		// Play is only just beginning, so a synchronous load here is hidden by the loading screen.
+		const TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass = InitialPoolSize.Key.LoadSynchronous();
+
+		if (CharacterClass == nullptr)
+		{
+			UE_LOG(
+				LogPf2Playground,
+				Warning,
+				TEXT("Character pool cannot prewarm characters of class ('%s') because it could not be loaded."),
+				*(InitialPoolSize.Key.ToString())
+			);
+		}
+		else
+		{
+			this->PrewarmPool(CharacterClass, InitialPoolSize.Value);
+		}
+	}
+}
+
+void UOpenPF2PlaygroundCharacterPoolSubsystem::Tick(const float DeltaTime)
+{
+	int32 NumRefillsThisTick = 0;
+
+	Super::Tick(DeltaTime);
+
+	if (this->NumPendingRefills == 0)
+	{
+		return;
+	}
+
+	for (TPair<TSubclassOf<AOpenPF2PlaygroundCharacterBase>, FOpenPF2PlaygroundCharacterPool>& Pool : this->Pools)
+	{
+		while ((Pool.Value.NumPendingRefills != 0) && (NumRefillsThisTick < this->MaxRefillsPerTick))
+		{
+			PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundCharacterPoolRefill, CharacterPoolRefill);
+
+			const double RefillStartTime = FPlatformTime::Seconds();
+
+			--Pool.Value.NumPendingRefills;
+			--this->NumPendingRefills;
+			++NumRefillsThisTick;
+
+			if (!this->AddDormantCharacter(Pool.Key, Pool.Value))
+			{
+				continue;
+			}
+
+			this->TotalRefillTime += FPlatformTime::Seconds() - RefillStartTime;
+
+			++this->NumRefills;
+		}
+
+		if (NumRefillsThisTick >= this->MaxRefillsPerTick)
+		{
+			break;
+		}
+	}
+}
+
+TStatId UOpenPF2PlaygroundCharacterPoolSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UOpenPF2PlaygroundCharacterPoolSubsystem, STATGROUP_Tickables);
+}
+
+void UOpenPF2PlaygroundCharacterPoolSubsystem::PrewarmPool(
+	const TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass,
+	const int32                                        Count)
+{
+	FOpenPF2PlaygroundCharacterPool* Pool;
+	int32                            NumToAdd;
+
+	if ((CharacterClass == nullptr) || !this->CanManagePool())
+	{
+		return;
+	}
+
+	Pool             = &this->Pools.FindOrAdd(CharacterClass);
+	Pool->TargetSize = FMath::Max(Pool->TargetSize, FMath::Min(Count, this->MaxDormantCharactersPerClass));
+	NumToAdd         = Pool->TargetSize - Pool->DormantCharacters.Num() - Pool->NumPendingRefills;
+
+	for (int32 Index = 0; Index < NumToAdd; ++Index)
+	{
+		if (!this->AddDormantCharacter(CharacterClass, *Pool))
+		{
+			break;
+		}
+	}
+}
+
+AOpenPF2PlaygroundCharacterBase* UOpenPF2PlaygroundCharacterPoolSubsystem::AcquireCharacter(
+	const TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass,
+	const FTransform&                                  SpawnTransform)
+{
+	PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundCharacterPoolAcquire, CharacterPoolAcquire);
+
+	FOpenPF2PlaygroundCharacterPool* Pool;
+	AOpenPF2PlaygroundCharacterBase* Character = nullptr;
+
+	if ((CharacterClass == nullptr) || !this->CanManagePool())
+	{
+		return nullptr;
+	}
+
+	Pool = this->Pools.Find(CharacterClass);
+
+	if (Pool != nullptr)
+	{
+		// Skip over any characters that were destroyed out from under the pool (e.g., by a level streaming out).
+		while ((Character == nullptr) && (Pool->DormantCharacters.Num() != 0))
+		{
+			AOpenPF2PlaygroundCharacterBase* Candidate = Pool->DormantCharacters.Pop(false);
+
+			DEC_DWORD_STAT(STAT_Pf2PlaygroundCharacterPoolDormant);
+
+			if (IsValid(Candidate))
+			{
+				Character = Candidate;
+			}
+		}
+	}
+
+	if (Character != nullptr)
+	{
+		const double WakeStartTime = FPlatformTime::Seconds();
+
+		++this->NumPoolHits;
+		INC_DWORD_STAT(STAT_Pf2PlaygroundCharacterPoolHits);
+
+		this->WakeFromDormancy(Character, SpawnTransform);
+
+		this->TotalWakeTime += FPlatformTime::Seconds() - WakeStartTime;
+
+		++this->NumWakes;
+	}
+	else
+	{
+		++this->NumPoolMisses;
+		INC_DWORD_STAT(STAT_Pf2PlaygroundCharacterPoolMisses);
+
+		Character = this->SpawnPooledCharacter(CharacterClass, SpawnTransform);
+	}
+
+	return Character;
+}
+
+void UOpenPF2PlaygroundCharacterPoolSubsystem::NotifyPooledCharacterEndPlay(
+	AOpenPF2PlaygroundCharacterBase* Character,
+	const EEndPlayReason::Type       EndPlayReason)
+{
+	const UWorld*                    World = this->GetWorld();
+	FOpenPF2PlaygroundCharacterPool* Pool;
+
+	if ((Character == nullptr) || !this->CanManagePool())
+	{
+		return;
+	}
+
+	Pool = this->Pools.Find(Character->GetClass());
+
+	if (Pool == nullptr)
+	{
+		return;
+	}
+
+	if (Pool->DormantCharacters.Remove(Character) != 0)
+	{
+		DEC_DWORD_STAT(STAT_Pf2PlaygroundCharacterPoolDormant);
+	}
+
+	// Only recycle the slots of characters that were destroyed during play, not those torn down along with the level.
+	if ((EndPlayReason != EEndPlayReason::Destroyed) || World->bIsTearingDown)
+	{
+		return;
+	}
+
+	if ((Pool->DormantCharacters.Num() + Pool->NumPendingRefills) < Pool->TargetSize)
+	{
+		++Pool->NumPendingRefills;
+		++this->NumPendingRefills;
+	}
+}
+
+int32 UOpenPF2PlaygroundCharacterPoolSubsystem::GetNumDormantCharacters(
+	const TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass) const
+{
+	const FOpenPF2PlaygroundCharacterPool* Pool = this->Pools.Find(CharacterClass);
+
+	return (Pool == nullptr) ? 0 : Pool->DormantCharacters.Num();
+}
+
+bool UOpenPF2PlaygroundCharacterPoolSubsystem::CanManagePool() const
+{
+	const UWorld* World = this->GetWorld();
+
+	return (World != nullptr) && (World->GetNetMode() != NM_Client);
+}
+
+AOpenPF2PlaygroundCharacterBase* UOpenPF2PlaygroundCharacterPoolSubsystem::SpawnPooledCharacter(
+	const TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass,
+	const FTransform&                                  SpawnTransform)
+{
+	AOpenPF2PlaygroundCharacterBase* Character;
+	FActorSpawnParameters            SpawnParameters;
+
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParameters.bDeferConstruction             = true;
+
+	Character = this->GetWorld()->SpawnActor<AOpenPF2PlaygroundCharacterBase>(
+		CharacterClass,
+		SpawnTransform,
+		SpawnParameters
+	);
+
+	if (Character == nullptr)
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT("Character pool failed to spawn a character of class ('%s')."),
+			*(GetNameSafe(CharacterClass))
+		);
+
+		return nullptr;
+	}
+
+	// Mark the character before it begins play, so that the pool hears about it when it ends play.
+	Character->SetIsPooled(true);
+	Character->FinishSpawning(SpawnTransform);
+
+	return Character;
+}
+
+bool UOpenPF2PlaygroundCharacterPoolSubsystem::AddDormantCharacter(
+	const TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass,
+	FOpenPF2PlaygroundCharacterPool&                   Pool)
+{
+	AOpenPF2PlaygroundCharacterBase* Character = this->SpawnPooledCharacter(CharacterClass, FTransform::Identity);
+
+	if (Character == nullptr)
+	{
+		return false;
+	}
+
+	this->MakeDormant(Character);
+
+	Pool.DormantCharacters.Add(Character);
+	INC_DWORD_STAT(STAT_Pf2PlaygroundCharacterPoolDormant);
+
+	return true;
+}
+
+void UOpenPF2PlaygroundCharacterPoolSubsystem::MakeDormant(AOpenPF2PlaygroundCharacterBase* Character) const
+{
+	const AAIController*                   AiController = Cast<AAIController>(Character->GetController());
+	UCharacterMovementComponent*           Movement     = Character->GetCharacterMovement();
+	UOpenPF2PlaygroundTickBudgetSubsystem* TickBudget   =
+		UWorld::GetSubsystem<UOpenPF2PlaygroundTickBudgetSubsystem>(this->GetWorld());
+
+	if ((AiController != nullptr) && (AiController->GetBrainComponent() != nullptr))
+	{
+		AiController->GetBrainComponent()->StopLogic(TEXT("Dormant in character pool"));
+	}
+
+	// Give the character its original tick settings back before turning ticking off, so the budget cannot revive it.
+	if (TickBudget != nullptr)
+	{
+		TickBudget->UnregisterCharacter(Character);
+	}
+
+	Movement->StopMovementImmediately();
+	Movement->DisableMovement();
+	Movement->SetComponentTickEnabled(false);
+
+	Character->SetActorHiddenInGame(true);
+	Character->SetActorEnableCollision(false);
+	Character->SetActorTickEnabled(false);
+
+	// Send the hidden state to clients one last time, and then stop replicating the character until it is handed out.
+	Character->FlushNetDormancy();
+	Character->SetNetDormancy(DORM_DormantAll);
+}
+
+void UOpenPF2PlaygroundCharacterPoolSubsystem::WakeFromDormancy(AOpenPF2PlaygroundCharacterBase* Character,
+                                                                const FTransform&                SpawnTransform) const
+{
+	const AAIController*                   AiController = Cast<AAIController>(Character->GetController());
+	UCharacterMovementComponent*           Movement     = Character->GetCharacterMovement();
+	UOpenPF2PlaygroundTickBudgetSubsystem* TickBudget   =
+		UWorld::GetSubsystem<UOpenPF2PlaygroundTickBudgetSubsystem>(this->GetWorld());
+
+	Character->SetNetDormancy(DORM_Awake);
+
+	Character->SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+	Character->SetActorHiddenInGame(false);
+	Character->SetActorEnableCollision(true);
+	Character->SetActorTickEnabled(true);
+
+	Movement->SetComponentTickEnabled(true);
+	Movement->SetDefaultMovementMode();
+
+	if (TickBudget != nullptr)
+	{
+		TickBudget->RegisterCharacter(Character);
+	}
+
+	if ((AiController != nullptr) && (AiController->GetBrainComponent() != nullptr))
+	{
+		AiController->GetBrainComponent()->RestartLogic();
+	}
+}
@@ -0,0 +1,346 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Subsystems/WorldSubsystem.h>
+
+#include "OpenPF2PlaygroundCharacterPoolSubsystem.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class AOpenPF2PlaygroundCharacterBase;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * The dormant characters of a single class that are waiting in the character pool to be handed out.
+ */
+USTRUCT()
+struct FOpenPF2PlaygroundCharacterPool
+{
+	GENERATED_BODY()
+
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * The characters that are hidden, inert, and ready to be handed out.
+	 */
+	UPROPERTY()
+	TArray<AOpenPF2PlaygroundCharacterBase*> DormantCharacters;
+
+	/**
+	 * The number of dormant characters that this pool is kept topped up to.
+	 */
+	int32 TargetSize;
+
+	/**
+	 * The number of replacement characters that are waiting to be spawned into this pool.
+	 */
+	int32 NumPendingRefills;
+
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit FOpenPF2PlaygroundCharacterPool() : TargetSize(0), NumPendingRefills(0)
+	{
+	}
+};
+
+/**
+ * A world subsystem that spawns characters (e.g., encounter enemies and party characters) before they are needed.
+ *
+ * Spawning a character constructs its components, its ASC and attribute sets, and its ability bindings, which causes a
+ * hitch when several enemies appear at the start of an encounter. Instead, characters of each class are spawned ahead
+ * of time, made dormant (hidden, without collision, ticking, AI logic, or replication), and woken up by
+ * AcquireCharacter().
+ *
+ * A character that has been handed out is never put back into the pool. Its ASC, active effects, and attributes are
+ * never wiped and reused, because a partial reset could leak the state of a fallen enemy into a new one. Instead, when
+ * a character that came from the pool ends play (e.g., because it was destroyed by a death handler or its life span
+ * expired), the pool recycles its slot by spawning a fresh, dormant replacement a few characters per tick.
+ *
+ * Pools are only maintained on the server; clients receive pooled characters through normal replication.
+ */
+UCLASS(Config=Game)
+class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundCharacterPoolSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * How many characters of each class to spawn into the pool when play begins.
+	 */
+	UPROPERTY(Config)
+	TMap<TSoftClassPtr<AOpenPF2PlaygroundCharacterBase>, int32> InitialPoolSizes;
+
+	/**
+	 * The maximum number of dormant characters to keep per class.
+	 */
+	UPROPERTY(Config)
+	int32 MaxDormantCharactersPerClass;
+
+	/**
+	 * The maximum number of replacement characters to spawn into the pool each tick.
+	 */
+	UPROPERTY(Config)
+	int32 MaxRefillsPerTick;
+
+	/**
+	 * The dormant characters in the pool, by character class.
+	 */
+	UPROPERTY()
+	TMap<TSubclassOf<AOpenPF2PlaygroundCharacterBase>, FOpenPF2PlaygroundCharacterPool> Pools;
+
+	/**
+	 * The total number of replacement characters that are waiting to be spawned across all pools.
+	 */
+	int32 NumPendingRefills;
+
+	/**
+	 * The number of requests for a character that were satisfied by a dormant character.
+	 */
+	int32 NumPoolHits;
+
+	/**
+	 * The number of requests for a character that required spawning a new character.
+	 */
+	int32 NumPoolMisses;
+
+	/**
+	 * The number of dormant characters that have been woken up and handed out.
+	 */
+	int32 NumWakes;
+
+	/**
+	 * The total time (in seconds) spent waking up dormant characters that have been handed out.
+	 */
+	double TotalWakeTime;
+
+	/**
+	 * The number of replacement characters that have been spawned into the pool.
+	 */
+	int32 NumRefills;
+
+	/**
+	 * The total time (in seconds) spent spawning replacement characters into the pool.
+	 */
+	double TotalRefillTime;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundCharacterPoolSubsystem() :
+		MaxDormantCharactersPerClass(32),
+		MaxRefillsPerTick(1),
+		NumPendingRefills(0),
+		NumPoolHits(0),
+		NumPoolMisses(0),
+		NumWakes(0),
+		TotalWakeTime(0.0),
+		NumRefills(0),
+		TotalRefillTime(0.0)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Methods - USubsystem Overrides
+	// =================================================================================================================
+	virtual void Deinitialize() override;
+
+	// =================================================================================================================
+	// Public Methods - UWorldSubsystem Overrides
+	// =================================================================================================================
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// =================================================================================================================
+	// Public Methods - FTickableGameObject Overrides
+	// =================================================================================================================
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Spawns dormant characters of the given class until the pool for that class holds at least the given number.
+	 *
+	 * The pool is then kept topped up to this number as characters that came from it end play. This should be called
+	 * while a hitch would not be noticed (e.g., behind a loading screen, or before the start of an encounter that will
+	 * spawn characters of this class).
+	 *
+	 * @param CharacterClass
+	 *	The class of character to spawn.
+	 * @param Count
+	 *	The number of dormant characters that the pool should hold.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Pooling")
+	void PrewarmPool(TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass, const int32 Count);
+
+	/**
+	 * Hands out a character of the given class, waking a dormant one from the pool or spawning one if none is dormant.
+	 *
+	 * Blueprints that spawn encounter enemies or party characters should call this instead of "Spawn Actor from Class".
+	 *
+	 * @param CharacterClass
+	 *	The class of character to hand out.
+	 * @param SpawnTransform
+	 *	The transform at which the character should appear.
+	 *
+	 * @return
+	 *	Either the character; or, nullptr if called on a client or if the character could not be spawned.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Pooling")
+	AOpenPF2PlaygroundCharacterBase* AcquireCharacter(TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass,
+	                                                  const FTransform&                            SpawnTransform);
+
+	/**
+	 * Notifies the pool that a character it spawned is ending play, so that its slot can be recycled.
+	 *
+	 * If the character was destroyed (e.g., when it died or its life span expired), a fresh, dormant replacement is
+	 * spawned into the pool over the following ticks. The character itself is never reused.
+	 *
+	 * @param Character
+	 *	The character that is ending play.
+	 * @param EndPlayReason
+	 *	The reason that the character is ending play.
+	 */
+	void NotifyPooledCharacterEndPlay(AOpenPF2PlaygroundCharacterBase* Character,
+	                                  const EEndPlayReason::Type       EndPlayReason);
+
+	/**
+	 * Gets the number of dormant characters of the given class that are waiting in the pool.
+	 *
+	 * @param CharacterClass
+	 *	The class of character.
+	 *
+	 * @return
+	 *	The number of dormant characters of the class.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Pooling")
+	int32 GetNumDormantCharacters(TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass) const;
+
+	/**
+	 * Gets the number of requests for a character that were satisfied by a dormant character.
+	 *
+	 * @return
+	 *	The number of pool hits.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Pooling")
+	FORCEINLINE int32 GetNumPoolHits() const
+	{
+		return this->NumPoolHits;
+	}
+
+	/**
+	 * Gets the number of requests for a character that required spawning a new character.
+	 *
+	 * @return
+	 *	The number of pool misses.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Pooling")
+	FORCEINLINE int32 GetNumPoolMisses() const
+	{
+		return this->NumPoolMisses;
+	}
+
+	/**
+	 * Gets how long it took, on average, to wake up a dormant character and hand it out.
+	 *
+	 * This is the only per-use reset that a pooled character goes through.
+	 *
+	 * @return
+	 *	The average wake time, in seconds; or, zero if no dormant character has been handed out.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Pooling")
+	FORCEINLINE float GetAverageWakeTime() const
+	{
+		return (this->NumWakes == 0) ? 0.0f : static_cast<float>(this->TotalWakeTime / this->NumWakes);
+	}
+
+	/**
+	 * Gets how long it took, on average, to spawn a replacement character into the pool.
+	 *
+	 * @return
+	 *	The average refill time, in seconds; or, zero if no replacement character has been spawned.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Pooling")
+	FORCEINLINE float GetAverageRefillTime() const
+	{
+		return (this->NumRefills == 0) ? 0.0f : static_cast<float>(this->TotalRefillTime / this->NumRefills);
+	}
+
+protected:
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Determines whether this subsystem may spawn and hand out characters (i.e., whether this is the server).
+	 *
+	 * @return
+	 *	true if this world is not a client; or, false if it is.
+	 */
+	bool CanManagePool() const;
+
+	/**
+	 * Spawns a new character that belongs to the pool.
+	 *
+	 * @param CharacterClass
+	 *	The class of character to spawn.
+	 * @param SpawnTransform
+	 *	The transform at which to spawn the character.
+	 *
+	 * @return
+	 *	Either the new character; or, nullptr if it could not be spawned.
+	 */
+	AOpenPF2PlaygroundCharacterBase* SpawnPooledCharacter(TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass,
+	                                                      const FTransform&                            SpawnTransform);
+
+	/**
+	 * Spawns a new character into the pool for the given class and puts it to sleep.
+	 *
+	 * @param CharacterClass
+	 *	The class of character to spawn.
+	 * @param Pool
+	 *	The pool to which the character should be added.
+	 *
+	 * @return
+	 *	true if the character was spawned; or, false if it could not be spawned.
+	 */
+	bool AddDormantCharacter(TSubclassOf<AOpenPF2PlaygroundCharacterBase> CharacterClass,
+	                         FOpenPF2PlaygroundCharacterPool&             Pool);
+
+	/**
+	 * Puts a character to sleep, so that it costs nothing to render, simulate, tick, or replicate while it is pooled.
+	 *
+	 * @param Character
+	 *	The character to make dormant.
+	 */
+	void MakeDormant(AOpenPF2PlaygroundCharacterBase* Character) const;
+
+	/**
+	 * Wakes up a dormant character and moves it to where it has been requested.
+	 *
+	 * @param Character
+	 *	The character to wake up.
+	 * @param SpawnTransform
+	 *	The transform at which the character should appear.
+	 */
+	void WakeFromDormancy(AOpenPF2PlaygroundCharacterBase* Character, const FTransform& SpawnTransform) const;
+};
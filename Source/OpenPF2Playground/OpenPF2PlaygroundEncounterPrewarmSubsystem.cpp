@@ -0,0 +1,256 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundEncounterPrewarmSubsystem.h"
+
+#include <AbilitySystemComponent.h>
+#include <AbilitySystemGlobals.h>
+#include <GameplayCueSet.h>
+#include <GameplayEffect.h>
+
+#include <Abilities/GameplayAbility.h>
+
+#include <Engine/StreamableManager.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundAssetManager.h"
+#include "OpenPF2PlaygroundGameplayCueManager.h"
+
+void UOpenPF2PlaygroundEncounterPrewarmSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	UOpenPF2PlaygroundGameplayCueManager* CueManager = UOpenPF2PlaygroundGameplayCueManager::Get();
+
+	Super::Initialize(Collection);
+
+	if (CueManager != nullptr)
+	{
+		this->SyncGameplayCueLoadHandle = CueManager->OnSyncGameplayCueLoad.AddUObject(
+			this,
+			&UOpenPF2PlaygroundEncounterPrewarmSubsystem::Native_OnSyncGameplayCueLoad
+		);
+	}
+}
+
+void UOpenPF2PlaygroundEncounterPrewarmSubsystem::Deinitialize()
+{
+	UOpenPF2PlaygroundGameplayCueManager* CueManager = UOpenPF2PlaygroundGameplayCueManager::Get();
+
+	if (CueManager != nullptr)
+	{
+		CueManager->OnSyncGameplayCueLoad.Remove(this->SyncGameplayCueLoadHandle);
+	}
+
+	this->NotifyEncounterEnded();
+
+	Super::Deinitialize();
+}
+
+void UOpenPF2PlaygroundEncounterPrewarmSubsystem::PrewarmEncounter(
+	const TArray<AActor*>&                                   Combatants,
+	const FOpenPF2PlaygroundEncounterPrewarmCompleteDelegate& OnPrewarmComplete)
+{
+	UOpenPF2PlaygroundAssetManager* AssetManager = Cast<UOpenPF2PlaygroundAssetManager>(UAssetManager::GetIfValid());
+	TArray<FSoftObjectPath>         AssetPaths;
+	FGameplayTagContainer           GameplayCueTags;
+
+	// Release whatever was prewarmed for the last encounter only after requesting the assets of this one, so that
+	// assets shared by both encounters are not unloaded in between.
+	const TSharedPtr<FStreamableHandle> PreviousPrewarmHandle = this->PrewarmHandle;
+
+	this->bIsEncounterActive           = true;
+	this->NumSyncCueLoadsThisEncounter = 0;
+	this->SyncCueLoadTimeThisEncounter = 0.0f;
+
+	this->CollectAbilityAssets(Combatants, AssetPaths, GameplayCueTags);
+	this->CollectGameplayCueAssets(GameplayCueTags, AssetPaths);
+
+	if (AssetManager != nullptr)
+	{
+		// Give the bundles that the game needs in encounters a head start, rather than waiting for the mode of play to
+		// change.
+		AssetManager->LoadBundlesForModeOfPlay(EPF2ModeOfPlayType::Encounter);
+	}
+
+	this->PrewarmStartTime      = FPlatformTime::Seconds();
+	this->LastPrewarmAssetCount = AssetPaths.Num();
+
+	this->PrewarmHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		AssetPaths,
+		FStreamableDelegate::CreateUObject(
+			this,
+			&UOpenPF2PlaygroundEncounterPrewarmSubsystem::Native_OnPrewarmComplete,
+			OnPrewarmComplete
+		),
+		FStreamableManager::AsyncLoadHighPriority
+	);
+
+	if (PreviousPrewarmHandle.IsValid())
+	{
+		PreviousPrewarmHandle->ReleaseHandle();
+	}
+
+	if (!this->PrewarmHandle.IsValid())
+	{
+		// There was nothing to load.
+		this->Native_OnPrewarmComplete(OnPrewarmComplete);
+	}
+}
+
+void UOpenPF2PlaygroundEncounterPrewarmSubsystem::NotifyEncounterEnded()
+{
+	if (this->bIsEncounterActive)
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Log,
+			TEXT("Encounter ended with %d GameplayCue notify(ies) loaded synchronously (%.3f ms in total)."),
+			this->NumSyncCueLoadsThisEncounter,
+			this->SyncCueLoadTimeThisEncounter * 1000.0f
+		);
+	}
+
+	this->bIsEncounterActive = false;
+
+	if (this->PrewarmHandle.IsValid())
+	{
+		this->PrewarmHandle->ReleaseHandle();
+		this->PrewarmHandle.Reset();
+	}
+}
+
+bool UOpenPF2PlaygroundEncounterPrewarmSubsystem::IsPrewarmComplete() const
+{
+	return !this->PrewarmHandle.IsValid() || this->PrewarmHandle->HasLoadCompleted();
+}
+
+void UOpenPF2PlaygroundEncounterPrewarmSubsystem::CollectAbilityAssets(
+	const TArray<AActor*>&   Combatants,
+	TArray<FSoftObjectPath>& OutAssetPaths,
+	FGameplayTagContainer&   OutGameplayCueTags) const
+{
+	const UAssetManager*        AssetManager     = UAssetManager::GetIfValid();
+	const FGameplayTagContainer GameplayCueRoots = FGameplayTagContainer(UGameplayCueSet::BaseGameplayCueTag());
+	TSet<const UClass*>         VisitedAbilities;
+
+	for (AActor* Combatant : Combatants)
+	{
+		const UAbilitySystemComponent* Asc = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Combatant);
+
+		if (Asc == nullptr)
+		{
+			continue;
+		}
+
+		for (const FGameplayAbilitySpec& AbilitySpec : Asc->GetActivatableAbilities())
+		{
+			const UGameplayAbility* Ability = AbilitySpec.Ability;
+			const UGameplayEffect*  CostEffect;
+			const UGameplayEffect*  CooldownEffect;
+			bool                    bAlreadyVisited;
+
+			if (Ability == nullptr)
+			{
+				continue;
+			}
+
+			// Tags can be added to a single spec at runtime, so these are collected for every spec.
+			OutGameplayCueTags.AppendTags(AbilitySpec.DynamicAbilityTags.Filter(GameplayCueRoots));
+
+			VisitedAbilities.Add(Ability->GetClass(), &bAlreadyVisited);
+
+			if (bAlreadyVisited)
+			{
+				continue;
+			}
+
+			OutGameplayCueTags.AppendTags(Ability->AbilityTags.Filter(GameplayCueRoots));
+
+			CostEffect     = Ability->GetCostGameplayEffect();
+			CooldownEffect = Ability->GetCooldownGameplayEffect();
+
+			for (const UGameplayEffect* Effect : { CostEffect, CooldownEffect })
+			{
+				if (Effect == nullptr)
+				{
+					continue;
+				}
+
+				for (const FGameplayEffectCue& EffectCue : Effect->GameplayCues)
+				{
+					OutGameplayCueTags.AppendTags(EffectCue.GameplayCueTags);
+				}
+			}
+
+			// The ability class itself is already loaded, since it has been granted. What still needs loading is
+			// anything it refers to softly (e.g., montages, particles, and sounds that are loaded on first use).
+			if (AssetManager != nullptr)
+			{
+				const FPrimaryAssetId AbilityAssetId =
+					AssetManager->GetPrimaryAssetIdForPath(FSoftObjectPath(Ability->GetClass()));
+
+				if (AbilityAssetId.IsValid())
+				{
+					const FAssetBundleEntry BundleEntry = AssetManager->GetAssetBundleEntry(
+						AbilityAssetId,
+						UOpenPF2PlaygroundAssetManager::EncounterBundle
+					);
+
+					for (const FTopLevelAssetPath& BundleAsset : BundleEntry.BundleAssets)
+					{
+						OutAssetPaths.Add(FSoftObjectPath(BundleAsset));
+					}
+				}
+			}
+		}
+	}
+}
+
+void UOpenPF2PlaygroundEncounterPrewarmSubsystem::CollectGameplayCueAssets(
+	const FGameplayTagContainer& GameplayCueTags,
+	TArray<FSoftObjectPath>&     OutAssetPaths) const
+{
+	const UOpenPF2PlaygroundGameplayCueManager* CueManager = UOpenPF2PlaygroundGameplayCueManager::Get();
+
+	if (CueManager != nullptr)
+	{
+		CueManager->GetCueNotifyPathsForTags(GameplayCueTags, OutAssetPaths);
+	}
+}
+
+void UOpenPF2PlaygroundEncounterPrewarmSubsystem::Native_OnPrewarmComplete(
+	const FOpenPF2PlaygroundEncounterPrewarmCompleteDelegate OnPrewarmComplete)
+{
+	this->LastPrewarmDuration = FPlatformTime::Seconds() - this->PrewarmStartTime;
+
+	UE_LOG(
+		LogPf2Playground,
+		Log,
+		TEXT("Prewarmed %d asset(s) for the upcoming encounter in %.3f ms."),
+		this->LastPrewarmAssetCount,
+		this->LastPrewarmDuration * 1000.0f
+	);
+
+	OnPrewarmComplete.ExecuteIfBound();
+}
+
+void UOpenPF2PlaygroundEncounterPrewarmSubsystem::Native_OnSyncGameplayCueLoad(const FGameplayTag& GameplayCueTag,
+                                                                                const double        LoadDuration)
+{
+	if (!this->bIsEncounterActive)
+	{
+		return;
+	}
+
+	++this->NumSyncCueLoadsThisEncounter;
+	this->SyncCueLoadTimeThisEncounter += LoadDuration;
+
+	UE_LOG(
+		LogPf2Playground,
+		Warning,
+		TEXT("GameplayCue ('%s') was loaded synchronously during an encounter (%.3f ms); it was missed by the prewarm."),
+		*(GameplayCueTag.ToString()),
+		LoadDuration * 1000.0
+	);
+}
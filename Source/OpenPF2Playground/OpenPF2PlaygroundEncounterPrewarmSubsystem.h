@@ -0,0 +1,243 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <GameplayTagContainer.h>
+
+#include <Subsystems/WorldSubsystem.h>
+
+#include "OpenPF2PlaygroundEncounterPrewarmSubsystem.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+struct FStreamableHandle;
+
+// =====================================================================================================================
+// Delegate Types
+// =====================================================================================================================
+/**
+ * Delegate for Blueprints to react to the assets of an encounter having been prewarmed.
+ */
+DECLARE_DYNAMIC_DELEGATE(FOpenPF2PlaygroundEncounterPrewarmCompleteDelegate);
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A world subsystem that streams in the assets needed by an encounter before the encounter starts.
+ *
+ * The first time an attack ability or GameplayCue fires, its notify class, particles, and sounds are loaded on demand,
+ * which causes a visible hitch on the first swing. To avoid this, the encounter trigger subsystem calls
+ * PrewarmEncounter() with all of the combatants of the encounter, and waits for the prewarm to complete before asking
+ * the game mode to start the encounter. If an encounter starts some other way (e.g., from a Blueprint trigger volume,
+ * or on a client, where trigger volumes are not tested), the game state prewarms the characters in the world as soon as
+ * the game enters Encounter mode instead. Either way, the game state releases the prewarmed assets when the game leaves
+ * Encounter mode. The prewarm asynchronously loads:
+ *  - The "Encounter" asset bundle of each ability granted to each combatant (i.e., the soft references of the ability
+ *    that are tagged with meta=(AssetBundles="Encounter"), such as montages and effects).
+ *  - The GameplayCue notifies that handle the GameplayCues of those abilities. The GameplayCues of an ability are the
+ *    GameplayCue tags in its ability tags, plus the GameplayCues of its cost and cooldown effects.
+ *
+ * Unlike asset registry dependencies, asset bundles are kept in cooked builds, so this works the same in packaged
+ * games as it does in the editor.
+ *
+ * While an encounter is in progress, GameplayCue notifies that still have to be loaded synchronously are counted, so
+ * that gaps in the prewarm can be found.
+ */
+UCLASS()
+class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundEncounterPrewarmSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * The handle of the asynchronous load of the current prewarm (if any).
+	 *
+	 * This is held until the encounter ends, to keep the prewarmed assets in memory for the duration of the encounter.
+	 */
+	TSharedPtr<FStreamableHandle> PrewarmHandle;
+
+	/**
+	 * The time (in seconds) at which the current prewarm was started.
+	 */
+	double PrewarmStartTime;
+
+	/**
+	 * How long (in seconds) the last prewarm took.
+	 */
+	float LastPrewarmDuration;
+
+	/**
+	 * How many assets were requested by the last prewarm.
+	 */
+	int32 LastPrewarmAssetCount;
+
+	/**
+	 * Whether an encounter has been prewarmed and has not yet ended.
+	 */
+	bool bIsEncounterActive;
+
+	/**
+	 * The number of GameplayCue notifies that were loaded synchronously during the current or last encounter.
+	 */
+	int32 NumSyncCueLoadsThisEncounter;
+
+	/**
+	 * The time (in seconds) spent loading GameplayCue notifies synchronously during the current or last encounter.
+	 */
+	float SyncCueLoadTimeThisEncounter;
+
+	/**
+	 * The handle of the callback registered with the GameplayCue manager for synchronous loads of notifies.
+	 */
+	FDelegateHandle SyncGameplayCueLoadHandle;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundEncounterPrewarmSubsystem() :
+		PrewarmStartTime(0.0),
+		LastPrewarmDuration(0.0f),
+		LastPrewarmAssetCount(0),
+		bIsEncounterActive(false),
+		NumSyncCueLoadsThisEncounter(0),
+		SyncCueLoadTimeThisEncounter(0.0f)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Methods - USubsystem Overrides
+	// =================================================================================================================
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Streams in the abilities and GameplayCues of all combatants in an encounter that is about to start.
+	 *
+	 * The callback is always invoked; if everything needed by the encounter is already loaded, it is invoked right away.
+	 *
+	 * @param Combatants
+	 *	The combatants of the encounter.
+	 * @param OnPrewarmComplete
+	 *	The callback to invoke once all of the assets needed by the encounter have been loaded.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Encounters")
+	void PrewarmEncounter(const TArray<AActor*>&                                   Combatants,
+	                      const FOpenPF2PlaygroundEncounterPrewarmCompleteDelegate& OnPrewarmComplete);
+
+	/**
+	 * Notifies this subsystem that the current encounter has ended, releasing the assets that were prewarmed for it.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Encounters")
+	void NotifyEncounterEnded();
+
+	/**
+	 * Determines whether the assets of the current encounter have finished loading.
+	 *
+	 * @return
+	 *	true if no prewarm is in progress; or, false if assets are still being loaded.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Encounters")
+	bool IsPrewarmComplete() const;
+
+	/**
+	 * Determines whether an encounter has been prewarmed and has not yet ended.
+	 *
+	 * @return
+	 *	true if the assets of an encounter are being held (or are still loading); or, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Encounters")
+	FORCEINLINE bool IsEncounterActive() const
+	{
+		return this->bIsEncounterActive;
+	}
+
+	/**
+	 * Gets the number of GameplayCue notifies that had to be loaded synchronously during the current or last encounter.
+	 *
+	 * @return
+	 *	The number of synchronous GameplayCue loads. This should be zero if the prewarm was complete.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Encounters")
+	FORCEINLINE int32 GetNumSyncCueLoadsThisEncounter() const
+	{
+		return this->NumSyncCueLoadsThisEncounter;
+	}
+
+	/**
+	 * Gets the time spent loading GameplayCue notifies synchronously during the current or last encounter.
+	 *
+	 * @return
+	 *	The time spent on synchronous GameplayCue loads, in seconds.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Encounters")
+	FORCEINLINE float GetSyncCueLoadTimeThisEncounter() const
+	{
+		return this->SyncCueLoadTimeThisEncounter;
+	}
+
+protected:
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Collects the "Encounter" asset bundles and GameplayCues of the abilities granted to the given combatants.
+	 *
+	 * @param Combatants
+	 *	The combatants whose abilities are to be prewarmed.
+	 * @param OutAssetPaths
+	 *	The paths of the assets to load.
+	 * @param OutGameplayCueTags
+	 *	The tags of the GameplayCues that the abilities can invoke.
+	 */
+	void CollectAbilityAssets(const TArray<AActor*>&   Combatants,
+	                          TArray<FSoftObjectPath>& OutAssetPaths,
+	                          FGameplayTagContainer&   OutGameplayCueTags) const;
+
+	/**
+	 * Collects the GameplayCue notifies that handle the given GameplayCues.
+	 *
+	 * @param GameplayCueTags
+	 *	The tags of the GameplayCues to prewarm.
+	 * @param OutAssetPaths
+	 *	The paths of the assets to load.
+	 */
+	void CollectGameplayCueAssets(const FGameplayTagContainer& GameplayCueTags,
+	                              TArray<FSoftObjectPath>&     OutAssetPaths) const;
+
+	// =================================================================================================================
+	// Protected Native Event Callbacks
+	// =================================================================================================================
+	/**
+	 * Native callback invoked when the assets of the current encounter have finished loading.
+	 *
+	 * @param OnPrewarmComplete
+	 *	The callback that was provided when the prewarm was requested.
+	 */
+	void Native_OnPrewarmComplete(const FOpenPF2PlaygroundEncounterPrewarmCompleteDelegate OnPrewarmComplete);
+
+	/**
+	 * Native callback invoked by the GameplayCue manager when a notify had to be loaded synchronously.
+	 *
+	 * @param GameplayCueTag
+	 *	The tag of the GameplayCue whose notify was loaded.
+	 * @param LoadDuration
+	 *	How long (in seconds) it took to load the notify.
+	 */
+	void Native_OnSyncGameplayCueLoad(const FGameplayTag& GameplayCueTag, const double LoadDuration);
+};
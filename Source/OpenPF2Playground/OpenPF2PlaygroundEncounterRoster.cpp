@@ -0,0 +1,131 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundEncounterRoster.h"
+
+#include "OpenPF2PlaygroundGameState.h"
+
+FOpenPF2PlaygroundEncounterRosterEntry* FOpenPF2PlaygroundEncounterRoster::FindEntry(const AActor* Combatant)
+{
+	return this->Entries.FindByPredicate(
+		[Combatant](const FOpenPF2PlaygroundEncounterRosterEntry& Entry)
+		{
+			return Entry.Combatant == Combatant;
+		}
+	);
+}
+
+void FOpenPF2PlaygroundEncounterRoster::AddOrUpdateEntry(AActor*                      Combatant,
+                                                         const bool                   bIsEnemy,
+                                                         const float                  HitPoints,
+                                                         const FGameplayTagContainer& Conditions)
+{
+	FOpenPF2PlaygroundEncounterRosterEntry* Entry = this->FindEntry(Combatant);
+
+	if (Entry == nullptr)
+	{
+		Entry = &this->Entries.AddDefaulted_GetRef();
+
+		Entry->Combatant = Combatant;
+	}
+	else if ((Entry->bIsEnemy == bIsEnemy) &&
+	         (Entry->HitPoints == HitPoints) &&
+	         (Entry->Conditions == Conditions))
+	{
+		// Nothing has changed, so there is nothing to replicate.
+		return;
+	}
+
+	Entry->bIsEnemy   = bIsEnemy;
+	Entry->HitPoints  = HitPoints;
+	Entry->Conditions = Conditions;
+
+	this->MarkItemDirty(*Entry);
+	this->NotifyRosterChanged();
+}
+
+bool FOpenPF2PlaygroundEncounterRoster::RemoveEntry(const AActor* Combatant)
+{
+	const int32 NumRemoved = this->Entries.RemoveAllSwap(
+		[Combatant](const FOpenPF2PlaygroundEncounterRosterEntry& Entry)
+		{
+			return Entry.Combatant == Combatant;
+		}
+	);
+
+	if (NumRemoved == 0)
+	{
+		return false;
+	}
+
+	this->MarkArrayDirty();
+	this->NotifyRosterChanged();
+
+	return true;
+}
+
+void FOpenPF2PlaygroundEncounterRoster::ClearEntries()
+{
+	if (this->Entries.Num() != 0)
+	{
+		this->Entries.Reset();
+
+		this->MarkArrayDirty();
+		this->NotifyRosterChanged();
+	}
+}
+
+int32 FOpenPF2PlaygroundEncounterRoster::CountRemainingEnemies() const
+{
+	int32 NumRemainingEnemies = 0;
+
+	for (const FOpenPF2PlaygroundEncounterRosterEntry& Entry : this->Entries)
+	{
+		if (Entry.IsRemainingEnemy())
+		{
+			++NumRemainingEnemies;
+		}
+	}
+
+	return NumRemainingEnemies;
+}
+
+void FOpenPF2PlaygroundEncounterRoster::PostReplicatedAdd(const TArrayView<int32>& AddedIndices,
+                                                          int32                    FinalSize) const
+{
+	this->bReceivedChanges = true;
+}
+
+void FOpenPF2PlaygroundEncounterRoster::PostReplicatedChange(const TArrayView<int32>& ChangedIndices,
+                                                             int32                    FinalSize) const
+{
+	this->bReceivedChanges = true;
+}
+
+void FOpenPF2PlaygroundEncounterRoster::PreReplicatedRemove(const TArrayView<int32>& RemovedIndices,
+                                                            int32                    FinalSize) const
+{
+	// The entries are still in the array at this point, so wait until the whole update has been applied.
+	this->bReceivedChanges = true;
+}
+
+void FOpenPF2PlaygroundEncounterRoster::PostReplicatedReceive(
+	const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters) const
+{
+	if (this->bReceivedChanges)
+	{
+		this->bReceivedChanges = false;
+
+		this->NotifyRosterChanged();
+	}
+}
+
+void FOpenPF2PlaygroundEncounterRoster::NotifyRosterChanged() const
+{
+	if (this->OwningGameState != nullptr)
+	{
+		this->OwningGameState->Native_OnEncounterRosterChanged();
+	}
+}
@@ -0,0 +1,234 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <GameplayTagContainer.h>
+
+#include <Net/Serialization/FastArraySerializer.h>
+
+#include "OpenPF2PlaygroundEncounterRoster.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class AOpenPF2PlaygroundGameState;
+struct FOpenPF2PlaygroundEncounterRoster;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A single combatant in the roster of the current encounter.
+ */
+USTRUCT(BlueprintType)
+struct FOpenPF2PlaygroundEncounterRosterEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * The combatant that this entry describes.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="OpenPF2 Playground|Encounters")
+	AActor* Combatant;
+
+	/**
+	 * Whether the combatant is an enemy of the players.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="OpenPF2 Playground|Encounters")
+	bool bIsEnemy;
+
+	/**
+	 * The current hit points of the combatant.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="OpenPF2 Playground|Encounters")
+	float HitPoints;
+
+	/**
+	 * The conditions that currently affect the combatant.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="OpenPF2 Playground|Encounters")
+	FGameplayTagContainer Conditions;
+
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor for FOpenPF2PlaygroundEncounterRosterEntry.
+	 */
+	explicit FOpenPF2PlaygroundEncounterRosterEntry() :
+		Combatant(nullptr),
+		bIsEnemy(false),
+		HitPoints(0.0f)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Determines whether the combatant of this entry is an enemy that can still fight.
+	 *
+	 * @return
+	 *	true if the combatant is an enemy that has hit points remaining; or, false otherwise.
+	 */
+	FORCEINLINE bool IsRemainingEnemy() const
+	{
+		return this->bIsEnemy && (this->HitPoints > 0.0f);
+	}
+};
+
+/**
+ * The roster of combatants in the current encounter, replicated to clients as deltas.
+ *
+ * Only entries that have been added, removed, or changed since the last update are sent to each client, so updating
+ * the hit points or conditions of one combatant costs the same no matter how many combatants are in the encounter.
+ */
+USTRUCT(BlueprintType)
+struct FOpenPF2PlaygroundEncounterRoster : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * The combatants in the encounter.
+	 */
+	UPROPERTY()
+	TArray<FOpenPF2PlaygroundEncounterRosterEntry> Entries;
+
+	/**
+	 * The game state that owns this roster; notified whenever the roster changes.
+	 */
+	UPROPERTY(NotReplicated)
+	AOpenPF2PlaygroundGameState* OwningGameState;
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * Whether entries have been added, changed, or removed by the update that is currently being received.
+	 *
+	 * The owning game state is only notified once the whole update has been applied, so that listeners never see
+	 * entries that are about to be removed.
+	 */
+	mutable bool bReceivedChanges;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor for FOpenPF2PlaygroundEncounterRoster.
+	 */
+	explicit FOpenPF2PlaygroundEncounterRoster() : OwningGameState(nullptr), bReceivedChanges(false)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Locates the entry for the given combatant.
+	 *
+	 * @param Combatant
+	 *	The combatant to locate.
+	 *
+	 * @return
+	 *	Either a pointer to the entry for the combatant; or, nullptr if the combatant is not in this roster.
+	 */
+	FOpenPF2PlaygroundEncounterRosterEntry* FindEntry(const AActor* Combatant);
+
+	/**
+	 * Adds a combatant to this roster, or updates it if it is already in this roster.
+	 *
+	 * The entry is only marked for replication (and the owning game state only notified) if it is new or any of its
+	 * values has changed.
+	 *
+	 * @param Combatant
+	 *	The combatant to add.
+	 * @param bIsEnemy
+	 *	Whether the combatant is an enemy of the players.
+	 * @param HitPoints
+	 *	The current hit points of the combatant.
+	 * @param Conditions
+	 *	The conditions that currently affect the combatant.
+	 */
+	void AddOrUpdateEntry(AActor*                      Combatant,
+	                      const bool                   bIsEnemy,
+	                      const float                  HitPoints,
+	                      const FGameplayTagContainer& Conditions);
+
+	/**
+	 * Removes a combatant from this roster.
+	 *
+	 * @param Combatant
+	 *	The combatant to remove.
+	 *
+	 * @return
+	 *	true if the combatant was in this roster; or, false if it was not.
+	 */
+	bool RemoveEntry(const AActor* Combatant);
+
+	/**
+	 * Removes all combatants from this roster.
+	 */
+	void ClearEntries();
+
+	/**
+	 * Counts how many enemies in this roster can still fight.
+	 *
+	 * @return
+	 *	The number of enemies in this roster that have hit points remaining.
+	 */
+	int32 CountRemainingEnemies() const;
+
+	// =================================================================================================================
+	// Public Methods - FFastArraySerializer Contract
+	// =================================================================================================================
+	void PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize) const;
+
+	void PostReplicatedChange(const TArrayView<int32>& ChangedIndices, int32 FinalSize) const;
+
+	void PreReplicatedRemove(const TArrayView<int32>& RemovedIndices, int32 FinalSize) const;
+
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters) const;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParams)
+	{
+		return FastArrayDeltaSerialize<FOpenPF2PlaygroundEncounterRosterEntry, FOpenPF2PlaygroundEncounterRoster>(
+			this->Entries,
+			DeltaParams,
+			*this
+		);
+	}
+
+protected:
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Notifies the owning game state that this roster has changed.
+	 */
+	void NotifyRosterChanged() const;
+};
+
+/**
+ * Type traits for the encounter roster, to enable delta serialization.
+ */
+template<>
+struct TStructOpsTypeTraits<FOpenPF2PlaygroundEncounterRoster> :
+	public TStructOpsTypeTraitsBase2<FOpenPF2PlaygroundEncounterRoster>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
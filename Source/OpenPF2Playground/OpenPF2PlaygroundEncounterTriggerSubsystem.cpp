@@ -0,0 +1,381 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundEncounterTriggerSubsystem.h"
+
+#include <EngineUtils.h>
+
+#include <Engine/World.h>
+
+#include <GameFramework/GameStateBase.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundCharacterBase.h"
+#include "OpenPF2PlaygroundEncounterPrewarmSubsystem.h"
+#include "OpenPF2PlaygroundEncounterTriggerVolume.h"
+#include "OpenPF2PlaygroundGameState.h"
+#include "PF2CharacterInterface.h"
+#include "PF2GameModeInterface.h"
+#include "PF2GameStateInterface.h"
+#include "PF2PlayerControllerInterface.h"
+
+void UOpenPF2PlaygroundEncounterTriggerSubsystem::Deinitialize()
+{
+	this->VolumesByCell.Empty();
+	this->CellsByVolume.Empty();
+
+	Super::Deinitialize();
+}
+
+void UOpenPF2PlaygroundEncounterTriggerSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (InWorld.GetNetMode() == NM_Client)
+	{
+		return;
+	}
+
+	for (const TSoftClassPtr<AActor>& LegacyClassPtr : this->LegacyTriggerVolumeClasses)
+	{
+		// The class is only loaded if the level places volumes of it.
+		const TSubclassOf<AActor> LegacyClass = LegacyClassPtr.Get();
+		int32                     NumVolumes  = 0;
+
+		if ((LegacyClass == nullptr) || LegacyClass->IsChildOf(AOpenPF2PlaygroundEncounterTriggerVolume::StaticClass()))
+		{
+			continue;
+		}
+
+		for (TActorIterator<AActor> VolumeIt(&InWorld, LegacyClass); VolumeIt; ++VolumeIt)
+		{
+			++NumVolumes;
+		}
+
+		if (NumVolumes != 0)
+		{
+			UE_LOG(
+				LogPf2Playground,
+				Warning,
+				TEXT(
+					"Level has %d encounter trigger volume(s) of class ('%s'), which start encounters from overlap "
+					"events. Reparent the class to AOpenPF2PlaygroundEncounterTriggerVolume so that the encounter "
+					"trigger subsystem tests them instead."
+				),
+				NumVolumes,
+				*(LegacyClass->GetPathName())
+			);
+		}
+	}
+}
+
+void UOpenPF2PlaygroundEncounterTriggerSubsystem::Tick(const float DeltaTime)
+{
+	PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundEncounterTriggers, EncounterTriggers);
+
+	const UWorld*                 World         = this->GetWorld();
+	const IPF2GameStateInterface* GameStateIntf = Cast<IPF2GameStateInterface>(World->GetGameState());
+
+	Super::Tick(DeltaTime);
+
+	if ((this->CellsByVolume.Num() == 0) || (World->GetNetMode() == NM_Client) || (GameStateIntf == nullptr))
+	{
+		return;
+	}
+
+	if (GameStateIntf->GetModeOfPlay() != EPF2ModeOfPlayType::Exploration)
+	{
+		// The request has been honored (or the game is in some other mode), so the next encounter can be triggered as
+		// soon as the game returns to Exploration mode.
+		this->bHasRequestedEncounter = false;
+		this->SecondsUntilRetrigger  = 0.0f;
+
+		return;
+	}
+
+	if (this->bIsPrewarmingEncounter)
+	{
+		// Wait for the prewarm to finish before counting down to the next request.
+		return;
+	}
+
+	if (this->bHasRequestedEncounter)
+	{
+		this->SecondsUntilRetrigger -= DeltaTime;
+
+		if (this->SecondsUntilRetrigger > 0.0f)
+		{
+			return;
+		}
+
+		// The game mode did not act on the last request, so allow another.
+		this->bHasRequestedEncounter = false;
+	}
+
+	this->SecondsUntilNextTest -= DeltaTime;
+
+	if (this->SecondsUntilNextTest <= 0.0f)
+	{
+		this->SecondsUntilNextTest = this->TestInterval;
+
+		this->TestPartyPositions();
+	}
+}
+
+TStatId UOpenPF2PlaygroundEncounterTriggerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UOpenPF2PlaygroundEncounterTriggerSubsystem, STATGROUP_Tickables);
+}
+
+void UOpenPF2PlaygroundEncounterTriggerSubsystem::RegisterVolume(AOpenPF2PlaygroundEncounterTriggerVolume* Volume)
+{
+	const FBox         Bounds  = Volume->GetTriggerBounds();
+	const FIntPoint    MinCell = this->GetCellForLocation(Bounds.Min);
+	const FIntPoint    MaxCell = this->GetCellForLocation(Bounds.Max);
+	TArray<FIntPoint>& Cells   = this->CellsByVolume.FindOrAdd(Volume);
+
+	if (Cells.Num() != 0)
+	{
+		// Already registered.
+		return;
+	}
+
+	for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			const FIntPoint Cell(CellX, CellY);
+
+			this->VolumesByCell.FindOrAdd(Cell).Add(Volume);
+			Cells.Add(Cell);
+		}
+	}
+}
+
+void UOpenPF2PlaygroundEncounterTriggerSubsystem::UnregisterVolume(AOpenPF2PlaygroundEncounterTriggerVolume* Volume)
+{
+	TArray<FIntPoint> Cells;
+
+	if (!this->CellsByVolume.RemoveAndCopyValue(Volume, Cells))
+	{
+		return;
+	}
+
+	for (const FIntPoint& Cell : Cells)
+	{
+		TArray<TWeakObjectPtr<AOpenPF2PlaygroundEncounterTriggerVolume>>* CellVolumes = this->VolumesByCell.Find(Cell);
+
+		if (CellVolumes != nullptr)
+		{
+			CellVolumes->RemoveSwap(Volume);
+
+			if (CellVolumes->Num() == 0)
+			{
+				this->VolumesByCell.Remove(Cell);
+			}
+		}
+	}
+}
+
+AOpenPF2PlaygroundEncounterTriggerVolume* UOpenPF2PlaygroundEncounterTriggerSubsystem::FindVolumeAtLocation(
+	const FVector& InLocation) const
+{
+	const TArray<TWeakObjectPtr<AOpenPF2PlaygroundEncounterTriggerVolume>>* CellVolumes =
+		this->VolumesByCell.Find(this->GetCellForLocation(InLocation));
+
+	if (CellVolumes == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (const TWeakObjectPtr<AOpenPF2PlaygroundEncounterTriggerVolume>& VolumePtr : *CellVolumes)
+	{
+		AOpenPF2PlaygroundEncounterTriggerVolume* Volume = VolumePtr.Get();
+
+		// Test against the cheap bounding box first; only test against the shape of the brush if the box contains the
+		// location.
+		if ((Volume != nullptr) &&
+		    Volume->IsTriggerEnabled() &&
+		    Volume->GetTriggerBounds().IsInsideOrOn(InLocation) &&
+		    Volume->EncompassesPoint(InLocation))
+		{
+			return Volume;
+		}
+	}
+
+	return nullptr;
+}
+
+bool UOpenPF2PlaygroundEncounterTriggerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return (WorldType == EWorldType::Game) || (WorldType == EWorldType::PIE);
+}
+
+FIntPoint UOpenPF2PlaygroundEncounterTriggerSubsystem::GetCellForLocation(const FVector& InLocation) const
+{
+	return FIntPoint(
+		FMath::FloorToInt32(InLocation.X / this->CellSize),
+		FMath::FloorToInt32(InLocation.Y / this->CellSize)
+	);
+}
+
+void UOpenPF2PlaygroundEncounterTriggerSubsystem::TestPartyPositions()
+{
+	TArray<AActor*> PartyMembers;
+
+	// Only members of a player's party trigger encounters; enemies wandering into a volume do not, so there is no
+	// need to look at any other characters in the world.
+	this->GetPartyMembers(PartyMembers);
+
+	for (AActor* PartyMember : PartyMembers)
+	{
+		AOpenPF2PlaygroundEncounterTriggerVolume* Volume = this->FindVolumeAtLocation(PartyMember->GetActorLocation());
+
+		if (Volume != nullptr)
+		{
+			// Debounce: one request per test, no matter how many party members are inside volumes.
+			this->RequestEncounter(Volume, PartyMember);
+			break;
+		}
+	}
+}
+
+void UOpenPF2PlaygroundEncounterTriggerSubsystem::GetPartyMembers(TArray<AActor*>& OutPartyMembers) const
+{
+	for (FConstPlayerControllerIterator ControllerIt = this->GetWorld()->GetPlayerControllerIterator();
+	     ControllerIt;
+	     ++ControllerIt)
+	{
+		const IPF2PlayerControllerInterface* PlayerControllerIntf =
+			Cast<IPF2PlayerControllerInterface>(ControllerIt->Get());
+
+		if (PlayerControllerIntf == nullptr)
+		{
+			continue;
+		}
+
+		for (const TScriptInterface<IPF2CharacterInterface>& Character :
+		     PlayerControllerIntf->GetControllableCharacters())
+		{
+			AActor* CharacterActor = Cast<AActor>(Character.GetObject());
+
+			if (CharacterActor != nullptr)
+			{
+				OutPartyMembers.AddUnique(CharacterActor);
+			}
+		}
+	}
+}
+
+void UOpenPF2PlaygroundEncounterTriggerSubsystem::GetEncounterCombatants(
+	const AOpenPF2PlaygroundEncounterTriggerVolume* Volume,
+	TArray<AActor*>&                                OutCombatants) const
+{
+	const FBox VolumeBounds = Volume->GetTriggerBounds();
+
+	this->GetPartyMembers(OutCombatants);
+
+	// This only runs once per encounter request, so it can afford to look at every character in the world.
+	for (TActorIterator<AOpenPF2PlaygroundCharacterBase> CharacterIt(this->GetWorld()); CharacterIt; ++CharacterIt)
+	{
+		AOpenPF2PlaygroundCharacterBase* Character = *CharacterIt;
+		const FVector                    Location  = Character->GetActorLocation();
+
+		if (VolumeBounds.IsInsideOrOn(Location) && Volume->EncompassesPoint(Location))
+		{
+			OutCombatants.AddUnique(Character);
+		}
+	}
+}
+
+void UOpenPF2PlaygroundEncounterTriggerSubsystem::RequestEncounter(AOpenPF2PlaygroundEncounterTriggerVolume* Volume,
+                                                                   AActor* TriggeringCharacter)
+{
+	UOpenPF2PlaygroundEncounterPrewarmSubsystem*       PrewarmSubsystem =
+		this->GetWorld()->GetSubsystem<UOpenPF2PlaygroundEncounterPrewarmSubsystem>();
+	FOpenPF2PlaygroundEncounterPrewarmCompleteDelegate OnPrewarmComplete;
+	TArray<AActor*>                                    Combatants;
+
+	UE_LOG(
+		LogPf2Playground,
+		Display,
+		TEXT("Character ('%s') entered encounter trigger volume ('%s')."),
+		*(TriggeringCharacter->GetName()),
+		*(Volume->GetName())
+	);
+
+	this->bHasRequestedEncounter = true;
+	this->SecondsUntilRetrigger  = this->RetriggerCooldown;
+
+	Volume->NotifyEncounterTriggered(TriggeringCharacter);
+
+	this->GetEncounterCombatants(Volume, Combatants);
+
+	this->RequestedCombatants.Reset();
+
+	for (AActor* Combatant : Combatants)
+	{
+		this->RequestedCombatants.Add(Combatant);
+	}
+
+	if (PrewarmSubsystem == nullptr)
+	{
+		this->Native_OnEncounterPrewarmed();
+		return;
+	}
+
+	this->bIsPrewarmingEncounter = true;
+
+	OnPrewarmComplete.BindDynamic(this, &UOpenPF2PlaygroundEncounterTriggerSubsystem::Native_OnEncounterPrewarmed);
+	PrewarmSubsystem->PrewarmEncounter(Combatants, OnPrewarmComplete);
+}
+
+void UOpenPF2PlaygroundEncounterTriggerSubsystem::Native_OnEncounterPrewarmed()
+{
+	const UWorld*                 World         = this->GetWorld();
+	const IPF2GameStateInterface* GameStateIntf = Cast<IPF2GameStateInterface>(World->GetGameState());
+	IPF2GameModeInterface*        GameModeIntf  = Cast<IPF2GameModeInterface>(World->GetAuthGameMode());
+	AOpenPF2PlaygroundGameState*  GameState     = Cast<AOpenPF2PlaygroundGameState>(World->GetGameState());
+	TArray<AActor*>               Combatants;
+
+	this->bIsPrewarmingEncounter = false;
+
+	for (const TWeakObjectPtr<AActor>& CombatantPtr : this->RequestedCombatants)
+	{
+		AActor* Combatant = CombatantPtr.Get();
+
+		if (Combatant != nullptr)
+		{
+			Combatants.Add(Combatant);
+		}
+	}
+
+	this->RequestedCombatants.Reset();
+
+	// The game might have changed modes some other way while the encounter was being prewarmed.
+	if ((GameStateIntf == nullptr) || (GameStateIntf->GetModeOfPlay() != EPF2ModeOfPlayType::Exploration))
+	{
+		return;
+	}
+
+	if (GameModeIntf == nullptr)
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT("Encounter trigger subsystem cannot start an encounter because the game mode is not an OpenPF2 game ")
+			TEXT("mode.")
+		);
+
+		return;
+	}
+
+	if (GameState != nullptr)
+	{
+		GameState->SetEncounterCombatants(Combatants);
+	}
+
+	GameModeIntf->RequestEncounterMode();
+}
@@ -0,0 +1,245 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Subsystems/WorldSubsystem.h>
+
+#include "OpenPF2PlaygroundEncounterTriggerSubsystem.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class AOpenPF2PlaygroundEncounterTriggerVolume;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A world subsystem that starts encounters when party members enter encounter trigger volumes.
+ *
+ * Trigger volumes are registered in a uniform spatial hash of square cells on the XY plane. At a fixed rate (and only
+ * on the server, while the game is in Exploration mode), the position of each party member is hashed to a cell and
+ * tested against only the volumes that overlap that cell. The cost of a test therefore depends on the size of the
+ * parties rather than on the number of trigger volumes in the level, and no overlap events are generated.
+ *
+ * Requests for an encounter are debounced: no matter how many party members are inside trigger volumes during a test,
+ * an encounter is requested at most once, and no further requests are made until the game has left Exploration mode
+ * (or RetriggerCooldown has elapsed without the mode of play changing).
+ *
+ * Before the game mode is asked to start an encounter, the assets that the combatants of the encounter need are
+ * prewarmed by the encounter prewarm subsystem, so that the first attacks of the encounter do not hitch, and the
+ * combatants are recorded in the encounter roster of the game state.
+ *
+ * Only AOpenPF2PlaygroundEncounterTriggerVolume actors are tested. Blueprint trigger volumes that still start
+ * encounters from overlap events (e.g., BP_EncounterModeTriggerVolume) keep working as before, but are reported when
+ * play begins if their class is listed in LegacyTriggerVolumeClasses. To move one over, reparent its Blueprint to
+ * AOpenPF2PlaygroundEncounterTriggerVolume and remove its overlap event graph (handle OnEncounterTriggered instead, if
+ * it does anything besides requesting Encounter mode).
+ */
+UCLASS(Config=Game)
+class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundEncounterTriggerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * The length of each side of a cell of the spatial hash, in centimeters.
+	 */
+	UPROPERTY(Config)
+	float CellSize;
+
+	/**
+	 * How often (in seconds) party positions are tested against trigger volumes.
+	 */
+	UPROPERTY(Config)
+	float TestInterval;
+
+	/**
+	 * How long (in seconds) to wait for the mode of play to change after requesting an encounter, before allowing
+	 * another request.
+	 */
+	UPROPERTY(Config)
+	float RetriggerCooldown;
+
+	/**
+	 * The classes of Blueprint trigger volumes that start encounters from overlap events instead of this subsystem.
+	 *
+	 * Levels that still contain volumes of these classes (that do not derive from
+	 * AOpenPF2PlaygroundEncounterTriggerVolume) are reported when play begins.
+	 */
+	UPROPERTY(Config)
+	TArray<TSoftClassPtr<AActor>> LegacyTriggerVolumeClasses;
+
+	/**
+	 * The volumes that overlap each cell of the spatial hash, keyed by cell.
+	 */
+	TMap<FIntPoint, TArray<TWeakObjectPtr<AOpenPF2PlaygroundEncounterTriggerVolume>>> VolumesByCell;
+
+	/**
+	 * The cells of the spatial hash that each registered volume overlaps, so that it can be unregistered.
+	 */
+	TMap<TWeakObjectPtr<AOpenPF2PlaygroundEncounterTriggerVolume>, TArray<FIntPoint>> CellsByVolume;
+
+	/**
+	 * The amount of time (in seconds) until party positions are next tested.
+	 */
+	float SecondsUntilNextTest;
+
+	/**
+	 * The amount of time (in seconds) remaining before another encounter can be requested; or, zero if an encounter can
+	 * be requested now.
+	 */
+	float SecondsUntilRetrigger;
+
+	/**
+	 * Whether an encounter has been requested and the game has not yet left Exploration mode.
+	 */
+	bool bHasRequestedEncounter;
+
+	/**
+	 * Whether the assets of a requested encounter are still being prewarmed.
+	 */
+	bool bIsPrewarmingEncounter;
+
+	/**
+	 * The combatants of the encounter that has been requested, recorded in the roster once the encounter is prewarmed.
+	 */
+	TArray<TWeakObjectPtr<AActor>> RequestedCombatants;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundEncounterTriggerSubsystem() :
+		CellSize(2000.0f),
+		TestInterval(0.1f),
+		RetriggerCooldown(2.0f),
+		SecondsUntilNextTest(0.0f),
+		SecondsUntilRetrigger(0.0f),
+		bHasRequestedEncounter(false),
+		bIsPrewarmingEncounter(false)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Methods - USubsystem Overrides
+	// =================================================================================================================
+	virtual void Deinitialize() override;
+
+	// =================================================================================================================
+	// Public Methods - UWorldSubsystem Overrides
+	// =================================================================================================================
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// =================================================================================================================
+	// Public Methods - FTickableGameObject Overrides
+	// =================================================================================================================
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Adds a trigger volume to the spatial hash.
+	 *
+	 * @param Volume
+	 *	The volume to add. The volume must not move while it is registered.
+	 */
+	void RegisterVolume(AOpenPF2PlaygroundEncounterTriggerVolume* Volume);
+
+	/**
+	 * Removes a trigger volume from the spatial hash.
+	 *
+	 * @param Volume
+	 *	The volume to remove.
+	 */
+	void UnregisterVolume(AOpenPF2PlaygroundEncounterTriggerVolume* Volume);
+
+	/**
+	 * Finds the first enabled trigger volume that contains the given location.
+	 *
+	 * @param InLocation
+	 *	The location to test, in world space.
+	 *
+	 * @return
+	 *	The volume that contains the location; or, nullptr if no enabled volume contains it.
+	 */
+	AOpenPF2PlaygroundEncounterTriggerVolume* FindVolumeAtLocation(const FVector& InLocation) const;
+
+protected:
+	// =================================================================================================================
+	// Protected Methods - UWorldSubsystem Overrides
+	// =================================================================================================================
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Gets the cell of the spatial hash that contains the given location.
+	 *
+	 * @param InLocation
+	 *	The location, in world space.
+	 *
+	 * @return
+	 *	The coordinate of the cell.
+	 */
+	FIntPoint GetCellForLocation(const FVector& InLocation) const;
+
+	/**
+	 * Tests the position of each party member against the trigger volumes near it, and requests an encounter if any
+	 * party member is inside an enabled volume.
+	 */
+	void TestPartyPositions();
+
+	/**
+	 * Gets the members of the parties of all players.
+	 *
+	 * @param OutPartyMembers
+	 *	The characters that are controllable by a player controller.
+	 */
+	void GetPartyMembers(TArray<AActor*>& OutPartyMembers) const;
+
+	/**
+	 * Gets the combatants of the encounter that a trigger volume would start.
+	 *
+	 * The combatants are the members of the parties of all players, plus every other character inside the volume.
+	 *
+	 * @param Volume
+	 *	The volume that is starting the encounter.
+	 * @param OutCombatants
+	 *	The combatants of the encounter.
+	 */
+	void GetEncounterCombatants(const AOpenPF2PlaygroundEncounterTriggerVolume* Volume,
+	                            TArray<AActor*>&                                OutCombatants) const;
+
+	/**
+	 * Prewarms the assets of an encounter on behalf of a trigger volume, and then asks the game mode to start it.
+	 *
+	 * @param Volume
+	 *	The volume that a party member is inside.
+	 * @param TriggeringCharacter
+	 *	The party member.
+	 */
+	void RequestEncounter(AOpenPF2PlaygroundEncounterTriggerVolume* Volume, AActor* TriggeringCharacter);
+
+	// =================================================================================================================
+	// Protected Native Event Callbacks
+	// =================================================================================================================
+	/**
+	 * Native callback invoked once the assets of a requested encounter have been prewarmed.
+	 */
+	UFUNCTION()
+	void Native_OnEncounterPrewarmed();
+};
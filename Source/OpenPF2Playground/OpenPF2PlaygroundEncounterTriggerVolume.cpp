@@ -0,0 +1,69 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundEncounterTriggerVolume.h"
+
+#include <Components/BrushComponent.h>
+
+#include <Engine/World.h>
+
+#include "OpenPF2PlaygroundEncounterTriggerSubsystem.h"
+
+AOpenPF2PlaygroundEncounterTriggerVolume::AOpenPF2PlaygroundEncounterTriggerVolume()
+{
+	UBrushComponent* Brush = this->GetBrushComponent();
+
+	// Keep query collision so that points can be tested against the shape of the brush, but never take part in
+	// overlaps. The encounter trigger subsystem tests party members against this volume instead.
+	Brush->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	Brush->SetCollisionResponseToAllChannels(ECR_Ignore);
+	Brush->SetGenerateOverlapEvents(false);
+
+	this->PrimaryActorTick.bCanEverTick = false;
+
+	this->bIsTriggerEnabled = true;
+	this->bTriggerOnce      = false;
+}
+
+void AOpenPF2PlaygroundEncounterTriggerVolume::BeginPlay()
+{
+	UOpenPF2PlaygroundEncounterTriggerSubsystem* TriggerSubsystem =
+		UWorld::GetSubsystem<UOpenPF2PlaygroundEncounterTriggerSubsystem>(this->GetWorld());
+
+	Super::BeginPlay();
+
+	if ((TriggerSubsystem != nullptr) && this->HasAuthority())
+	{
+		TriggerSubsystem->RegisterVolume(this);
+	}
+}
+
+void AOpenPF2PlaygroundEncounterTriggerVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UOpenPF2PlaygroundEncounterTriggerSubsystem* TriggerSubsystem =
+		UWorld::GetSubsystem<UOpenPF2PlaygroundEncounterTriggerSubsystem>(this->GetWorld());
+
+	if (TriggerSubsystem != nullptr)
+	{
+		TriggerSubsystem->UnregisterVolume(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+FBox AOpenPF2PlaygroundEncounterTriggerVolume::GetTriggerBounds() const
+{
+	return this->GetBrushComponent()->Bounds.GetBox();
+}
+
+void AOpenPF2PlaygroundEncounterTriggerVolume::NotifyEncounterTriggered(AActor* TriggeringCharacter)
+{
+	if (this->bTriggerOnce)
+	{
+		this->bIsTriggerEnabled = false;
+	}
+
+	this->OnEncounterTriggered.Broadcast(TriggeringCharacter);
+}
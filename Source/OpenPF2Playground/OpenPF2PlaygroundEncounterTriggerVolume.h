@@ -0,0 +1,115 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <GameFramework/Volume.h>
+
+#include "OpenPF2PlaygroundEncounterTriggerVolume.generated.h"
+
+// =====================================================================================================================
+// Delegate Types
+// =====================================================================================================================
+/**
+ * Delegate for Blueprints to react to a party entering an encounter trigger volume.
+ *
+ * @param TriggeringCharacter
+ *	The first party member found inside the volume.
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(
+	FOpenPF2PlaygroundEncounterTriggeredDelegate,
+	AActor*, TriggeringCharacter
+);
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A volume that starts an encounter when a member of a player's party is inside it.
+ *
+ * Unlike a Blueprint overlap volume, this volume does not generate overlap events. Instead, it registers itself with
+ * the encounter trigger subsystem, which tests the positions of party members against the volumes near them at a
+ * fixed rate. Volumes are assumed not to move after play begins.
+ */
+UCLASS()
+// ReSharper disable once CppClassCanBeFinal
+class OPENPF2PLAYGROUND_API AOpenPF2PlaygroundEncounterTriggerVolume : public AVolume
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * Whether this volume can start an encounter.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="OpenPF2 Playground|Encounters")
+	bool bIsTriggerEnabled;
+
+	/**
+	 * Whether this volume disables itself after starting an encounter, so that it only ever starts one encounter.
+	 *
+	 * This is off by default, so that a volume can start another encounter once the game returns to Exploration mode
+	 * (or the retrigger cooldown of the encounter trigger subsystem elapses without the mode of play changing).
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="OpenPF2 Playground|Encounters")
+	bool bTriggerOnce;
+
+	// =================================================================================================================
+	// Protected Fields - Multicast Delegates
+	// =================================================================================================================
+	/**
+	 * Event fired on the server when this volume starts an encounter.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="OpenPF2 Playground|Encounters")
+	FOpenPF2PlaygroundEncounterTriggeredDelegate OnEncounterTriggered;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit AOpenPF2PlaygroundEncounterTriggerVolume();
+
+	// =================================================================================================================
+	// Public Methods - AActor Overrides
+	// =================================================================================================================
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Determines whether this volume can start an encounter.
+	 *
+	 * @return
+	 *	true if this volume is enabled; or, false otherwise.
+	 */
+	FORCEINLINE bool IsTriggerEnabled() const
+	{
+		return this->bIsTriggerEnabled;
+	}
+
+	/**
+	 * Gets the world-space bounds of this volume.
+	 *
+	 * @return
+	 *	The axis-aligned box that contains this volume.
+	 */
+	FBox GetTriggerBounds() const;
+
+	/**
+	 * Notifies this volume that it has started an encounter.
+	 *
+	 * @param TriggeringCharacter
+	 *	The first party member found inside this volume.
+	 */
+	void NotifyEncounterTriggered(AActor* TriggeringCharacter);
+};
@@ -0,0 +1,54 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Engine/DataAsset.h>
+
+#include "OpenPF2PlaygroundEquipmentItem.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class UGameplayEffect;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A data asset that describes an item that can be equipped into a slot of an equipped inventory component.
+ */
+UCLASS(BlueprintType)
+class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundEquipmentItem : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * The type of this item (e.g., one of the "DA_ItemType_*" data assets).
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="OpenPF2 Playground|Inventory")
+	UDataAsset* ItemType;
+
+	/**
+	 * The gameplay effects that are applied to the character that has this item equipped, for as long as it is
+	 * equipped.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="OpenPF2 Playground|Inventory")
+	TArray<TSubclassOf<UGameplayEffect>> GrantedEffects;
+
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundEquipmentItem() : ItemType(nullptr)
+	{
+	}
+};
@@ -0,0 +1,248 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundEquippedInventoryComponent.h"
+
+#include <AbilitySystemComponent.h>
+#include <AbilitySystemGlobals.h>
+#include <GameplayEffect.h>
+
+#include <Engine/DataAsset.h>
+
+#include <Net/UnrealNetwork.h>
+
+#include <Net/Core/PushModel/PushModel.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundEquipmentItem.h"
+
+UOpenPF2PlaygroundEquippedInventoryComponent::UOpenPF2PlaygroundEquippedInventoryComponent()
+{
+	this->PrimaryComponentTick.bCanEverTick = false;
+	this->bWantsInitializeComponent         = true;
+
+	this->SetIsReplicatedByDefault(true);
+
+	this->EquippedItems.OwningComponent = this;
+	this->bGrantedEffectsDirty          = true;
+}
+
+void UOpenPF2PlaygroundEquippedInventoryComponent::InitializeComponent()
+{
+	const int32 NumSlots = FMath::Min(this->Slots.Num(), static_cast<int32>(MAX_uint8) + 1);
+
+	Super::InitializeComponent();
+
+	if (NumSlots < this->Slots.Num())
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT("[%s] Equipped inventory has %d slots, but only the first %d can be used."),
+			*GetNameSafe(this->GetOwner()),
+			this->Slots.Num(),
+			NumSlots
+		);
+	}
+
+	this->SlotIndices.Reset();
+	this->SlotIndices.Reserve(NumSlots);
+
+	for (int32 SlotIndex = 0; SlotIndex < NumSlots; ++SlotIndex)
+	{
+		const UDataAsset* Slot = this->Slots[SlotIndex];
+
+		if (Slot != nullptr)
+		{
+			this->SlotIndices.Add(Slot, SlotIndex);
+		}
+	}
+
+	this->ItemsBySlot.Init(nullptr, NumSlots);
+	this->AppliedEffectsBySlot.SetNum(NumSlots);
+
+	if (this->GetOwnerRole() == ROLE_Authority)
+	{
+		this->EquippedItems.InitializeSlots(NumSlots);
+
+		MARK_PROPERTY_DIRTY_FROM_NAME(UOpenPF2PlaygroundEquippedInventoryComponent, EquippedItems, this);
+	}
+}
+
+void UOpenPF2PlaygroundEquippedInventoryComponent::GetLifetimeReplicatedProps(
+	TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	FDoRepLifetimeParams PushModelParams;
+
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	PushModelParams.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(UOpenPF2PlaygroundEquippedInventoryComponent, EquippedItems, PushModelParams);
+}
+
+int32 UOpenPF2PlaygroundEquippedInventoryComponent::GetSlotIndex(const UDataAsset* Slot) const
+{
+	const int32* SlotIndex = this->SlotIndices.Find(Slot);
+
+	return (SlotIndex == nullptr) ? INDEX_NONE : *SlotIndex;
+}
+
+UOpenPF2PlaygroundEquipmentItem* UOpenPF2PlaygroundEquippedInventoryComponent::GetEquippedItem(
+	const UDataAsset* Slot) const
+{
+	return this->GetEquippedItemAtIndex(this->GetSlotIndex(Slot));
+}
+
+bool UOpenPF2PlaygroundEquippedInventoryComponent::EquipItem(const UDataAsset*                Slot,
+                                                             UOpenPF2PlaygroundEquipmentItem* Item)
+{
+	const int32 SlotIndex = this->GetSlotIndex(Slot);
+
+	if (SlotIndex == INDEX_NONE)
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Warning,
+			TEXT("[%s] Slot ('%s') is not one of the slots of this equipped inventory."),
+			*GetNameSafe(this->GetOwner()),
+			*GetNameSafe(Slot)
+		);
+
+		return false;
+	}
+
+	return this->EquipItemAtIndex(SlotIndex, Item);
+}
+
+bool UOpenPF2PlaygroundEquippedInventoryComponent::EquipItemAtIndex(const int32                      SlotIndex,
+                                                                    UOpenPF2PlaygroundEquipmentItem* Item)
+{
+	check(this->GetOwnerRole() == ROLE_Authority);
+
+	if (!this->ItemsBySlot.IsValidIndex(SlotIndex) || (this->ItemsBySlot[SlotIndex] == Item))
+	{
+		return false;
+	}
+
+	this->RemoveGrantedEffects(SlotIndex);
+
+	this->EquippedItems.SetItem(SlotIndex, Item);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UOpenPF2PlaygroundEquippedInventoryComponent, EquippedItems, this);
+
+	if (Item != nullptr)
+	{
+		this->ApplyGrantedEffects(SlotIndex, Item);
+	}
+
+	this->NotifyEquippedItemChanged(SlotIndex, Item);
+
+	return true;
+}
+
+bool UOpenPF2PlaygroundEquippedInventoryComponent::UnequipItem(const UDataAsset* Slot)
+{
+	const int32 SlotIndex = this->GetSlotIndex(Slot);
+
+	return (SlotIndex != INDEX_NONE) && this->EquipItemAtIndex(SlotIndex, nullptr);
+}
+
+void UOpenPF2PlaygroundEquippedInventoryComponent::UnequipAllItems()
+{
+	for (int32 SlotIndex = 0; SlotIndex < this->ItemsBySlot.Num(); ++SlotIndex)
+	{
+		this->EquipItemAtIndex(SlotIndex, nullptr);
+	}
+}
+
+const TArray<TSubclassOf<UGameplayEffect>>& UOpenPF2PlaygroundEquippedInventoryComponent::GetGrantedEffects() const
+{
+	if (this->bGrantedEffectsDirty)
+	{
+		this->CachedGrantedEffects.Reset();
+
+		for (const UOpenPF2PlaygroundEquipmentItem* Item : this->ItemsBySlot)
+		{
+			if (Item != nullptr)
+			{
+				this->CachedGrantedEffects.Append(Item->GrantedEffects);
+			}
+		}
+
+		this->bGrantedEffectsDirty = false;
+	}
+
+	return this->CachedGrantedEffects;
+}
+
+void UOpenPF2PlaygroundEquippedInventoryComponent::ApplyGrantedEffects(const int32                            SlotIndex,
+                                                                       const UOpenPF2PlaygroundEquipmentItem* Item)
+{
+	UAbilitySystemComponent*             Asc         =
+		UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(this->GetOwner());
+	TArray<FActiveGameplayEffectHandle>& SlotHandles = this->AppliedEffectsBySlot[SlotIndex].Handles;
+
+	if ((Asc == nullptr) || (Item->GrantedEffects.Num() == 0))
+	{
+		return;
+	}
+
+	for (const TSubclassOf<UGameplayEffect>& EffectClass : Item->GrantedEffects)
+	{
+		FActiveGameplayEffectHandle Handle;
+
+		if (EffectClass == nullptr)
+		{
+			continue;
+		}
+
+		Handle = Asc->ApplyGameplayEffectToSelf(
+			EffectClass->GetDefaultObject<UGameplayEffect>(),
+			1.0f,
+			Asc->MakeEffectContext()
+		);
+
+		if (Handle.IsValid())
+		{
+			SlotHandles.Add(Handle);
+		}
+	}
+}
+
+void UOpenPF2PlaygroundEquippedInventoryComponent::RemoveGrantedEffects(const int32 SlotIndex)
+{
+	UAbilitySystemComponent*             Asc         =
+		UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(this->GetOwner());
+	TArray<FActiveGameplayEffectHandle>& SlotHandles = this->AppliedEffectsBySlot[SlotIndex].Handles;
+
+	if (Asc != nullptr)
+	{
+		for (const FActiveGameplayEffectHandle& Handle : SlotHandles)
+		{
+			Asc->RemoveActiveGameplayEffect(Handle);
+		}
+	}
+
+	SlotHandles.Reset();
+}
+
+void UOpenPF2PlaygroundEquippedInventoryComponent::NotifyEquippedItemChanged(const int32                      SlotIndex,
+                                                                             UOpenPF2PlaygroundEquipmentItem* Item)
+{
+	this->ItemsBySlot[SlotIndex] = Item;
+	this->bGrantedEffectsDirty   = true;
+
+	this->OnEquippedItemChanged.Broadcast(this->Slots[SlotIndex], Item);
+}
+
+void UOpenPF2PlaygroundEquippedInventoryComponent::Native_OnEquippedItemReplicated(
+	const int32                      SlotIndex,
+	UOpenPF2PlaygroundEquipmentItem* Item)
+{
+	if (this->ItemsBySlot.IsValidIndex(SlotIndex) && (this->ItemsBySlot[SlotIndex] != Item))
+	{
+		this->NotifyEquippedItemChanged(SlotIndex, Item);
+	}
+}
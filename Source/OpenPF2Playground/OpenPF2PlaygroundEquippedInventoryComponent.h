@@ -0,0 +1,293 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <ActiveGameplayEffectHandle.h>
+
+#include <Components/ActorComponent.h>
+
+#include "OpenPF2PlaygroundEquippedItems.h"
+
+#include "OpenPF2PlaygroundEquippedInventoryComponent.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class UDataAsset;
+class UGameplayEffect;
+class UOpenPF2PlaygroundEquipmentItem;
+
+// =====================================================================================================================
+// Delegate Types
+// =====================================================================================================================
+/**
+ * Delegate for Blueprints to react to an item being equipped into or removed from a slot.
+ *
+ * @param Slot
+ *	The slot whose contents have changed.
+ * @param Item
+ *	The item now equipped in the slot; or, nullptr if the slot is now empty.
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(
+	FOpenPF2PlaygroundEquippedItemChangedDelegate,
+	UDataAsset*,                      Slot,
+	UOpenPF2PlaygroundEquipmentItem*, Item
+);
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * The gameplay effects that have been applied on behalf of the item in a single slot.
+ */
+struct FOpenPF2PlaygroundEquippedSlotEffects
+{
+	/**
+	 * The handles of the active effects granted by the item in the slot.
+	 */
+	TArray<FActiveGameplayEffectHandle> Handles;
+};
+
+/**
+ * A component that tracks the items that a character has equipped, by slot.
+ *
+ * The slots of the component (e.g., the "DA_ItemSlot_*" data assets) are configured on the component in the character
+ * Blueprint, and the index of each slot is resolved once when the component is initialized. Equipping or unequipping
+ * an item is constant-time: it changes only the entry for that slot, and only that entry is replicated to clients.
+ *
+ * On the server, the gameplay effects granted by each item are applied to the character when the item is equipped and
+ * removed when it is unequipped. The combined list of effects granted by all equipped items is cached, and only
+ * rebuilt after the contents of a slot change.
+ */
+UCLASS(ClassGroup="OpenPF2-Characters", meta=(BlueprintSpawnableComponent))
+// ReSharper disable once CppClassCanBeFinal
+class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundEquippedInventoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+	friend struct FOpenPF2PlaygroundEquippedItems;
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * The slots into which items can be equipped. The position of each slot in this list is its slot index.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="OpenPF2 Playground|Inventory")
+	TArray<UDataAsset*> Slots;
+
+	/**
+	 * The index of each slot, keyed by slot, resolved once when this component is initialized.
+	 */
+	TMap<const UDataAsset*, int32> SlotIndices;
+
+	/**
+	 * The item equipped in each slot, indexed by slot index. This mirrors the replicated items on every machine.
+	 */
+	UPROPERTY(Transient)
+	TArray<UOpenPF2PlaygroundEquipmentItem*> ItemsBySlot;
+
+	/**
+	 * The contents of each slot, replicated to clients as deltas.
+	 */
+	UPROPERTY(Replicated)
+	FOpenPF2PlaygroundEquippedItems EquippedItems;
+
+	/**
+	 * The effects applied on behalf of the item in each slot, indexed by slot index. This is only tracked on the server.
+	 */
+	TArray<FOpenPF2PlaygroundEquippedSlotEffects> AppliedEffectsBySlot;
+
+	/**
+	 * The combined gameplay effects granted by all equipped items, as of the last time that it was rebuilt.
+	 */
+	mutable TArray<TSubclassOf<UGameplayEffect>> CachedGrantedEffects;
+
+	/**
+	 * Whether the contents of a slot have changed since the combined gameplay effects were last rebuilt.
+	 */
+	mutable bool bGrantedEffectsDirty;
+
+	// =================================================================================================================
+	// Protected Fields - Multicast Delegates
+	// =================================================================================================================
+	/**
+	 * Event fired when an item is equipped into or removed from a slot.
+	 *
+	 * On clients, this fires as the change to the slot replicates.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="OpenPF2 Playground|Inventory")
+	FOpenPF2PlaygroundEquippedItemChangedDelegate OnEquippedItemChanged;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundEquippedInventoryComponent();
+
+	// =================================================================================================================
+	// Public Methods - UActorComponent Overrides
+	// =================================================================================================================
+	virtual void InitializeComponent() override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Gets the index of a slot.
+	 *
+	 * @param Slot
+	 *	The slot to look up.
+	 *
+	 * @return
+	 *	The index of the slot; or, INDEX_NONE if the slot is not one of the slots of this component.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Inventory")
+	int32 GetSlotIndex(const UDataAsset* Slot) const;
+
+	/**
+	 * Gets the item equipped in a slot.
+	 *
+	 * @param Slot
+	 *	The slot to look up.
+	 *
+	 * @return
+	 *	The item in the slot; or, nullptr if the slot is empty or is not one of the slots of this component.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Inventory")
+	UOpenPF2PlaygroundEquipmentItem* GetEquippedItem(const UDataAsset* Slot) const;
+
+	/**
+	 * Gets the item equipped in the slot at the given index.
+	 *
+	 * @param SlotIndex
+	 *	The index of the slot.
+	 *
+	 * @return
+	 *	The item in the slot; or, nullptr if the slot is empty or the index is not valid.
+	 */
+	FORCEINLINE UOpenPF2PlaygroundEquipmentItem* GetEquippedItemAtIndex(const int32 SlotIndex) const
+	{
+		return this->ItemsBySlot.IsValidIndex(SlotIndex) ? this->ItemsBySlot[SlotIndex] : nullptr;
+	}
+
+	/**
+	 * Equips an item into a slot, replacing any item that is already in the slot.
+	 *
+	 * This can only be called on the server.
+	 *
+	 * @param Slot
+	 *	The slot into which the item is to be equipped.
+	 * @param Item
+	 *	The item to equip; or, nullptr to empty the slot.
+	 *
+	 * @return
+	 *	true if the contents of the slot changed; or, false if the slot is not one of the slots of this component or
+	 *	the item was already equipped in the slot.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="OpenPF2 Playground|Inventory")
+	bool EquipItem(const UDataAsset* Slot, UOpenPF2PlaygroundEquipmentItem* Item);
+
+	/**
+	 * Equips an item into the slot at the given index, replacing any item that is already in the slot.
+	 *
+	 * This can only be called on the server.
+	 *
+	 * @param SlotIndex
+	 *	The index of the slot into which the item is to be equipped.
+	 * @param Item
+	 *	The item to equip; or, nullptr to empty the slot.
+	 *
+	 * @return
+	 *	true if the contents of the slot changed; or, false if the index is not valid or the item was already equipped
+	 *	in the slot.
+	 */
+	bool EquipItemAtIndex(const int32 SlotIndex, UOpenPF2PlaygroundEquipmentItem* Item);
+
+	/**
+	 * Removes the item from a slot.
+	 *
+	 * This can only be called on the server.
+	 *
+	 * @param Slot
+	 *	The slot to empty.
+	 *
+	 * @return
+	 *	true if an item was removed; or, false if the slot was already empty or is not one of the slots of this
+	 *	component.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="OpenPF2 Playground|Inventory")
+	bool UnequipItem(const UDataAsset* Slot);
+
+	/**
+	 * Removes the items from all slots.
+	 *
+	 * This can only be called on the server.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="OpenPF2 Playground|Inventory")
+	void UnequipAllItems();
+
+	/**
+	 * Gets the gameplay effects granted by all equipped items.
+	 *
+	 * The result is cached, and is only rebuilt after the contents of a slot have changed.
+	 *
+	 * @return
+	 *	The gameplay effects granted by each equipped item, in slot order.
+	 */
+	const TArray<TSubclassOf<UGameplayEffect>>& GetGrantedEffects() const;
+
+protected:
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Applies the gameplay effects granted by an item to the owning character, on behalf of a slot.
+	 *
+	 * @param SlotIndex
+	 *	The index of the slot in which the item is equipped.
+	 * @param Item
+	 *	The item whose effects are to be applied.
+	 */
+	void ApplyGrantedEffects(const int32 SlotIndex, const UOpenPF2PlaygroundEquipmentItem* Item);
+
+	/**
+	 * Removes the gameplay effects that were applied to the owning character on behalf of a slot.
+	 *
+	 * @param SlotIndex
+	 *	The index of the slot.
+	 */
+	void RemoveGrantedEffects(const int32 SlotIndex);
+
+	/**
+	 * Records the new contents of a slot and notifies listeners.
+	 *
+	 * @param SlotIndex
+	 *	The index of the slot.
+	 * @param Item
+	 *	The item now equipped in the slot; or, nullptr if the slot is now empty.
+	 */
+	void NotifyEquippedItemChanged(const int32 SlotIndex, UOpenPF2PlaygroundEquipmentItem* Item);
+
+	// =================================================================================================================
+	// Protected Native Event Callbacks
+	// =================================================================================================================
+	/**
+	 * Native callback invoked on clients when the contents of a slot have replicated.
+	 *
+	 * @param SlotIndex
+	 *	The index of the slot.
+	 * @param Item
+	 *	The item now equipped in the slot; or, nullptr if the slot is now empty.
+	 */
+	void Native_OnEquippedItemReplicated(const int32 SlotIndex, UOpenPF2PlaygroundEquipmentItem* Item);
+};
@@ -0,0 +1,67 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundEquippedItems.h"
+
+#include "OpenPF2PlaygroundEquippedInventoryComponent.h"
+
+void FOpenPF2PlaygroundEquippedItems::InitializeSlots(const int32 NumSlots)
+{
+	this->Entries.Reset(NumSlots);
+
+	for (int32 SlotIndex = 0; SlotIndex < NumSlots; ++SlotIndex)
+	{
+		FOpenPF2PlaygroundEquippedItemEntry& Entry = this->Entries.AddDefaulted_GetRef();
+
+		Entry.SlotIndex = static_cast<uint8>(SlotIndex);
+
+		this->MarkItemDirty(Entry);
+	}
+
+	this->MarkArrayDirty();
+}
+
+void FOpenPF2PlaygroundEquippedItems::SetItem(const int32 SlotIndex, UOpenPF2PlaygroundEquipmentItem* Item)
+{
+	FOpenPF2PlaygroundEquippedItemEntry& Entry = this->Entries[SlotIndex];
+
+	Entry.Item = Item;
+
+	this->MarkItemDirty(Entry);
+}
+
+void FOpenPF2PlaygroundEquippedItems::PostReplicatedAdd(const TArrayView<int32>& AddedIndices,
+                                                        int32                    FinalSize) const
+{
+	this->NotifyEntriesReplicated(AddedIndices, false);
+}
+
+void FOpenPF2PlaygroundEquippedItems::PostReplicatedChange(const TArrayView<int32>& ChangedIndices,
+                                                           int32                    FinalSize) const
+{
+	this->NotifyEntriesReplicated(ChangedIndices, false);
+}
+
+void FOpenPF2PlaygroundEquippedItems::PreReplicatedRemove(const TArrayView<int32>& RemovedIndices,
+                                                          int32                    FinalSize) const
+{
+	this->NotifyEntriesReplicated(RemovedIndices, true);
+}
+
+void FOpenPF2PlaygroundEquippedItems::NotifyEntriesReplicated(const TArrayView<int32>& Indices,
+                                                              const bool               bRemoved) const
+{
+	if (this->OwningComponent == nullptr)
+	{
+		return;
+	}
+
+	for (const int32 Index : Indices)
+	{
+		const FOpenPF2PlaygroundEquippedItemEntry& Entry = this->Entries[Index];
+
+		this->OwningComponent->Native_OnEquippedItemReplicated(Entry.SlotIndex, bRemoved ? nullptr : Entry.Item);
+	}
+}
@@ -0,0 +1,160 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Net/Serialization/FastArraySerializer.h>
+
+#include "OpenPF2PlaygroundEquippedItems.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class UOpenPF2PlaygroundEquipmentItem;
+class UOpenPF2PlaygroundEquippedInventoryComponent;
+struct FOpenPF2PlaygroundEquippedItems;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * The contents of a single slot of an equipped inventory.
+ */
+USTRUCT(BlueprintType)
+struct FOpenPF2PlaygroundEquippedItemEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * The index of the slot that this entry describes, in the slots of the owning equipped inventory component.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="OpenPF2 Playground|Inventory")
+	uint8 SlotIndex;
+
+	/**
+	 * The item that is equipped in the slot; or, nullptr if the slot is empty.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="OpenPF2 Playground|Inventory")
+	UOpenPF2PlaygroundEquipmentItem* Item;
+
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor for FOpenPF2PlaygroundEquippedItemEntry.
+	 */
+	explicit FOpenPF2PlaygroundEquippedItemEntry() :
+		SlotIndex(0),
+		Item(nullptr)
+	{
+	}
+};
+
+/**
+ * The contents of every slot of an equipped inventory, replicated to clients as deltas.
+ *
+ * There is exactly one entry per slot, created when the slots are initialized, and entries are never added or removed
+ * afterward. On the server, the entry for each slot is at the index of the slot, so equipping or unequipping an item
+ * only touches (and only replicates) the entry of that slot.
+ */
+USTRUCT(BlueprintType)
+struct FOpenPF2PlaygroundEquippedItems : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * The contents of each slot.
+	 */
+	UPROPERTY()
+	TArray<FOpenPF2PlaygroundEquippedItemEntry> Entries;
+
+	/**
+	 * The component that owns these items; notified whenever the contents of a slot change.
+	 */
+	UPROPERTY(NotReplicated)
+	UOpenPF2PlaygroundEquippedInventoryComponent* OwningComponent;
+
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor for FOpenPF2PlaygroundEquippedItems.
+	 */
+	explicit FOpenPF2PlaygroundEquippedItems() : OwningComponent(nullptr)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Creates an empty entry for each slot, replacing any existing entries.
+	 *
+	 * @param NumSlots
+	 *	The number of slots.
+	 */
+	void InitializeSlots(const int32 NumSlots);
+
+	/**
+	 * Changes the item that is equipped in a slot.
+	 *
+	 * @param SlotIndex
+	 *	The index of the slot. This must be a valid slot index.
+	 * @param Item
+	 *	The item to equip; or, nullptr to empty the slot.
+	 */
+	void SetItem(const int32 SlotIndex, UOpenPF2PlaygroundEquipmentItem* Item);
+
+	// =================================================================================================================
+	// Public Methods - FFastArraySerializer Contract
+	// =================================================================================================================
+	void PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize) const;
+
+	void PostReplicatedChange(const TArrayView<int32>& ChangedIndices, int32 FinalSize) const;
+
+	void PreReplicatedRemove(const TArrayView<int32>& RemovedIndices, int32 FinalSize) const;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParams)
+	{
+		return FastArrayDeltaSerialize<FOpenPF2PlaygroundEquippedItemEntry, FOpenPF2PlaygroundEquippedItems>(
+			this->Entries,
+			DeltaParams,
+			*this
+		);
+	}
+
+protected:
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Notifies the owning component that the contents of the given entries have replicated.
+	 *
+	 * @param Indices
+	 *	The indices of the entries that have changed.
+	 * @param bRemoved
+	 *	Whether the entries are being removed (in which case their slots are now empty).
+	 */
+	void NotifyEntriesReplicated(const TArrayView<int32>& Indices, const bool bRemoved) const;
+};
+
+/**
+ * Type traits for equipped items, to enable delta serialization.
+ */
+template<>
+struct TStructOpsTypeTraits<FOpenPF2PlaygroundEquippedItems> :
+	public TStructOpsTypeTraitsBase2<FOpenPF2PlaygroundEquippedItems>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
@@ -0,0 +1,485 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundEventLog.h"
+
+#include <atomic>
+
+#include <HAL/IConsoleManager.h>
+
+#include <Misc/CoreDelegates.h>
+#include <Misc/DelayedAutoRegister.h>
+#include <Misc/OutputDeviceRedirector.h>
+
+#include <UObject/NameTypes.h>
+
+#include <GameFramework/Actor.h>
+
+namespace OpenPF2PlaygroundEventLog
+{
+	// =================================================================================================================
+	// Private Declarations
+	// =================================================================================================================
+	/**
+	 * A single event, as recorded. Nothing in a record needs to be formatted until the log is dumped.
+	 */
+	struct FEventRecord
+	{
+		/**
+		 * The value of the CPU cycle counter when the event was recorded.
+		 */
+		uint64 Cycles;
+
+		/**
+		 * The number of the frame during which the event was recorded.
+		 */
+		uint64 FrameNumber;
+
+		/**
+		 * The name of the actor that the event is about.
+		 */
+		FName SubjectName;
+
+		/**
+		 * The floating-point argument of the event.
+		 */
+		float Value;
+
+		/**
+		 * The integer arguments of the event.
+		 */
+		int32 Args[2];
+
+		/**
+		 * The PIE instance of the world of the actor, to tell apart the server and clients of a PIE session.
+		 */
+		int32 PieInstance;
+
+		/**
+		 * The type of event.
+		 */
+		EOpenPF2PlaygroundEvent Event;
+
+		/**
+		 * The network mode of the world of the actor.
+		 */
+		uint8 NetMode;
+	};
+
+	/**
+	 * A fixed-size ring of the most recent events recorded by a single thread.
+	 *
+	 * Only the owning thread writes to a buffer, so recording does not need a lock. A dump that runs while the owning
+	 * thread is recording can see a record that is only partially written; this is acceptable for diagnostics.
+	 */
+	struct FEventRingBuffer
+	{
+		/**
+		 * The number of records kept per thread. Must be a power of two.
+		 */
+		static constexpr uint32 Capacity = 4096;
+
+		/**
+		 * The ID of the thread that owns this buffer.
+		 */
+		uint32 ThreadId;
+
+		/**
+		 * The total number of records ever written to this buffer.
+		 */
+		std::atomic<uint32> NumWritten;
+
+		/**
+		 * Storage for the most recent records.
+		 */
+		FEventRecord Records[Capacity];
+
+		/**
+		 * Constructor for FEventRingBuffer.
+		 *
+		 * @param ThreadId
+		 *	The ID of the thread that owns this buffer.
+		 */
+		explicit FEventRingBuffer(const uint32 ThreadId) : ThreadId(ThreadId), NumWritten(0)
+		{
+		}
+	};
+
+	static_assert(FMath::IsPowerOfTwo(FEventRingBuffer::Capacity), "Capacity must be a power of two.");
+
+	/**
+	 * The maximum number of threads whose ring buffers are kept for dumps.
+	 */
+	static constexpr int32 MaxThreadBuffers = 256;
+
+	/**
+	 * The maximum length of a single formatted line of the log, including the null terminator.
+	 */
+	static constexpr int32 MaxLineLength = NAME_SIZE + 256;
+
+	/**
+	 * Gets the ring buffer of the calling thread, creating and registering it on first use.
+	 *
+	 * @return
+	 *	The ring buffer of the calling thread.
+	 */
+	static FEventRingBuffer& GetThreadBuffer();
+
+	/**
+	 * Formats a single record for output, without allocating memory.
+	 *
+	 * @param ThreadId
+	 *	The ID of the thread that recorded the event.
+	 * @param Record
+	 *	The record to format.
+	 * @param OutLine
+	 *	The buffer that receives a human-readable description of the record.
+	 * @param OutLineLength
+	 *	The size of the output buffer, in characters.
+	 */
+	static void FormatRecord(const uint32        ThreadId,
+	                         const FEventRecord& Record,
+	                         TCHAR*              OutLine,
+	                         const int32         OutLineLength);
+
+	/**
+	 * Dumps the event log when the process crashes.
+	 *
+	 * Since the process might have crashed while holding a lock or inside the memory allocator, this neither takes a
+	 * lock nor allocates memory. It formats each record into a buffer reserved up front, merges the ring buffers of all
+	 * threads in place, and writes each line straight to the low-level debug output.
+	 */
+	static void DumpOnSystemError();
+
+	// =================================================================================================================
+	// Private State
+	// =================================================================================================================
+	bool GIsEnabled = false;
+
+	static FAutoConsoleVariableRef CVarEventLogEnabled(
+		TEXT("Pf2Playground.EventLog.Enabled"),
+		GIsEnabled,
+		TEXT("Whether to record input and ability events in the playground event log (dump with ")
+		TEXT("Pf2Playground.EventLog.Dump).")
+	);
+
+	static FAutoConsoleCommandWithOutputDevice CmdEventLogDump(
+		TEXT("Pf2Playground.EventLog.Dump"),
+		TEXT("Writes every event still in the playground event log to the output log."),
+		FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&Dump)
+	);
+
+	static FDelayedAutoRegisterHelper CrashHookRegistration(
+		EDelayedRegisterRunPhase::EndOfEngineInit,
+		[]
+		{
+			FCoreDelegates::OnHandleSystemError.AddStatic(&DumpOnSystemError);
+		}
+	);
+
+	/**
+	 * Guards registration of new ring buffers. Only taken when a thread records its first event.
+	 */
+	static FCriticalSection ThreadBuffersLock;
+
+	/**
+	 * The ring buffers of all threads that have recorded events.
+	 *
+	 * Buffers are never freed, so that events recorded by threads that have since exited are still available to dumps.
+	 * This is a fixed-size array rather than a TArray so that a crash dump can read it without a lock while another
+	 * thread is registering a buffer.
+	 */
+	static FEventRingBuffer* ThreadBuffers[MaxThreadBuffers];
+
+	/**
+	 * The number of entries of ThreadBuffers that have been published to dumps.
+	 */
+	static std::atomic<int32> NumThreadBuffers(0);
+
+	/**
+	 * The position of the next record to dump from each ring buffer, reserved up front for crash dumps.
+	 */
+	static uint32 CrashDumpCursors[MaxThreadBuffers];
+
+	/**
+	 * The number of records written to each ring buffer when a crash dump started, reserved up front for crash dumps.
+	 */
+	static uint32 CrashDumpEnds[MaxThreadBuffers];
+
+	/**
+	 * The buffer into which each line of a crash dump is formatted, reserved up front for crash dumps.
+	 */
+	static TCHAR CrashDumpLine[MaxLineLength];
+
+	/**
+	 * Whether the event log has already been dumped because of a crash.
+	 */
+	static std::atomic<bool> bHasDumpedOnSystemError(false);
+
+	// =================================================================================================================
+	// Public Functions
+	// =================================================================================================================
+	void RecordUnchecked(const EOpenPF2PlaygroundEvent Event,
+	                     const AActor*                 Subject,
+	                     const int32                   Arg0,
+	                     const int32                   Arg1,
+	                     const float                   Value)
+	{
+		FEventRingBuffer& Buffer = GetThreadBuffer();
+		const uint32      Index  = Buffer.NumWritten.load(std::memory_order_relaxed);
+		FEventRecord&     Record = Buffer.Records[Index & (FEventRingBuffer::Capacity - 1)];
+
+		Record.Cycles      = FPlatformTime::Cycles64();
+		Record.FrameNumber = GFrameCounter;
+		Record.SubjectName = (Subject != nullptr) ? Subject->GetFName() : NAME_None;
+		Record.Value       = Value;
+		Record.Args[0]     = Arg0;
+		Record.Args[1]     = Arg1;
+		Record.PieInstance = UE::GetPlayInEditorID();
+		Record.Event       = Event;
+		Record.NetMode     = (Subject != nullptr) ? static_cast<uint8>(Subject->GetNetMode()) : NM_Standalone;
+
+		// Publish the record to dumps only once it has been written.
+		Buffer.NumWritten.store(Index + 1, std::memory_order_release);
+	}
+
+	void Dump(FOutputDevice& OutputDevice)
+	{
+		const int32                         NumBuffers = NumThreadBuffers.load(std::memory_order_acquire);
+		TArray<TPair<uint32, FEventRecord>> Records;
+		TCHAR                               Line[MaxLineLength];
+
+		for (int32 BufferIndex = 0; BufferIndex < NumBuffers; ++BufferIndex)
+		{
+			const FEventRingBuffer* Buffer     = ThreadBuffers[BufferIndex];
+			const uint32            NumWritten = Buffer->NumWritten.load(std::memory_order_acquire);
+			const uint32            NumKept    = FMath::Min(NumWritten, FEventRingBuffer::Capacity);
+
+			for (uint32 Index = NumWritten - NumKept; Index != NumWritten; ++Index)
+			{
+				Records.Emplace(Buffer->ThreadId, Buffer->Records[Index & (FEventRingBuffer::Capacity - 1)]);
+			}
+		}
+
+		Records.Sort(
+			[](const TPair<uint32, FEventRecord>& Left, const TPair<uint32, FEventRecord>& Right)
+			{
+				return Left.Value.Cycles < Right.Value.Cycles;
+			}
+		);
+
+		OutputDevice.Logf(TEXT("Playground event log (%d event(s)):"), Records.Num());
+
+		for (const TPair<uint32, FEventRecord>& Record : Records)
+		{
+			FormatRecord(Record.Key, Record.Value, Line, UE_ARRAY_COUNT(Line));
+
+			OutputDevice.Log(Line);
+		}
+	}
+
+	// =================================================================================================================
+	// Private Functions
+	// =================================================================================================================
+	static FEventRingBuffer& GetThreadBuffer()
+	{
+		static thread_local FEventRingBuffer* Buffer = nullptr;
+
+		if (Buffer == nullptr)
+		{
+			FScopeLock  Lock(&ThreadBuffersLock);
+			const int32 BufferIndex = NumThreadBuffers.load(std::memory_order_relaxed);
+
+			Buffer = new FEventRingBuffer(FPlatformTLS::GetCurrentThreadId());
+
+			// Once every slot is taken, the events of any further threads are recorded but are not dumped.
+			if (BufferIndex < MaxThreadBuffers)
+			{
+				ThreadBuffers[BufferIndex] = Buffer;
+
+				// Publish the buffer to dumps only once its slot has been written.
+				NumThreadBuffers.store(BufferIndex + 1, std::memory_order_release);
+			}
+		}
+
+		return *Buffer;
+	}
+
+	static void FormatRecord(const uint32        ThreadId,
+	                         const FEventRecord& Record,
+	                         TCHAR*              OutLine,
+	                         const int32         OutLineLength)
+	{
+		const TCHAR* HostFormat;
+		TCHAR        HostId[32];
+		TCHAR        SubjectName[NAME_SIZE];
+		TCHAR        Message[MaxLineLength];
+
+		switch (static_cast<ENetMode>(Record.NetMode))
+		{
+			case NM_DedicatedServer:
+			case NM_ListenServer:
+				HostFormat = TEXT("Server");
+				break;
+
+			case NM_Client:
+				HostFormat = TEXT("Client %d");
+				break;
+
+			default:
+				HostFormat = TEXT("Standalone");
+				break;
+		}
+
+		FCString::Snprintf(HostId, UE_ARRAY_COUNT(HostId), HostFormat, Record.PieInstance);
+		Record.SubjectName.ToString(SubjectName, UE_ARRAY_COUNT(SubjectName));
+
+		switch (Record.Event)
+		{
+			case EOpenPF2PlaygroundEvent::AbilityBindingsLoading:
+				FCString::Snprintf(
+					Message,
+					UE_ARRAY_COUNT(Message),
+					TEXT("Character ('%s') is loading activatable abilities."),
+					SubjectName
+				);
+				break;
+
+			case EOpenPF2PlaygroundEvent::AbilityBindingsLoaded:
+				FCString::Snprintf(
+					Message,
+					UE_ARRAY_COUNT(Message),
+					TEXT("Character ('%s') changed %d ability binding(s)."),
+					SubjectName,
+					Record.Args[0]
+				);
+				break;
+
+			case EOpenPF2PlaygroundEvent::AbilityBindingsReloadCoalesced:
+				FCString::Snprintf(
+					Message,
+					UE_ARRAY_COUNT(Message),
+					TEXT("Character ('%s') is reloading coalesced ability bindings (%d notification(s), %d ")
+					TEXT("reload(s))."),
+					SubjectName,
+					Record.Args[0],
+					Record.Args[1]
+				);
+				break;
+
+			case EOpenPF2PlaygroundEvent::AbilityChangeListenerSetup:
+				FCString::Snprintf(
+					Message,
+					UE_ARRAY_COUNT(Message),
+					TEXT("Character ('%s') set up client ability change listener."),
+					SubjectName
+				);
+				break;
+
+			case EOpenPF2PlaygroundEvent::PossessionSwapCompleted:
+				FCString::Snprintf(
+					Message,
+					UE_ARRAY_COUNT(Message),
+					TEXT("Abilities of character ('%s') became usable %.3f ms after the player swapped characters."),
+					SubjectName,
+					Record.Value
+				);
+				break;
+
+			case EOpenPF2PlaygroundEvent::PartyOwnershipAcknowledged:
+				FCString::Snprintf(
+					Message,
+					UE_ARRAY_COUNT(Message),
+					TEXT("Player controller ('%s') acknowledged %d character(s) in %.3f ms (%d with deferred input ")
+					TEXT("bindings)."),
+					SubjectName,
+					Record.Args[0],
+					Record.Value,
+					Record.Args[1]
+				);
+				break;
+
+			default:
+				FCString::Snprintf(
+					Message,
+					UE_ARRAY_COUNT(Message),
+					TEXT("Unknown event (%d) for '%s'."),
+					static_cast<int32>(Record.Event),
+					SubjectName
+				);
+				break;
+		}
+
+		FCString::Snprintf(
+			OutLine,
+			OutLineLength,
+			TEXT("  %.6f [Frame %llu] [Thread %u] [%s] %s"),
+			FPlatformTime::ToSeconds64(Record.Cycles),
+			Record.FrameNumber,
+			ThreadId,
+			HostId,
+			Message
+		);
+	}
+
+	static void DumpOnSystemError()
+	{
+		// Only dump once, even if the process crashes again while dumping.
+		if (!GIsEnabled || bHasDumpedOnSystemError.exchange(true))
+		{
+			return;
+		}
+
+		const int32 NumBuffers = FMath::Min(NumThreadBuffers.load(std::memory_order_acquire), MaxThreadBuffers);
+
+		for (int32 BufferIndex = 0; BufferIndex < NumBuffers; ++BufferIndex)
+		{
+			const uint32 NumWritten = ThreadBuffers[BufferIndex]->NumWritten.load(std::memory_order_acquire);
+
+			CrashDumpCursors[BufferIndex] = NumWritten - FMath::Min(NumWritten, FEventRingBuffer::Capacity);
+			CrashDumpEnds[BufferIndex]    = NumWritten;
+		}
+
+		FPlatformMisc::LowLevelOutputDebugString(TEXT("Playground event log (crash dump):\n"));
+
+		// Merge the ring buffers oldest first, in place. This is quadratic in the number of threads, but needs no
+		// storage beyond what was reserved up front.
+		while (true)
+		{
+			const FEventRecord* OldestRecord      = nullptr;
+			int32               OldestBufferIndex = INDEX_NONE;
+
+			for (int32 BufferIndex = 0; BufferIndex < NumBuffers; ++BufferIndex)
+			{
+				const uint32 Cursor = CrashDumpCursors[BufferIndex];
+
+				if (Cursor != CrashDumpEnds[BufferIndex])
+				{
+					const FEventRecord& Record =
+						ThreadBuffers[BufferIndex]->Records[Cursor & (FEventRingBuffer::Capacity - 1)];
+
+					if ((OldestRecord == nullptr) || (Record.Cycles < OldestRecord->Cycles))
+					{
+						OldestRecord      = &Record;
+						OldestBufferIndex = BufferIndex;
+					}
+				}
+			}
+
+			if (OldestRecord == nullptr)
+			{
+				break;
+			}
+
+			// Leave room for the line break.
+			FormatRecord(ThreadBuffers[OldestBufferIndex]->ThreadId, *OldestRecord, CrashDumpLine, MaxLineLength - 1);
+
+			FCString::Strncat(CrashDumpLine, TEXT("\n"), MaxLineLength);
+			FPlatformMisc::LowLevelOutputDebugString(CrashDumpLine);
+
+			++CrashDumpCursors[OldestBufferIndex];
+		}
+	}
+}
@@ -0,0 +1,135 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class AActor;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * The types of events that can be recorded in the playground event log.
+ */
+enum class EOpenPF2PlaygroundEvent : uint8
+{
+	/**
+	 * A character is loading input bindings for its abilities.
+	 */
+	AbilityBindingsLoading,
+
+	/**
+	 * A character has loaded input bindings for its abilities. Arg0 is the number of bindings that changed.
+	 */
+	AbilityBindingsLoaded,
+
+	/**
+	 * A character is reloading ability bindings after coalescing ability change notifications. Arg0 is the number of
+	 * notifications and Arg1 is the number of reloads so far.
+	 */
+	AbilityBindingsReloadCoalesced,
+
+	/**
+	 * A client-side character has started listening for changes to its abilities.
+	 */
+	AbilityChangeListenerSetup,
+
+	/**
+	 * The abilities of a character became usable after a possession swap. Value is the latency, in milliseconds.
+	 */
+	PossessionSwapCompleted,
+
+	/**
+	 * A player controller has acknowledged ownership of a batch of characters. Arg0 is the number of characters in the
+	 * batch, Arg1 is the number of them with deferred input bindings, and Value is the time taken, in milliseconds.
+	 */
+	PartyOwnershipAcknowledged,
+};
+
+/**
+ * A low-overhead, structured log of input and ability events.
+ *
+ * Unlike UE_LOG, recording an event does not format any strings. Each event is stored as a small binary record in a
+ * fixed-size ring buffer that belongs to the thread recording it, and is only formatted when the log is dumped (with
+ * the "Pf2Playground.EventLog.Dump" console command, or automatically when the process crashes). Recording is disabled
+ * unless the "Pf2Playground.EventLog.Enabled" console variable is set, in which case the only cost is a branch.
+ */
+namespace OpenPF2PlaygroundEventLog
+{
+	/**
+	 * Whether events are currently being recorded. Backed by the "Pf2Playground.EventLog.Enabled" console variable.
+	 */
+	extern OPENPF2PLAYGROUND_API bool GIsEnabled;
+
+	/**
+	 * Records an event without checking whether recording is enabled.
+	 *
+	 * @param Event
+	 *	The type of event being recorded.
+	 * @param Subject
+	 *	The actor (character or player controller) that the event is about.
+	 * @param Arg0
+	 *	The first integer argument of the event. The meaning depends on the type of event.
+	 * @param Arg1
+	 *	The second integer argument of the event. The meaning depends on the type of event.
+	 * @param Value
+	 *	The floating-point argument of the event. The meaning depends on the type of event.
+	 */
+	OPENPF2PLAYGROUND_API void RecordUnchecked(const EOpenPF2PlaygroundEvent Event,
+	                                           const AActor*                 Subject,
+	                                           const int32                   Arg0,
+	                                           const int32                   Arg1,
+	                                           const float                   Value);
+
+	/**
+	 * Formats every event that is still in the ring buffer of each thread, oldest first.
+	 *
+	 * @param OutputDevice
+	 *	The output device to which events are written.
+	 */
+	OPENPF2PLAYGROUND_API void Dump(FOutputDevice& OutputDevice);
+
+	/**
+	 * Determines whether events are currently being recorded.
+	 *
+	 * @return
+	 *	true if events are being recorded; or, false if recording an event does nothing.
+	 */
+	FORCEINLINE bool IsEnabled()
+	{
+		return GIsEnabled;
+	}
+
+	/**
+	 * Records an event, if recording is enabled.
+	 *
+	 * @param Event
+	 *	The type of event being recorded.
+	 * @param Subject
+	 *	The actor (character or player controller) that the event is about.
+	 * @param Arg0
+	 *	The first integer argument of the event. The meaning depends on the type of event.
+	 * @param Arg1
+	 *	The second integer argument of the event. The meaning depends on the type of event.
+	 * @param Value
+	 *	The floating-point argument of the event. The meaning depends on the type of event.
+	 */
+	FORCEINLINE void Record(const EOpenPF2PlaygroundEvent Event,
+	                        const AActor*                 Subject,
+	                        const int32                   Arg0  = 0,
+	                        const int32                   Arg1  = 0,
+	                        const float                   Value = 0.0f)
+	{
+		if (IsEnabled())
+		{
+			RecordUnchecked(Event, Subject, Arg0, Arg1, Value);
+		}
+	}
+}
@@ -1,15 +1,295 @@
-﻿// OpenPF2 for UE Game Logic, Copyright 2021, Guy Elsmore-Paddock. All Rights Reserved.
+﻿// OpenPF2 for UE Game Logic, Copyright 2021-2024, Guy Elsmore-Paddock. All Rights Reserved.
 //
 // This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
 // distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "OpenPF2PlaygroundGameState.h"
 
+#include <AbilitySystemComponent.h>
+#include <AbilitySystemGlobals.h>
+#include <EngineUtils.h>
+
+#include <GameFramework/PlayerController.h>
+
 #include <Net/UnrealNetwork.h>
 
+#include <Net/Core/PushModel/PushModel.h>
+
+#include "OpenPF2PlaygroundAssetManager.h"
+#include "OpenPF2PlaygroundCharacterBase.h"
+#include "OpenPF2PlaygroundEncounterPrewarmSubsystem.h"
+#include "OpenPF2PlaygroundReplicationGraph.h"
+#include "PF2CharacterInterface.h"
+#include "PF2PlayerControllerInterface.h"
+
+AOpenPF2PlaygroundGameState::AOpenPF2PlaygroundGameState() :
+	ActiveCombatant(nullptr),
+	ObservedModeOfPlay(EPF2ModeOfPlayType::None),
+	HitPointsAttributeName(TEXT("HitPoints")),
+	EncounterCombatantRadius(3000.0f)
+{
+	this->EncounterRoster.OwningGameState = this;
+
+	// The mode of play is replicated by the base class without a callback we can hook, so it is checked each tick.
+	this->PrimaryActorTick.bCanEverTick = true;
+}
+
 void AOpenPF2PlaygroundGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
+	FDoRepLifetimeParams PushModelParams;
+
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(AOpenPF2PlaygroundGameState, RemainingEnemies);
+	PushModelParams.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AOpenPF2PlaygroundGameState, EncounterRoster, PushModelParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AOpenPF2PlaygroundGameState, ActiveCombatant, PushModelParams);
+}
+
+void AOpenPF2PlaygroundGameState::Tick(const float DeltaSeconds)
+{
+	const EPF2ModeOfPlayType ModeOfPlay = this->GetModeOfPlay();
+
+	Super::Tick(DeltaSeconds);
+
+	if (ModeOfPlay != this->ObservedModeOfPlay)
+	{
+		this->ObservedModeOfPlay = ModeOfPlay;
+
+		this->Native_OnModeOfPlayChanged(ModeOfPlay);
+	}
+}
+
+void AOpenPF2PlaygroundGameState::AddOrUpdateCombatant(AActor*                      Combatant,
+                                                       const bool                   bIsEnemy,
+                                                       const float                  HitPoints,
+                                                       const FGameplayTagContainer& Conditions)
+{
+	check(this->HasAuthority());
+
+	this->EncounterRoster.AddOrUpdateEntry(Combatant, bIsEnemy, HitPoints, Conditions);
+}
+
+void AOpenPF2PlaygroundGameState::UpdateCombatant(AActor*                      Combatant,
+                                                  const float                  HitPoints,
+                                                  const FGameplayTagContainer& Conditions)
+{
+	const FOpenPF2PlaygroundEncounterRosterEntry* Entry;
+
+	check(this->HasAuthority());
+
+	Entry = this->EncounterRoster.FindEntry(Combatant);
+
+	if (Entry != nullptr)
+	{
+		this->EncounterRoster.AddOrUpdateEntry(Combatant, Entry->bIsEnemy, HitPoints, Conditions);
+	}
+}
+
+void AOpenPF2PlaygroundGameState::RemoveCombatant(AActor* Combatant)
+{
+	check(this->HasAuthority());
+
+	this->EncounterRoster.RemoveEntry(Combatant);
+}
+
+void AOpenPF2PlaygroundGameState::ClearEncounterRoster()
+{
+	check(this->HasAuthority());
+
+	this->EncounterRoster.ClearEntries();
+}
+
+void AOpenPF2PlaygroundGameState::SetEncounterCombatants(const TArray<AActor*>& Combatants)
+{
+	TArray<AActor*> PartyMembers;
+
+	check(this->HasAuthority());
+
+	this->GetPartyMembers(PartyMembers);
+
+	this->EncounterRoster.ClearEntries();
+
+	for (AActor* Combatant : Combatants)
+	{
+		if (Combatant != nullptr)
+		{
+			this->EncounterRoster.AddOrUpdateEntry(
+				Combatant,
+				!PartyMembers.Contains(Combatant),
+				this->GetCombatantHitPoints(Combatant),
+				FGameplayTagContainer()
+			);
+		}
+	}
+}
+
+void AOpenPF2PlaygroundGameState::SetActiveCombatant(AActor* NewActiveCombatant)
+{
+	check(this->HasAuthority());
+
+	if (this->ActiveCombatant == NewActiveCombatant)
+	{
+		return;
+	}
+
+	this->ActiveCombatant = NewActiveCombatant;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(AOpenPF2PlaygroundGameState, ActiveCombatant, this);
+
+	this->OnActiveCombatantChanged.Broadcast(NewActiveCombatant);
+}
+
+void AOpenPF2PlaygroundGameState::GetPartyMembers(TArray<AActor*>& OutPartyMembers) const
+{
+	for (FConstPlayerControllerIterator ControllerIt = this->GetWorld()->GetPlayerControllerIterator();
+	     ControllerIt;
+	     ++ControllerIt)
+	{
+		const IPF2PlayerControllerInterface* PlayerControllerIntf =
+			Cast<IPF2PlayerControllerInterface>(ControllerIt->Get());
+
+		if (PlayerControllerIntf == nullptr)
+		{
+			continue;
+		}
+
+		for (const TScriptInterface<IPF2CharacterInterface>& Character :
+		     PlayerControllerIntf->GetControllableCharacters())
+		{
+			AActor* CharacterActor = Cast<AActor>(Character.GetObject());
+
+			if (CharacterActor != nullptr)
+			{
+				OutPartyMembers.AddUnique(CharacterActor);
+			}
+		}
+	}
+}
+
+void AOpenPF2PlaygroundGameState::FindEncounterCombatants(TArray<AActor*>& OutCombatants) const
+{
+	const double    RadiusSquared = FMath::Square(this->EncounterCombatantRadius);
+	TArray<AActor*> PartyMembers;
+
+	this->GetPartyMembers(PartyMembers);
+
+	OutCombatants.Append(PartyMembers);
+
+	for (TActorIterator<AOpenPF2PlaygroundCharacterBase> CharacterIt(this->GetWorld()); CharacterIt; ++CharacterIt)
+	{
+		AOpenPF2PlaygroundCharacterBase* Character = *CharacterIt;
+		const FVector                    Location  = Character->GetActorLocation();
+
+		if (PartyMembers.Contains(Character))
+		{
+			continue;
+		}
+
+		for (const AActor* PartyMember : PartyMembers)
+		{
+			if (FVector::DistSquared(Location, PartyMember->GetActorLocation()) <= RadiusSquared)
+			{
+				OutCombatants.Add(Character);
+				break;
+			}
+		}
+	}
+}
+
+float AOpenPF2PlaygroundGameState::GetCombatantHitPoints(const AActor* Combatant) const
+{
+	const UAbilitySystemComponent* Asc = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Combatant);
+
+	if (Asc == nullptr)
+	{
+		return 0.0f;
+	}
+
+	// The attribute is looked up by name, so that the roster does not depend on the attribute set of the plugin.
+	for (const UAttributeSet* AttributeSet : Asc->GetSpawnedAttributes())
+	{
+		FProperty* Property = FindFProperty<FProperty>(AttributeSet->GetClass(), this->HitPointsAttributeName);
+
+		if (Property != nullptr)
+		{
+			return Asc->GetNumericAttribute(FGameplayAttribute(Property));
+		}
+	}
+
+	return 0.0f;
+}
+
+void AOpenPF2PlaygroundGameState::OnRep_ActiveCombatant()
+{
+	this->OnActiveCombatantChanged.Broadcast(this->ActiveCombatant);
+}
+
+void AOpenPF2PlaygroundGameState::Native_OnEncounterRosterChanged()
+{
+	if (this->HasAuthority())
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(AOpenPF2PlaygroundGameState, EncounterRoster, this);
+
+		UOpenPF2PlaygroundReplicationGraph::NotifyEncounterRosterChanged(this);
+	}
+
+	this->OnEncounterRosterChanged.Broadcast();
+}
+
+void AOpenPF2PlaygroundGameState::Native_OnModeOfPlayChanged(const EPF2ModeOfPlayType ModeOfPlay)
+{
+	UOpenPF2PlaygroundAssetManager*              AssetManager     =
+		Cast<UOpenPF2PlaygroundAssetManager>(UAssetManager::GetIfValid());
+	UOpenPF2PlaygroundEncounterPrewarmSubsystem* PrewarmSubsystem =
+		UWorld::GetSubsystem<UOpenPF2PlaygroundEncounterPrewarmSubsystem>(this->GetWorld());
+
+	// Only the game changing modes loads or releases bundles, so that bundles loaded ahead of a change (e.g., by an
+	// encounter prewarm) are not released again before the game gets there.
+	if (AssetManager != nullptr)
+	{
+		AssetManager->LoadBundlesForModeOfPlay(ModeOfPlay);
+	}
+
+	if (this->HasAuthority())
+	{
+		if (ModeOfPlay != EPF2ModeOfPlayType::Encounter)
+		{
+			this->EncounterRoster.ClearEntries();
+		}
+		else if (this->EncounterRoster.Entries.Num() == 0)
+		{
+			TArray<AActor*> Combatants;
+
+			// Whatever started the encounter did not say who is in it (e.g., a Blueprint trigger volume), so assume
+			// that everyone close to a party is.
+			this->FindEncounterCombatants(Combatants);
+			this->SetEncounterCombatants(Combatants);
+		}
+	}
+
+	if (PrewarmSubsystem == nullptr)
+	{
+		return;
+	}
+
+	if (ModeOfPlay != EPF2ModeOfPlayType::Encounter)
+	{
+		// Release the assets that were prewarmed for the encounter that just ended.
+		PrewarmSubsystem->NotifyEncounterEnded();
+	}
+	else if (!PrewarmSubsystem->IsEncounterActive())
+	{
+		TArray<AActor*> Characters;
+
+		// The encounter was not prewarmed by a trigger volume before it started, so prewarm every character that could
+		// be taking part in it. This is too late to cover the start of the encounter, but it still loads everything
+		// before most combatants get their first turn.
+		for (TActorIterator<AOpenPF2PlaygroundCharacterBase> CharacterIt(this->GetWorld()); CharacterIt; ++CharacterIt)
+		{
+			Characters.Add(*CharacterIt);
+		}
+
+		PrewarmSubsystem->PrewarmEncounter(Characters, FOpenPF2PlaygroundEncounterPrewarmCompleteDelegate());
+	}
 }
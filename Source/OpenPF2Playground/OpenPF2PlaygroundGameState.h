@@ -1,14 +1,28 @@
-﻿// OpenPF2 for UE Game Logic, Copyright 2021-2023, Guy Elsmore-Paddock. All Rights Reserved.
+﻿// OpenPF2 for UE Game Logic, Copyright 2021-2024, Guy Elsmore-Paddock. All Rights Reserved.
 //
 // This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
 // distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #pragma once
 
+#include "OpenPF2PlaygroundEncounterRoster.h"
 #include "PF2GameStateBase.h"
 
 #include "OpenPF2PlaygroundGameState.generated.h"
 
+// =====================================================================================================================
+// Delegate Types
+// =====================================================================================================================
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOpenPF2PlaygroundEncounterRosterChangedDelegate);
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(
+	FOpenPF2PlaygroundActiveCombatantChangedDelegate,
+	AActor*, ActiveCombatant
+);
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
 /**
  * Default game state for the OpenPF2 Playground sample.
  */
@@ -18,13 +32,281 @@ class AOpenPF2PlaygroundGameState : public APF2GameStateBase
 {
 	GENERATED_BODY()
 
+	friend struct FOpenPF2PlaygroundEncounterRoster;
+
 protected:
 	// =================================================================================================================
-	// Protected Fields - Blueprint Accessible
+	// Protected Fields
 	// =================================================================================================================
 	/**
-	 * How many enemies remain in the current encounter.
+	 * The combatants in the current encounter.
+	 *
+	 * This is replicated to clients as deltas, so clients only receive the entries that have changed.
 	 */
 	UPROPERTY(Replicated)
-	int32 RemainingEnemies;
+	FOpenPF2PlaygroundEncounterRoster EncounterRoster;
+
+	/**
+	 * The combatant whose turn it is in the current encounter; or, nullptr if no combatant is taking a turn.
+	 */
+	UPROPERTY(ReplicatedUsing=OnRep_ActiveCombatant)
+	AActor* ActiveCombatant;
+
+	/**
+	 * The mode of play that the game was in as of the last tick.
+	 */
+	EPF2ModeOfPlayType ObservedModeOfPlay;
+
+	/**
+	 * The name of the attribute that holds the hit points of each combatant, as recorded in the encounter roster.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category="OpenPF2 Playground|Encounters")
+	FName HitPointsAttributeName;
+
+	/**
+	 * How close (in centimeters) a character must be to a member of a player's party to be added to the roster of an
+	 * encounter that starts without its combatants having been provided.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category="OpenPF2 Playground|Encounters", meta=(ClampMin=0))
+	float EncounterCombatantRadius;
+
+	// =================================================================================================================
+	// Protected Fields - Multicast Delegates
+	// =================================================================================================================
+	/**
+	 * Event fired when combatants are added to, removed from, or updated in the roster of the current encounter.
+	 *
+	 * On clients, this fires as changes to the roster replicate.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="OpenPF2 Playground|Encounters")
+	FOpenPF2PlaygroundEncounterRosterChangedDelegate OnEncounterRosterChanged;
+
+	/**
+	 * Event fired when the turn of a combatant starts, or when no combatant is taking a turn any longer.
+	 *
+	 * On clients, this fires as the active combatant replicates.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="OpenPF2 Playground|Encounters")
+	FOpenPF2PlaygroundActiveCombatantChangedDelegate OnActiveCombatantChanged;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit AOpenPF2PlaygroundGameState();
+
+	// =================================================================================================================
+	// Public Methods - AActor Overrides
+	// =================================================================================================================
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Adds a combatant to the roster of the current encounter, or updates it if it is already in the roster.
+	 *
+	 * This can only be called on the server.
+	 *
+	 * @param Combatant
+	 *	The combatant to add.
+	 * @param bIsEnemy
+	 *	Whether the combatant is an enemy of the players.
+	 * @param HitPoints
+	 *	The current hit points of the combatant.
+	 * @param Conditions
+	 *	The conditions that currently affect the combatant.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="OpenPF2 Playground|Encounters")
+	void AddOrUpdateCombatant(AActor*                      Combatant,
+	                          const bool                   bIsEnemy,
+	                          const float                  HitPoints,
+	                          const FGameplayTagContainer& Conditions);
+
+	/**
+	 * Updates the hit points and conditions of a combatant in the roster of the current encounter.
+	 *
+	 * This can only be called on the server. This has no effect if the combatant is not in the roster.
+	 *
+	 * @param Combatant
+	 *	The combatant to update.
+	 * @param HitPoints
+	 *	The current hit points of the combatant.
+	 * @param Conditions
+	 *	The conditions that currently affect the combatant.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="OpenPF2 Playground|Encounters")
+	void UpdateCombatant(AActor* Combatant, const float HitPoints, const FGameplayTagContainer& Conditions);
+
+	/**
+	 * Removes a combatant from the roster of the current encounter.
+	 *
+	 * This can only be called on the server.
+	 *
+	 * @param Combatant
+	 *	The combatant to remove.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="OpenPF2 Playground|Encounters")
+	void RemoveCombatant(AActor* Combatant);
+
+	/**
+	 * Removes all combatants from the roster of the current encounter.
+	 *
+	 * This can only be called on the server.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="OpenPF2 Playground|Encounters")
+	void ClearEncounterRoster();
+
+	/**
+	 * Replaces the roster of the current encounter with the given combatants.
+	 *
+	 * This can only be called on the server. Members of the party of any player are added as allies, and all other
+	 * combatants are added as enemies. The hit points of each combatant are read from its ASC.
+	 *
+	 * If the game enters Encounter mode with an empty roster, the roster is filled with the members of each party plus
+	 * the characters near them (see EncounterCombatantRadius). The roster is cleared when the game leaves Encounter
+	 * mode, and combatants are removed from it as they end play.
+	 *
+	 * @param Combatants
+	 *	The combatants of the encounter.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="OpenPF2 Playground|Encounters")
+	void SetEncounterCombatants(const TArray<AActor*>& Combatants);
+
+	/**
+	 * Gets the combatants in the current encounter.
+	 *
+	 * @return
+	 *	The entry for each combatant in the roster of the current encounter.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Encounters")
+	TArray<FOpenPF2PlaygroundEncounterRosterEntry> GetEncounterRoster() const
+	{
+		return this->EncounterRoster.Entries;
+	}
+
+	/**
+	 * Gets the combatants in the current encounter, without copying them.
+	 *
+	 * @return
+	 *	A reference to the entry for each combatant in the roster of the current encounter.
+	 */
+	FORCEINLINE const TArray<FOpenPF2PlaygroundEncounterRosterEntry>& GetEncounterRosterEntries() const
+	{
+		return this->EncounterRoster.Entries;
+	}
+
+	/**
+	 * Gets how many enemies remain in the current encounter.
+	 *
+	 * This is derived from the roster of the current encounter.
+	 *
+	 * @return
+	 *	The number of enemies in the encounter that have hit points remaining.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Encounters")
+	int32 GetRemainingEnemies() const
+	{
+		return this->EncounterRoster.CountRemainingEnemies();
+	}
+
+	/**
+	 * Sets the combatant whose turn it is in the current encounter.
+	 *
+	 * This can only be called on the server. The encounter rule set should call this at the start of each turn, and
+	 * with nullptr once the encounter has ended.
+	 *
+	 * @param NewActiveCombatant
+	 *	The combatant whose turn it now is; or, nullptr if no combatant is taking a turn.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="OpenPF2 Playground|Encounters")
+	void SetActiveCombatant(AActor* NewActiveCombatant);
+
+	/**
+	 * Gets the combatant whose turn it is in the current encounter.
+	 *
+	 * @return
+	 *	The combatant whose turn it is; or, nullptr if no combatant is taking a turn.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Encounters")
+	AActor* GetActiveCombatant() const
+	{
+		return this->ActiveCombatant;
+	}
+
+	/**
+	 * Gets the event fired when the turn of a combatant starts, or when no combatant is taking a turn any longer.
+	 *
+	 * @return
+	 *	The active combatant change event.
+	 */
+	FORCEINLINE FOpenPF2PlaygroundActiveCombatantChangedDelegate& GetActiveCombatantChangedEvent()
+	{
+		return this->OnActiveCombatantChanged;
+	}
+
+protected:
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Gets the members of the parties of all players.
+	 *
+	 * @param OutPartyMembers
+	 *	The characters that are controllable by a player controller.
+	 */
+	void GetPartyMembers(TArray<AActor*>& OutPartyMembers) const;
+
+	/**
+	 * Gets the combatants of an encounter that started without its combatants having been provided.
+	 *
+	 * @param OutCombatants
+	 *	The members of each party, plus every other character within EncounterCombatantRadius of one of them.
+	 */
+	void FindEncounterCombatants(TArray<AActor*>& OutCombatants) const;
+
+	/**
+	 * Gets the current hit points of a combatant.
+	 *
+	 * @param Combatant
+	 *	The combatant.
+	 *
+	 * @return
+	 *	The value of the hit points attribute of the combatant; or, zero if it does not have one.
+	 */
+	float GetCombatantHitPoints(const AActor* Combatant) const;
+
+	// =================================================================================================================
+	// Protected Replication Callbacks
+	// =================================================================================================================
+	/**
+	 * Callback invoked when the active combatant is replicated to clients.
+	 */
+	UFUNCTION()
+	void OnRep_ActiveCombatant();
+
+	// =================================================================================================================
+	// Protected Native Event Callbacks
+	// =================================================================================================================
+	/**
+	 * Native event fired when combatants are added to, removed from, or updated in the encounter roster.
+	 */
+	void Native_OnEncounterRosterChanged();
+
+	/**
+	 * Native event fired on the server and on clients when the mode of play of the game has changed.
+	 *
+	 * This loads the asset bundles of the new mode of play. It also prewarms the assets of an encounter that starts
+	 * without having been prewarmed, and releases them once the encounter ends. On the server, it fills the roster of
+	 * an encounter that starts with an empty roster, and clears the roster once the encounter ends.
+	 *
+	 * @param ModeOfPlay
+	 *	The new mode of play.
+	 */
+	virtual void Native_OnModeOfPlayChanged(const EPF2ModeOfPlayType ModeOfPlay);
 };
@@ -0,0 +1,74 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundGameplayCueManager.h"
+
+#include <AbilitySystemGlobals.h>
+#include <GameplayCueSet.h>
+
+#include "OpenPF2Playground.h"
+
+UOpenPF2PlaygroundGameplayCueManager* UOpenPF2PlaygroundGameplayCueManager::Get()
+{
+	return Cast<UOpenPF2PlaygroundGameplayCueManager>(UAbilitySystemGlobals::Get().GetGameplayCueManager());
+}
+
+void UOpenPF2PlaygroundGameplayCueManager::GetCueNotifyPathsForTags(const FGameplayTagContainer& GameplayCueTags,
+                                                                    TArray<FSoftObjectPath>&     OutNotifyPaths) const
+{
+	const UGameplayCueSet* CueSet = this->GetRuntimeCueSet();
+
+	if (CueSet == nullptr)
+	{
+		return;
+	}
+
+	for (const FGameplayTag& GameplayCueTag : GameplayCueTags)
+	{
+		const int32* DataIndexPtr = CueSet->GameplayCueDataMap.Find(GameplayCueTag);
+		int32        DataIndex    = (DataIndexPtr != nullptr) ? *DataIndexPtr : INDEX_NONE;
+
+		while (CueSet->GameplayCueData.IsValidIndex(DataIndex))
+		{
+			const FGameplayCueNotifyData& CueData = CueSet->GameplayCueData[DataIndex];
+
+			if (CueData.GameplayCueNotifyObj.IsValid())
+			{
+				OutNotifyPaths.AddUnique(CueData.GameplayCueNotifyObj);
+			}
+
+			DataIndex = CueData.ParentDataIdx;
+		}
+	}
+}
+
+bool UOpenPF2PlaygroundGameplayCueManager::HandleMissingGameplayCue(UGameplayCueSet*        OwningSet,
+                                                                    FGameplayCueNotifyData& CueData,
+                                                                    AActor*                 TargetActor,
+                                                                    EGameplayCueEvent::Type EventType,
+                                                                    FGameplayCueParameters& Parameters)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const bool   bHandled  = Super::HandleMissingGameplayCue(OwningSet, CueData, TargetActor, EventType, Parameters);
+
+	// The stock manager either loads the notify synchronously (and handles the cue right away) or starts loading it
+	// asynchronously (and drops the cue). Only the former is a hitch.
+	if (bHandled && (CueData.LoadedGameplayCueClass != nullptr))
+	{
+		const double LoadDuration = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(
+			LogPf2Playground,
+			Verbose,
+			TEXT("GameplayCue notify ('%s') was loaded synchronously in %.3f ms when it was invoked."),
+			*(CueData.GameplayCueNotifyObj.ToString()),
+			LoadDuration * 1000.0
+		);
+
+		this->OnSyncGameplayCueLoad.Broadcast(CueData.GameplayCueTag, LoadDuration);
+	}
+
+	return bHandled;
+}
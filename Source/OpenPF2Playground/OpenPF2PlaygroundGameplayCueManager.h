@@ -0,0 +1,91 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <GameplayCueManager.h>
+
+#include "OpenPF2PlaygroundGameplayCueManager.generated.h"
+
+// =====================================================================================================================
+// Delegate Types
+// =====================================================================================================================
+/**
+ * Delegate for native code to react to a GameplayCue notify having been loaded synchronously when it was invoked.
+ *
+ * @param GameplayCueTag
+ *	The tag of the GameplayCue whose notify was loaded.
+ * @param LoadDuration
+ *	How long (in seconds) it took to load the notify.
+ */
+DECLARE_MULTICAST_DELEGATE_TwoParams(
+	FOpenPF2PlaygroundSyncGameplayCueLoadDelegate,
+	const FGameplayTag& /* GameplayCueTag */,
+	double              /* LoadDuration */
+);
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * GameplayCue manager for the OpenPF2 Playground.
+ *
+ * This behaves like the stock GameplayCue manager, but times each GameplayCue notify that has to be loaded synchronously
+ * because it had not been loaded before it was invoked. Each of these loads is a hitch, so they are reported to the
+ * encounter prewarm subsystem, which keeps count of them.
+ */
+UCLASS()
+class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundGameplayCueManager : public UGameplayCueManager
+{
+	GENERATED_BODY()
+
+public:
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * Event fired whenever a GameplayCue notify has been loaded synchronously when it was invoked.
+	 */
+	FOpenPF2PlaygroundSyncGameplayCueLoadDelegate OnSyncGameplayCueLoad;
+
+	// =================================================================================================================
+	// Public Static Methods
+	// =================================================================================================================
+	/**
+	 * Gets the GameplayCue manager of the ability system, if it is a playground GameplayCue manager.
+	 *
+	 * @return
+	 *	Either the playground GameplayCue manager; or, nullptr if the ability system is configured to use a different
+	 *	type of GameplayCue manager.
+	 */
+	static UOpenPF2PlaygroundGameplayCueManager* Get();
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Gets the paths to the GameplayCue notifies in the runtime GameplayCue set that handle the given GameplayCues.
+	 *
+	 * The notifies of parent tags are included, since a GameplayCue falls back to (or is also handled by) the notify of
+	 * its parent tag.
+	 *
+	 * @param GameplayCueTags
+	 *	The tags of the GameplayCues.
+	 * @param OutNotifyPaths
+	 *	The paths to the notifies.
+	 */
+	void GetCueNotifyPathsForTags(const FGameplayTagContainer& GameplayCueTags,
+	                              TArray<FSoftObjectPath>&     OutNotifyPaths) const;
+
+protected:
+	// =================================================================================================================
+	// Protected Methods - UGameplayCueManager Overrides
+	// =================================================================================================================
+	virtual bool HandleMissingGameplayCue(UGameplayCueSet*        OwningSet,
+	                                      FGameplayCueNotifyData& CueData,
+	                                      AActor*                 TargetActor,
+	                                      EGameplayCueEvent::Type EventType,
+	                                      FGameplayCueParameters& Parameters) override;
+};
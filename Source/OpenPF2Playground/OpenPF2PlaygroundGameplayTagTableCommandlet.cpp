@@ -0,0 +1,353 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundGameplayTagTableCommandlet.h"
+
+#include <GameplayTagsManager.h>
+#include <GameplayTagsSettings.h>
+
+#include <AssetRegistry/AssetRegistryModule.h>
+
+#include <Dom/JsonObject.h>
+
+#include <Engine/DataTable.h>
+
+#include <Misc/DateTime.h>
+#include <Misc/FileHelper.h>
+#include <Misc/PackageName.h>
+#include <Misc/Paths.h>
+
+#include <Serialization/JsonSerializer.h>
+#include <Serialization/JsonWriter.h>
+
+#include <UObject/Package.h>
+#include <UObject/SavePackage.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundBenchmarkCommandlet.h"
+#include "OpenPF2PlaygroundPrecompiledGameplayTags.h"
+
+UOpenPF2PlaygroundGameplayTagTableCommandlet::UOpenPF2PlaygroundGameplayTagTableCommandlet()
+{
+	this->IsClient       = false;
+	this->IsServer       = false;
+	this->IsEditor       = true;
+	this->LogToConsole   = true;
+	this->ShowErrorCount = true;
+
+	this->PrecompiledGameplayTagTable = FSoftObjectPath(
+		TEXT("/Game/OpenPF2Playground/Tags/DT_PrecompiledGameplayTags.DT_PrecompiledGameplayTags")
+	);
+
+	this->DefaultNumIterations = 50;
+}
+
+int32 UOpenPF2PlaygroundGameplayTagTableCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	const bool                                bVerifyOnly   = FParse::Param(*Params, TEXT("Verify"));
+	int32                                     NumIterations = this->DefaultNumIterations;
+	bool                                      bHashesMatch;
+	FString                                   OutputPath;
+	FOpenPF2PlaygroundPrecompiledGameplayTags Table;
+	const TSharedRef<FJsonObject>             Report        = UOpenPF2PlaygroundBenchmarkCommandlet::CreateReport();
+	FString                                   ReportJson;
+
+	if (!GetDefault<UGameplayTagsSettings>()->ImportTagsFromConfig)
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT(
+				"Gameplay tags can only be precompiled when they are imported from config. Run this commandlet "
+				"without a custom config that disables \"ImportTagsFromConfig\"."
+			)
+		);
+
+		return 1;
+	}
+
+	Table = FOpenPF2PlaygroundPrecompiledGameplayTags::CaptureFromManager();
+
+	if (Table.GetNumExplicitTags() == 0)
+	{
+		UE_LOG(LogPf2Playground, Error, TEXT("The gameplay tag manager has no tags to precompile."));
+		return 1;
+	}
+
+	if (bVerifyOnly)
+	{
+		if (!this->VerifyDataTable(false))
+		{
+			return 1;
+		}
+	}
+	else
+	{
+		if (!this->SaveDataTable(Table))
+		{
+			UE_LOG(
+				LogPf2Playground,
+				Error,
+				TEXT("Failed to save precompiled gameplay tag table ('%s')."),
+				*(this->PrecompiledGameplayTagTable.ToString())
+			);
+
+			return 1;
+		}
+
+		UE_LOG(
+			LogPf2Playground,
+			Display,
+			TEXT("Precompiled %d gameplay tag(s) (network index hash '%u') into '%s'."),
+			Table.GetNumExplicitTags(),
+			Table.NetworkIndexHash,
+			*(this->PrecompiledGameplayTagTable.ToString())
+		);
+	}
+
+	if (!FParse::Param(*Params, TEXT("Compare")))
+	{
+		return 0;
+	}
+
+	FParse::Value(*Params, TEXT("Iterations="), NumIterations);
+
+	if (!FParse::Value(*Params, TEXT("Output="), OutputPath))
+	{
+		OutputPath = FPaths::Combine(
+			FPaths::ProjectSavedDir(),
+			TEXT("Benchmarks"),
+			FString::Printf(TEXT("OpenPF2Playground-GameplayTags-%s.json"), *(FDateTime::UtcNow().ToString()))
+		);
+	}
+
+	if (NumIterations < 1)
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT("Comparing gameplay tag tree construction times requires at least 1 iteration (got %d)."),
+			NumIterations
+		);
+
+		return 1;
+	}
+
+	Report->SetNumberField(TEXT("Iterations"), NumIterations);
+	Report->SetObjectField(TEXT("Metrics"), this->CompareTagTreeConstructionTimes(NumIterations, bHashesMatch));
+
+	FJsonSerializer::Serialize(Report, TJsonWriterFactory<>::Create(&ReportJson));
+
+	if (!FFileHelper::SaveStringToFile(ReportJson, *OutputPath))
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT("Failed to write gameplay tag tree construction times to '%s'."),
+			*OutputPath
+		);
+
+		return 1;
+	}
+
+	UE_LOG(
+		LogPf2Playground,
+		Display,
+		TEXT("Gameplay tag tree construction times written to '%s':\n%s"),
+		*OutputPath,
+		*ReportJson
+	);
+
+	if (!bHashesMatch)
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT(
+				"The network index constructed from the precompiled gameplay tag table does not match the one "
+				"constructed from the ini files."
+			)
+		);
+
+		return 1;
+	}
+
+	return 0;
+#else
+	UE_LOG(LogPf2Playground, Error, TEXT("Gameplay tags can only be precompiled by the editor."));
+
+	return 1;
+#endif
+}
+
+#if WITH_EDITOR
+bool UOpenPF2PlaygroundGameplayTagTableCommandlet::VerifyDataTable(const bool bIsCooking) const
+{
+	FOpenPF2PlaygroundPrecompiledGameplayTags Table;
+	const UDataTable*                         DataTable;
+
+	if (bIsCooking)
+	{
+		if (!FPackageName::DoesPackageExist(this->PrecompiledGameplayTagTable.GetLongPackageName()))
+		{
+			UE_LOG(
+				LogPf2Playground,
+				Display,
+				TEXT("Precompiled gameplay tag table ('%s') has not been created yet, so it was not verified."),
+				*(this->PrecompiledGameplayTagTable.ToString())
+			);
+
+			return true;
+		}
+
+		if (!GetDefault<UGameplayTagsSettings>()->ImportTagsFromConfig)
+		{
+			UE_LOG(
+				LogPf2Playground,
+				Warning,
+				TEXT(
+					"Precompiled gameplay tag table ('%s') was not verified because this cook does not import "
+					"gameplay tags from config."
+				),
+				*(this->PrecompiledGameplayTagTable.ToString())
+			);
+
+			return true;
+		}
+	}
+
+	Table     = FOpenPF2PlaygroundPrecompiledGameplayTags::CaptureFromManager();
+	DataTable = Cast<UDataTable>(this->PrecompiledGameplayTagTable.TryLoad());
+
+	if ((DataTable == nullptr) || !Table.MatchesDataTable(*DataTable))
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT(
+				"Precompiled gameplay tag table ('%s') is missing or stale. Run the OpenPF2PlaygroundGameplayTagTable "
+				"commandlet to precompile %d gameplay tag(s) into it again."
+			),
+			*(this->PrecompiledGameplayTagTable.ToString()),
+			Table.GetNumExplicitTags()
+		);
+
+		return false;
+	}
+
+	UE_LOG(
+		LogPf2Playground,
+		Display,
+		TEXT("Precompiled gameplay tag table ('%s') is up to date (%d gameplay tag(s))."),
+		*(this->PrecompiledGameplayTagTable.ToString()),
+		Table.GetNumExplicitTags()
+	);
+
+	return true;
+}
+
+bool UOpenPF2PlaygroundGameplayTagTableCommandlet::SaveDataTable(
+	const FOpenPF2PlaygroundPrecompiledGameplayTags& Table) const
+{
+	const FString    PackageName = this->PrecompiledGameplayTagTable.GetLongPackageName();
+	const FString    FilePath    =
+		FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+	UDataTable*      DataTable   = Cast<UDataTable>(this->PrecompiledGameplayTagTable.TryLoad());
+	UPackage*        Package;
+	FSavePackageArgs SaveArgs;
+
+	if (DataTable == nullptr)
+	{
+		Package   = CreatePackage(*PackageName);
+		DataTable = NewObject<UDataTable>(
+			Package,
+			FName(this->PrecompiledGameplayTagTable.GetAssetName()),
+			RF_Public | RF_Standalone
+		);
+
+		FAssetRegistryModule::AssetCreated(DataTable);
+	}
+	else
+	{
+		Package = DataTable->GetPackage();
+	}
+
+	Table.WriteToDataTable(*DataTable);
+
+	Package->MarkPackageDirty();
+
+	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+
+	return UPackage::SavePackage(Package, DataTable, *FilePath, SaveArgs);
+}
+
+double UOpenPF2PlaygroundGameplayTagTableCommandlet::TimeTagTreeConstruction(const bool bUsePrecompiledTable,
+                                                                              uint32&    OutNetworkIndexHash) const
+{
+	UGameplayTagsManager&         TagsManager          = UGameplayTagsManager::Get();
+	UGameplayTagsSettings*        Settings             = GetMutableDefault<UGameplayTagsSettings>();
+	const bool                    bOldImportFromConfig = Settings->ImportTagsFromConfig;
+	const TArray<FSoftObjectPath> OldTableList         = Settings->GameplayTagTableList;
+	double                        StartTime;
+	double                        Duration;
+
+	// This mirrors the "PrecompiledGameplayTags" custom config.
+	if (bUsePrecompiledTable)
+	{
+		Settings->ImportTagsFromConfig = false;
+		Settings->GameplayTagTableList.AddUnique(this->PrecompiledGameplayTagTable);
+	}
+
+	StartTime = FPlatformTime::Seconds();
+
+	TagsManager.EditorRefreshGameplayTagTree();
+
+	// The network index is constructed on demand, so reading its hash includes the time taken to construct it.
+	OutNetworkIndexHash = TagsManager.GetNetworkGameplayTagNodeIndexHash();
+
+	Duration = FPlatformTime::Seconds() - StartTime;
+
+	Settings->ImportTagsFromConfig = bOldImportFromConfig;
+	Settings->GameplayTagTableList = OldTableList;
+
+	return Duration;
+}
+
+TSharedRef<FJsonObject> UOpenPF2PlaygroundGameplayTagTableCommandlet::CompareTagTreeConstructionTimes(
+	const int32 NumIterations,
+	bool&       bOutHashesMatch) const
+{
+	const TSharedRef<FJsonObject> Metrics = MakeShared<FJsonObject>();
+	TArray<double>                IniSamples,
+	                              TableSamples;
+	uint32                        IniHash   = 0,
+	                              TableHash = 0;
+
+	// The data table is loaded by the first iteration that uses it and stays loaded, so only the first sample of the
+	// precompiled table includes loading its package.
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		IniSamples.Add(this->TimeTagTreeConstruction(false, IniHash));
+		TableSamples.Add(this->TimeTagTreeConstruction(true, TableHash));
+	}
+
+	// Leave the tag tree as it was before the comparison.
+	UGameplayTagsManager::Get().EditorRefreshGameplayTagTree();
+
+	bOutHashesMatch = (IniHash == TableHash);
+
+	Metrics->SetObjectField(TEXT("IniFiles"), UOpenPF2PlaygroundBenchmarkCommandlet::SummarizeSamples(IniSamples));
+	Metrics->SetNumberField(TEXT("IniFiles.NetworkIndexHash"), IniHash);
+	Metrics->SetObjectField(
+		TEXT("PrecompiledTable"),
+		UOpenPF2PlaygroundBenchmarkCommandlet::SummarizeSamples(TableSamples)
+	);
+	Metrics->SetNumberField(TEXT("PrecompiledTable.NetworkIndexHash"), TableHash);
+	Metrics->SetBoolField(TEXT("NetworkIndexHashesMatch"), bOutHashesMatch);
+
+	return Metrics;
+}
+#endif
@@ -0,0 +1,150 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Commandlets/Commandlet.h>
+
+#include "OpenPF2PlaygroundGameplayTagTableCommandlet.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class FJsonObject;
+
+struct FOpenPF2PlaygroundPrecompiledGameplayTags;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A commandlet that precompiles the gameplay tags declared in the ini files of the project into a data table.
+ *
+ * Builds that do not import tags from config (i.e., Shipping game and server builds, which use the
+ * "PrecompiledGameplayTags" custom config once the data table exists) list the data table in "GameplayTagTableList"
+ * instead, so that the gameplay tag manager reads every tag of the project from a single cooked asset rather than
+ * parsing and merging every tag ini file. The manager still constructs the tag tree and network index from those tags
+ * at startup, so this only saves the cost of parsing the ini files; use "-Compare" to measure whether that is worth it
+ * for a given set of tags. This commandlet must run with the default config, so that it sees the tags declared by the
+ * ini files.
+ *
+ * With "-Verify", the data table is not written. Instead, the commandlet fails if the data table does not declare the
+ * same tags as the ini files (i.e., it is stale). The same check runs whenever the game is cooked (see
+ * UOpenPF2PlaygroundAssetManager::ModifyCook()), so that a stale table fails the cook instead of producing a game that
+ * cannot replicate tags to or from other builds.
+ *
+ * With "-Compare", the commandlet also times the gameplay tag manager constructing its tag tree and network index
+ * from the ini files against constructing them from the data table, confirms that both produce the same network index
+ * hash, and writes the results as JSON.
+ *
+ * Usage:
+ * UnrealEditor-Cmd OpenPF2Playground.uproject -run=OpenPF2PlaygroundGameplayTagTable -nullrhi -unattended
+ *     [-Verify] [-Compare] [-Iterations=<N>] [-Output=<JSON Path>]
+ */
+UCLASS(Config=Game)
+class UOpenPF2PlaygroundGameplayTagTableCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * The gameplay tag data table into which tags are precompiled.
+	 *
+	 * This must match the entry in "GameplayTagTableList" of the "PrecompiledGameplayTags" custom config.
+	 */
+	UPROPERTY(Config)
+	FSoftObjectPath PrecompiledGameplayTagTable;
+
+	/**
+	 * The number of times to time each way of constructing the tag tree when comparing them, unless overridden on the
+	 * command line.
+	 */
+	UPROPERTY(Config)
+	int32 DefaultNumIterations;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundGameplayTagTableCommandlet();
+
+	// =================================================================================================================
+	// Public Methods - UCommandlet Overrides
+	// =================================================================================================================
+	virtual int32 Main(const FString& Params) override;
+
+#if WITH_EDITOR
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Determines whether the precompiled gameplay tag data table declares the same tags as the ini files.
+	 *
+	 * An error is logged if it does not.
+	 *
+	 * @param bIsCooking
+	 *	Whether the game is being cooked. While cooking, a data table that has not been created yet is skipped (since
+	 *	builds keep importing tags from the ini files until it exists), as is a cook that does not import tags from the
+	 *	ini files (since there are no tags to compare the data table against).
+	 *
+	 * @return
+	 *	true if the data table is up to date or was skipped; or, false if it is missing or stale.
+	 */
+	bool VerifyDataTable(const bool bIsCooking) const;
+#endif
+
+protected:
+#if WITH_EDITOR
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Writes the explicit tags of a captured tag tree to the precompiled gameplay tag data table, and saves it.
+	 *
+	 * @param Table
+	 *	The tag tree captured from the gameplay tag manager.
+	 *
+	 * @return
+	 *	true if the data table was saved; or, false otherwise.
+	 */
+	bool SaveDataTable(const FOpenPF2PlaygroundPrecompiledGameplayTags& Table) const;
+
+	/**
+	 * Rebuilds the tag tree of the gameplay tag manager, timing how long it takes.
+	 *
+	 * The time includes constructing the network index, since the manager does so during startup as well.
+	 *
+	 * @param bUsePrecompiledTable
+	 *	Whether to construct the tree from the precompiled data table (true) or from the ini files (false).
+	 * @param OutNetworkIndexHash
+	 *	The hash of the network index that was constructed.
+	 *
+	 * @return
+	 *	The time (in seconds) that it took to construct the tag tree and network index.
+	 */
+	double TimeTagTreeConstruction(const bool bUsePrecompiledTable, uint32& OutNetworkIndexHash) const;
+
+	/**
+	 * Times constructing the tag tree from the ini files against constructing it from the precompiled data table.
+	 *
+	 * The tag tree is left as it was constructed from the ini files.
+	 *
+	 * @param NumIterations
+	 *	The number of times to time each way of constructing the tag tree.
+	 * @param bOutHashesMatch
+	 *	Whether both ways of constructing the tag tree produced the same network index hash.
+	 *
+	 * @return
+	 *	A JSON object with the timings of each way of constructing the tag tree, plus its network index hash.
+	 */
+	TSharedRef<FJsonObject> CompareTagTreeConstructionTimes(const int32 NumIterations, bool& bOutHashesMatch) const;
+#endif
+};
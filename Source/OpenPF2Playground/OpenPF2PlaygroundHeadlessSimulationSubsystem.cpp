@@ -0,0 +1,468 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundHeadlessSimulationSubsystem.h"
+
+#include <AbilitySystemComponent.h>
+#include <AbilitySystemGlobals.h>
+#include <EngineUtils.h>
+
+#include <Dom/JsonObject.h>
+
+#include <Engine/World.h>
+
+#include <GameFramework/GameModeBase.h>
+#include <GameFramework/GameStateBase.h>
+#include <GameFramework/PlayerController.h>
+
+#include <HAL/PlatformMemory.h>
+
+#include <Misc/App.h>
+#include <Misc/CommandLine.h>
+#include <Misc/DateTime.h>
+#include <Misc/FileHelper.h>
+#include <Misc/Paths.h>
+
+#include <Serialization/JsonSerializer.h>
+#include <Serialization/JsonWriter.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundAiCharacterBase.h"
+#include "OpenPF2PlaygroundBenchmarkCommandlet.h"
+#include "OpenPF2PlaygroundCharacterBase.h"
+#include "OpenPF2PlaygroundGameState.h"
+#include "OpenPF2PlaygroundSimulationAiController.h"
+#include "PF2GameModeInterface.h"
+#include "PF2GameStateInterface.h"
+
+bool UOpenPF2PlaygroundHeadlessSimulationSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return Super::ShouldCreateSubsystem(Outer) && FParse::Param(FCommandLine::Get(), TEXT("Pf2HeadlessSimulation"));
+}
+
+void UOpenPF2PlaygroundHeadlessSimulationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	const TCHAR* CommandLine = FCommandLine::Get();
+	float        TickRate    = this->DefaultTickRate;
+
+	Super::Initialize(Collection);
+
+	this->MaxTurns            = this->DefaultMaxTurns;
+	this->MaxSimulatedSeconds = this->DefaultMaxSimulatedSeconds;
+
+	FParse::Value(CommandLine, TEXT("Pf2SimTickRate="), TickRate);
+	FParse::Value(CommandLine, TEXT("Pf2SimMaxTurns="), this->MaxTurns);
+	FParse::Value(CommandLine, TEXT("Pf2SimMaxSeconds="), this->MaxSimulatedSeconds);
+
+	if (!FParse::Value(CommandLine, TEXT("Pf2SimOutput="), this->OutputPath))
+	{
+		this->OutputPath = FPaths::Combine(
+			FPaths::ProjectSavedDir(),
+			TEXT("Simulations"),
+			FString::Printf(TEXT("OpenPF2Playground-%s.json"), *(FDateTime::UtcNow().ToString()))
+		);
+	}
+
+	// Advance game time by a fixed step every frame, and start the next frame as soon as the last one has finished
+	// rather than waiting for the server tick rate. This is what "-benchmark -fps=<Hz>" does.
+	FApp::SetBenchmarking(true);
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / FMath::Max(TickRate, 1.0f));
+
+	UE_LOG(
+		LogPf2Playground,
+		Display,
+		TEXT("Headless simulation enabled at %.1f Hz (up to %d turn(s) or %.0f simulated second(s))."),
+		TickRate,
+		this->MaxTurns,
+		this->MaxSimulatedSeconds
+	);
+}
+
+void UOpenPF2PlaygroundHeadlessSimulationSubsystem::Deinitialize()
+{
+	AOpenPF2PlaygroundGameState* GameState = this->GetGameState();
+
+	if (GameState != nullptr)
+	{
+		GameState->GetActiveCombatantChangedEvent().RemoveDynamic(
+			this,
+			&UOpenPF2PlaygroundHeadlessSimulationSubsystem::Native_OnActiveCombatantChanged
+		);
+	}
+
+	if (this->Phase == EOpenPF2PlaygroundSimulationPhase::InEncounter)
+	{
+		this->FinishSimulation(TEXT("World torn down"));
+	}
+
+	Super::Deinitialize();
+}
+
+void UOpenPF2PlaygroundHeadlessSimulationSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	AOpenPF2PlaygroundGameState* GameState = Cast<AOpenPF2PlaygroundGameState>(InWorld.GetGameState());
+
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (GameState != nullptr)
+	{
+		GameState->GetActiveCombatantChangedEvent().AddUniqueDynamic(
+			this,
+			&UOpenPF2PlaygroundHeadlessSimulationSubsystem::Native_OnActiveCombatantChanged
+		);
+	}
+
+	this->PossessCharactersWithAi();
+}
+
+void UOpenPF2PlaygroundHeadlessSimulationSubsystem::Tick(const float DeltaTime)
+{
+	const double                  CurrentTime   = FPlatformTime::Seconds();
+	const IPF2GameStateInterface* GameStateIntf = Cast<IPF2GameStateInterface>(this->GetWorld()->GetGameState());
+	const EPF2ModeOfPlayType      ModeOfPlay    =
+		(GameStateIntf != nullptr) ? GameStateIntf->GetModeOfPlay() : EPF2ModeOfPlayType::None;
+
+	Super::Tick(DeltaTime);
+
+	this->SimulatedSeconds += DeltaTime;
+
+	switch (this->Phase)
+	{
+		case EOpenPF2PlaygroundSimulationPhase::WaitingToStart:
+			if (this->SimulatedSeconds >= this->EncounterStartDelay)
+			{
+				this->StartEncounter();
+			}
+			break;
+
+		case EOpenPF2PlaygroundSimulationPhase::InEncounter:
+			this->TickSamples.Add(CurrentTime - this->LastTickTime);
+
+			if (this->bHasEncounterStarted && (ModeOfPlay != EPF2ModeOfPlayType::Encounter))
+			{
+				this->FinishSimulation(TEXT("Encounter ended"));
+			}
+			else if (this->NumTurns >= this->MaxTurns)
+			{
+				this->FinishSimulation(TEXT("Turn limit reached"));
+			}
+			else if (this->SimulatedSeconds >= this->MaxSimulatedSeconds)
+			{
+				this->FinishSimulation(TEXT("Simulated time limit reached"));
+			}
+			else if (ModeOfPlay == EPF2ModeOfPlayType::Encounter)
+			{
+				if (!this->bHasEncounterStarted)
+				{
+					// The first turn starts as soon as the game has switched to Encounter mode.
+					this->bHasEncounterStarted = true;
+					this->TurnStartSeconds     = this->SimulatedSeconds - this->TurnDuration;
+				}
+
+				if ((this->SimulatedSeconds - this->TurnStartSeconds) >= this->TurnDuration)
+				{
+					this->AdvanceTurn();
+				}
+			}
+			break;
+
+		case EOpenPF2PlaygroundSimulationPhase::Finished:
+			break;
+	}
+
+	this->LastTickTime = CurrentTime;
+}
+
+TStatId UOpenPF2PlaygroundHeadlessSimulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UOpenPF2PlaygroundHeadlessSimulationSubsystem, STATGROUP_Tickables);
+}
+
+bool UOpenPF2PlaygroundHeadlessSimulationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game;
+}
+
+AOpenPF2PlaygroundGameState* UOpenPF2PlaygroundHeadlessSimulationSubsystem::GetGameState() const
+{
+	return this->GetWorld()->GetGameState<AOpenPF2PlaygroundGameState>();
+}
+
+void UOpenPF2PlaygroundHeadlessSimulationSubsystem::PossessCharactersWithAi() const
+{
+	UWorld*               World = this->GetWorld();
+	FActorSpawnParameters SpawnParameters;
+
+	SpawnParameters.OverrideLevel = World->PersistentLevel;
+	SpawnParameters.ObjectFlags  |= RF_Transient;
+
+	for (TActorIterator<AOpenPF2PlaygroundCharacterBase> CharacterIt(World); CharacterIt; ++CharacterIt)
+	{
+		AOpenPF2PlaygroundCharacterBase*          Character  = *CharacterIt;
+		AController*                              Controller = Character->GetController();
+		AOpenPF2PlaygroundSimulationAiController* SimulationController;
+
+		if (Controller != nullptr)
+		{
+			if (Controller->IsA<APlayerController>() || Controller->IsA<AOpenPF2PlaygroundSimulationAiController>())
+			{
+				continue;
+			}
+
+			// Replace the AI controller that the character spawned with (if any), since it does not take turns.
+			Controller->UnPossess();
+			Controller->Destroy();
+		}
+
+		SpawnParameters.Instigator = Character;
+
+		SimulationController = World->SpawnActor<AOpenPF2PlaygroundSimulationAiController>(
+			Character->GetActorLocation(),
+			Character->GetActorRotation(),
+			SpawnParameters
+		);
+
+		if (SimulationController != nullptr)
+		{
+			SimulationController->Possess(Character);
+		}
+	}
+}
+
+void UOpenPF2PlaygroundHeadlessSimulationSubsystem::StartEncounter()
+{
+	IPF2GameModeInterface*       GameModeIntf = Cast<IPF2GameModeInterface>(this->GetWorld()->GetAuthGameMode());
+	AOpenPF2PlaygroundGameState* GameState    = this->GetGameState();
+	int32                        NumEnemies   = 0,
+	                             NumAllies    = 0;
+
+	if ((GameModeIntf == nullptr) || (GameState == nullptr))
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT(
+				"Headless simulation requires an OpenPF2-compatible game mode and the playground game state; is this "
+				"the server of the game?"
+			)
+		);
+
+		this->Phase = EOpenPF2PlaygroundSimulationPhase::Finished;
+
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+		return;
+	}
+
+	// Party members that joined after play began (e.g., spawned by the game mode) also need AI controllers.
+	this->PossessCharactersWithAi();
+
+	this->TurnOrder.Reset();
+
+	for (TActorIterator<AOpenPF2PlaygroundCharacterBase> CharacterIt(this->GetWorld()); CharacterIt; ++CharacterIt)
+	{
+		AOpenPF2PlaygroundCharacterBase* Character = *CharacterIt;
+		const bool                       bIsEnemy  = Character->IsA<AOpenPF2PlaygroundAiCharacterBase>();
+		const float                      HitPoints = this->GetHitPoints(Character);
+
+		if ((HitPoints > 0.0f) && bIsEnemy)
+		{
+			++NumEnemies;
+		}
+		else if (HitPoints > 0.0f)
+		{
+			++NumAllies;
+		}
+
+		GameState->AddOrUpdateCombatant(Character, bIsEnemy, HitPoints, FGameplayTagContainer());
+
+		this->TurnOrder.Add(Character);
+	}
+
+	if ((NumEnemies == 0) || (NumAllies == 0))
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT(
+				"Headless simulation requires characters with hit points ('%s') on both sides, but found %d party "
+				"member(s) and %d enemy(ies) that can fight."
+			),
+			*this->HitPointsAttributeName.ToString(),
+			NumAllies,
+			NumEnemies
+		);
+
+		this->Phase = EOpenPF2PlaygroundSimulationPhase::Finished;
+
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+		return;
+	}
+
+	UE_LOG(
+		LogPf2Playground,
+		Display,
+		TEXT("Headless simulation starting an encounter between %d party member(s) and %d enemy(ies)."),
+		NumAllies,
+		NumEnemies
+	);
+
+	this->Phase              = EOpenPF2PlaygroundSimulationPhase::InEncounter;
+	this->EncounterStartTime = FPlatformTime::Seconds();
+	this->LastTickTime       = this->EncounterStartTime;
+
+	GameModeIntf->RequestEncounterMode();
+}
+
+void UOpenPF2PlaygroundHeadlessSimulationSubsystem::AdvanceTurn()
+{
+	AOpenPF2PlaygroundGameState* GameState     = this->GetGameState();
+	int32                        NumAllies     = 0;
+	AActor*                      NextCombatant = nullptr;
+
+	for (const TWeakObjectPtr<AActor>& CombatantPtr : this->TurnOrder)
+	{
+		AActor* Combatant = CombatantPtr.Get();
+
+		if (Combatant != nullptr)
+		{
+			GameState->UpdateCombatant(Combatant, this->GetHitPoints(Combatant), FGameplayTagContainer());
+		}
+	}
+
+	for (const FOpenPF2PlaygroundEncounterRosterEntry& Entry : GameState->GetEncounterRosterEntries())
+	{
+		if (!Entry.bIsEnemy && (Entry.HitPoints > 0.0f))
+		{
+			++NumAllies;
+		}
+	}
+
+	if (GameState->GetRemainingEnemies() == 0)
+	{
+		this->FinishSimulation(TEXT("Party won"));
+		return;
+	}
+
+	if (NumAllies == 0)
+	{
+		this->FinishSimulation(TEXT("Party defeated"));
+		return;
+	}
+
+	for (int32 Offset = 0; (Offset < this->TurnOrder.Num()) && (NextCombatant == nullptr); ++Offset)
+	{
+		AActor* Combatant = this->TurnOrder[(this->NextTurnIndex + Offset) % this->TurnOrder.Num()].Get();
+
+		if ((Combatant != nullptr) && (this->GetHitPoints(Combatant) > 0.0f))
+		{
+			NextCombatant       = Combatant;
+			this->NextTurnIndex = (this->NextTurnIndex + Offset + 1) % this->TurnOrder.Num();
+		}
+	}
+
+	this->TurnStartSeconds = this->SimulatedSeconds;
+
+	// The AI controller of the combatant takes its turn, and the turn is counted, as the game state broadcasts this.
+	GameState->SetActiveCombatant(NextCombatant);
+}
+
+float UOpenPF2PlaygroundHeadlessSimulationSubsystem::GetHitPoints(const AActor* Combatant) const
+{
+	const UAbilitySystemComponent* Asc = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Combatant);
+
+	if (Asc == nullptr)
+	{
+		return 0.0f;
+	}
+
+	// The attribute is looked up by name, so that the simulation does not depend on the attribute set of the plugin.
+	for (const UAttributeSet* AttributeSet : Asc->GetSpawnedAttributes())
+	{
+		FProperty* Property = FindFProperty<FProperty>(AttributeSet->GetClass(), this->HitPointsAttributeName);
+
+		if (Property != nullptr)
+		{
+			return Asc->GetNumericAttribute(FGameplayAttribute(Property));
+		}
+	}
+
+	return 0.0f;
+}
+
+int32 UOpenPF2PlaygroundHeadlessSimulationSubsystem::GetNumAbilityActivations() const
+{
+	int32 NumActivations = 0;
+
+	for (TActorIterator<AOpenPF2PlaygroundSimulationAiController> ControllerIt(this->GetWorld());
+	     ControllerIt;
+	     ++ControllerIt)
+	{
+		NumActivations += ControllerIt->GetNumAbilityActivations();
+	}
+
+	return NumActivations;
+}
+
+void UOpenPF2PlaygroundHeadlessSimulationSubsystem::FinishSimulation(const FString& Reason)
+{
+	const double                  WallSeconds = FPlatformTime::Seconds() - this->EncounterStartTime;
+	const FPlatformMemoryStats    MemoryStats = FPlatformMemory::GetStats();
+	const TSharedRef<FJsonObject> Report      = UOpenPF2PlaygroundBenchmarkCommandlet::CreateReport();
+	const TSharedRef<FJsonObject> Memory      = MakeShared<FJsonObject>();
+	AOpenPF2PlaygroundGameState*  GameState   = this->GetGameState();
+	FString                       ReportJson;
+
+	this->Phase = EOpenPF2PlaygroundSimulationPhase::Finished;
+
+	if (GameState != nullptr)
+	{
+		GameState->SetActiveCombatant(nullptr);
+	}
+
+	Memory->SetNumberField(TEXT("UsedPhysicalMiB"), MemoryStats.UsedPhysical / (1024.0 * 1024.0));
+	Memory->SetNumberField(TEXT("PeakUsedPhysicalMiB"), MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0));
+	Memory->SetNumberField(TEXT("UsedVirtualMiB"), MemoryStats.UsedVirtual / (1024.0 * 1024.0));
+
+	Report->SetStringField(TEXT("Map"), this->GetWorld()->GetMapName());
+	Report->SetStringField(TEXT("StopReason"), Reason);
+	Report->SetNumberField(TEXT("FixedDeltaTime"), FApp::GetFixedDeltaTime());
+	Report->SetNumberField(TEXT("Turns"), this->NumTurns);
+	Report->SetNumberField(TEXT("AbilityActivations"), this->GetNumAbilityActivations());
+	Report->SetNumberField(TEXT("WallSeconds"), WallSeconds);
+	Report->SetNumberField(TEXT("SimulatedSeconds"), this->SimulatedSeconds);
+	Report->SetNumberField(TEXT("TurnsPerSecond"), (WallSeconds > 0.0) ? (this->NumTurns / WallSeconds) : 0.0);
+	Report->SetObjectField(
+		TEXT("ServerTick"),
+		UOpenPF2PlaygroundBenchmarkCommandlet::SummarizeSamples(this->TickSamples)
+	);
+	Report->SetObjectField(TEXT("Memory"), Memory);
+
+	FJsonSerializer::Serialize(Report, TJsonWriterFactory<>::Create(&ReportJson));
+
+	if (!FFileHelper::SaveStringToFile(ReportJson, *this->OutputPath))
+	{
+		UE_LOG(LogPf2Playground, Error, TEXT("Failed to write simulation results to '%s'."), *this->OutputPath);
+	}
+
+	UE_LOG(
+		LogPf2Playground,
+		Display,
+		TEXT("Headless simulation finished (%s). Results written to '%s':\n%s"),
+		*Reason,
+		*this->OutputPath,
+		*ReportJson
+	);
+
+	FPlatformMisc::RequestExit(false);
+}
+
+void UOpenPF2PlaygroundHeadlessSimulationSubsystem::Native_OnActiveCombatantChanged(AActor* ActiveCombatant)
+{
+	if ((ActiveCombatant != nullptr) && (this->Phase == EOpenPF2PlaygroundSimulationPhase::InEncounter))
+	{
+		++this->NumTurns;
+	}
+}
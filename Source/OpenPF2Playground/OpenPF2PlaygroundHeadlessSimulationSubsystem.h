@@ -0,0 +1,295 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Subsystems/WorldSubsystem.h>
+
+#include "OpenPF2PlaygroundHeadlessSimulationSubsystem.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class AOpenPF2PlaygroundGameState;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * The phases of a headless encounter simulation.
+ */
+UENUM()
+enum class EOpenPF2PlaygroundSimulationPhase : uint8
+{
+	/**
+	 * The level has loaded, and the simulation is waiting for the world to settle before starting the encounter.
+	 */
+	WaitingToStart,
+
+	/**
+	 * The encounter has been requested, and the simulation is waiting for it to finish.
+	 */
+	InEncounter,
+
+	/**
+	 * The simulation has finished and its report has been written.
+	 */
+	Finished,
+};
+
+/**
+ * A world subsystem that fights an encounter with AI-controlled parties as fast as the CPU allows, without rendering.
+ *
+ * This is only created when the game or server is launched with "-Pf2HeadlessSimulation". For example, to load-test the
+ * encounter loop with the dedicated server target:
+ *
+ * OpenPF2PlaygroundServer /Game/OpenPF2Playground/Maps/Lvl_SoulCave_PF2 -Pf2HeadlessSimulation -log
+ *     [-Pf2SimTickRate=<Hz>] [-Pf2SimMaxTurns=<N>] [-Pf2SimMaxSeconds=<Seconds>] [-Pf2SimOutput=<JSON Path>]
+ *
+ * The engine is switched to fixed-step ticking without waiting between frames, and every character that a player does
+ * not control is given an AOpenPF2PlaygroundSimulationAiController. AI-only characters (see
+ * AOpenPF2PlaygroundAiCharacterBase) fight as enemies and all other characters fight as the party; both sides are added
+ * to the roster of the game state before an encounter is requested from the game mode.
+ *
+ * Once the encounter has started, the simulation gives each combatant that can still fight a turn of a fixed length of
+ * game time, in roster order, through AOpenPF2PlaygroundGameState::SetActiveCombatant(). The AI controller of each
+ * combatant attacks the nearest opponent on its turn. Turns are counted from the game state as they start.
+ *
+ * Once one side has no hit points left, the encounter ends, or a limit on turns or simulated time is reached, a JSON
+ * report of turns per second, ability activations, server tick time percentiles, and memory usage is written, and the
+ * process exits.
+ */
+UCLASS(Config=Game)
+class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundHeadlessSimulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * The number of fixed-length steps to simulate per second of game time, unless overridden on the command line.
+	 */
+	UPROPERTY(Config)
+	float DefaultTickRate;
+
+	/**
+	 * The number of turns after which to stop the simulation, unless overridden on the command line.
+	 */
+	UPROPERTY(Config)
+	int32 DefaultMaxTurns;
+
+	/**
+	 * The amount of game time (in seconds) after which to stop the simulation, unless overridden on the command line.
+	 */
+	UPROPERTY(Config)
+	float DefaultMaxSimulatedSeconds;
+
+	/**
+	 * How much game time (in seconds) to let pass after play begins before requesting the encounter.
+	 */
+	UPROPERTY(Config)
+	float EncounterStartDelay;
+
+	/**
+	 * How much game time (in seconds) each combatant is given to take its turn.
+	 */
+	UPROPERTY(Config)
+	float TurnDuration;
+
+	/**
+	 * The name of the attribute that holds the hit points of each combatant.
+	 */
+	UPROPERTY(Config)
+	FName HitPointsAttributeName;
+
+	/**
+	 * The current phase of the simulation.
+	 */
+	EOpenPF2PlaygroundSimulationPhase Phase;
+
+	/**
+	 * The number of turns after which to stop the simulation.
+	 */
+	int32 MaxTurns;
+
+	/**
+	 * The amount of game time (in seconds) after which to stop the simulation.
+	 */
+	float MaxSimulatedSeconds;
+
+	/**
+	 * The path to which the report is to be written.
+	 */
+	FString OutputPath;
+
+	/**
+	 * Whether the game has entered Encounter mode since the encounter was requested.
+	 */
+	bool bHasEncounterStarted;
+
+	/**
+	 * The amount of game time (in seconds) that has been simulated.
+	 */
+	double SimulatedSeconds;
+
+	/**
+	 * The number of turns that have started in the encounter.
+	 */
+	int32 NumTurns;
+
+	/**
+	 * The combatants of the encounter, in the order that they take their turns.
+	 */
+	UPROPERTY()
+	TArray<TWeakObjectPtr<AActor>> TurnOrder;
+
+	/**
+	 * The index in the turn order of the combatant that takes the next turn.
+	 */
+	int32 NextTurnIndex;
+
+	/**
+	 * The amount of game time (in seconds) that had been simulated when the current turn started.
+	 */
+	double TurnStartSeconds;
+
+	/**
+	 * The wall-clock time (in seconds) at which the encounter was requested.
+	 */
+	double EncounterStartTime;
+
+	/**
+	 * The wall-clock time (in seconds) at which the last frame was ticked.
+	 */
+	double LastTickTime;
+
+	/**
+	 * The wall-clock time (in seconds) of each server frame since the encounter was requested.
+	 */
+	TArray<double> TickSamples;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundHeadlessSimulationSubsystem() :
+		DefaultTickRate(30.0f),
+		DefaultMaxTurns(500),
+		DefaultMaxSimulatedSeconds(3600.0f),
+		EncounterStartDelay(1.0f),
+		TurnDuration(2.0f),
+		HitPointsAttributeName(TEXT("HitPoints")),
+		Phase(EOpenPF2PlaygroundSimulationPhase::WaitingToStart),
+		MaxTurns(0),
+		MaxSimulatedSeconds(0.0f),
+		bHasEncounterStarted(false),
+		SimulatedSeconds(0.0),
+		NumTurns(0),
+		NextTurnIndex(0),
+		TurnStartSeconds(0.0),
+		EncounterStartTime(0.0),
+		LastTickTime(0.0)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Methods - USubsystem Overrides
+	// =================================================================================================================
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	// =================================================================================================================
+	// Public Methods - UWorldSubsystem Overrides
+	// =================================================================================================================
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// =================================================================================================================
+	// Public Methods - FTickableGameObject Overrides
+	// =================================================================================================================
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+	// =================================================================================================================
+	// Protected Methods - UWorldSubsystem Overrides
+	// =================================================================================================================
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Gets the game state of the world, if it is compatible with the playground.
+	 *
+	 * @return
+	 *	The game state; or, nullptr if the world does not have a playground game state.
+	 */
+	AOpenPF2PlaygroundGameState* GetGameState() const;
+
+	/**
+	 * Gives a simulation AI controller to every playground character that a player does not control.
+	 */
+	void PossessCharactersWithAi() const;
+
+	/**
+	 * Adds both sides to the roster of the encounter, then asks the game mode to start an encounter.
+	 */
+	void StartEncounter();
+
+	/**
+	 * Refreshes the hit points of every combatant in the roster, then starts the turn of the next combatant that can
+	 * still fight, or finishes the simulation if one side has been defeated.
+	 */
+	void AdvanceTurn();
+
+	/**
+	 * Gets the current hit points of a combatant.
+	 *
+	 * @param Combatant
+	 *	The combatant for which hit points are desired.
+	 *
+	 * @return
+	 *	The current hit points of the combatant; or, 0 if the combatant has no ability system or no hit points
+	 *	attribute.
+	 */
+	float GetHitPoints(const AActor* Combatant) const;
+
+	/**
+	 * Gets the number of abilities that the AI controllers of the simulation have activated.
+	 *
+	 * @return
+	 *	The number of abilities activated across all combatants.
+	 */
+	int32 GetNumAbilityActivations() const;
+
+	/**
+	 * Writes the report of the simulation and asks the engine to exit.
+	 *
+	 * @param Reason
+	 *	Why the simulation stopped.
+	 */
+	void FinishSimulation(const FString& Reason);
+
+	// =================================================================================================================
+	// Protected Native Event Callbacks
+	// =================================================================================================================
+	/**
+	 * Native callback invoked by the game state when a turn starts or ends.
+	 *
+	 * @param ActiveCombatant
+	 *	The combatant whose turn it now is; or, nullptr if no combatant is taking a turn.
+	 */
+	UFUNCTION()
+	void Native_OnActiveCombatantChanged(AActor* ActiveCombatant);
+};
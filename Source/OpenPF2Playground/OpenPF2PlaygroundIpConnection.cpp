@@ -0,0 +1,30 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundIpConnection.h"
+
+#include <Engine/NetDriver.h>
+#include <Engine/World.h>
+
+#include "OpenPF2PlaygroundNetStatsSubsystem.h"
+
+int32 UOpenPF2PlaygroundIpConnection::SendRawBunch(FOutBunch&                Bunch,
+                                                   const bool                InAllowMerge,
+                                                   const FNetTraceCollector* BunchCollector)
+{
+	if (UOpenPF2PlaygroundNetStatsSubsystem::IsAccountingEnabled() && (this->Driver != nullptr))
+	{
+		const UWorld*                        World    = this->Driver->GetWorld();
+		UOpenPF2PlaygroundNetStatsSubsystem* NetStats =
+			(World != nullptr) ? World->GetSubsystem<UOpenPF2PlaygroundNetStatsSubsystem>() : nullptr;
+
+		if (NetStats != nullptr)
+		{
+			NetStats->RecordBunch(Bunch.Channel, Bunch.GetNumBits());
+		}
+	}
+
+	return Super::SendRawBunch(Bunch, InAllowMerge, BunchCollector);
+}
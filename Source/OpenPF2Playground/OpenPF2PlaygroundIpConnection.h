@@ -0,0 +1,32 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <IpConnection.h>
+
+#include "OpenPF2PlaygroundIpConnection.generated.h"
+
+/**
+ * An IP connection that reports every bunch it sends to the network stats subsystem of its world.
+ *
+ * This attributes the outgoing bandwidth of each connection to the class of the actor on whose channel it was sent.
+ * When no network load test is running, this behaves exactly like a UIpConnection.
+ */
+UCLASS(Transient, Config=Engine)
+class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundIpConnection : public UIpConnection
+{
+	GENERATED_BODY()
+
+public:
+	// =================================================================================================================
+	// Public Methods - UNetConnection Overrides
+	// =================================================================================================================
+	using Super::SendRawBunch;
+
+	virtual int32 SendRawBunch(FOutBunch&                Bunch,
+	                           bool                      InAllowMerge,
+	                           const FNetTraceCollector* BunchCollector) override;
+};
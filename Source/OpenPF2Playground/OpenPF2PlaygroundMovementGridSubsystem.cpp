@@ -0,0 +1,559 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundMovementGridSubsystem.h"
+
+#include <EngineUtils.h>
+
+#include <Components/PrimitiveComponent.h>
+
+#include <Engine/World.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundMovementGridVolume.h"
+
+void UOpenPF2PlaygroundMovementGridSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	FBox LevelBounds;
+
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Prefer the grid volume placed in the level, if there is one. Volumes in levels that stream in later configure the
+	// grid themselves when they begin play.
+	for (TActorIterator<AOpenPF2PlaygroundMovementGridVolume> VolumeIt(&InWorld); VolumeIt; ++VolumeIt)
+	{
+		VolumeIt->ConfigureMovementGrid();
+		return;
+	}
+
+	if (this->bConfigureFromLevelCollision && !this->IsGridConfigured() && this->GetLevelCollisionBounds(LevelBounds))
+	{
+		this->ConfigureGridFromBounds(LevelBounds, this->DefaultCellSize);
+	}
+}
+
+void UOpenPF2PlaygroundMovementGridSubsystem::ConfigureGrid(const FVector&   InGridOrigin,
+                                                            const float      InCellSize,
+                                                            const FIntPoint& InGridSize)
+{
+	if ((InCellSize <= 0.0f) || (InGridSize.X <= 0) || (InGridSize.Y <= 0))
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT("Movement grid cannot be configured with a cell size of '%f' and dimensions of '%s'."),
+			InCellSize,
+			*(InGridSize.ToString())
+		);
+
+		return;
+	}
+
+	const int32 NumCells = InGridSize.X * InGridSize.Y;
+
+	this->GridOrigin = InGridOrigin;
+	this->CellSize   = InCellSize;
+	this->GridSize   = InGridSize;
+
+	this->CellHeights.Init(InGridOrigin.Z, NumCells);
+	this->bIsFlat = true;
+	this->GridActor.Reset();
+
+	this->BlockedCells.Init(false, NumCells);
+	this->OccupiedCells.Init(false, NumCells);
+	this->FloorlessCells.Init(false, NumCells);
+
+	this->CellFloorComponents.Init(nullptr, NumCells);
+}
+
+void UOpenPF2PlaygroundMovementGridSubsystem::ConfigureGridFromBounds(const FBox& InBounds,
+                                                                      const float  InCellSize,
+                                                                      AActor*      InGridActor)
+{
+	FIntPoint GridDimensions;
+
+	if (!InBounds.IsValid || (InCellSize <= 0.0f))
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT("Movement grid cannot be configured from bounds '%s' with a cell size of '%f'."),
+			*(InBounds.ToString()),
+			InCellSize
+		);
+
+		return;
+	}
+
+	GridDimensions = FIntPoint(
+		FMath::Max(1, FMath::CeilToInt32((InBounds.Max.X - InBounds.Min.X) / InCellSize)),
+		FMath::Max(1, FMath::CeilToInt32((InBounds.Max.Y - InBounds.Min.Y) / InCellSize))
+	);
+
+	this->ConfigureGrid(InBounds.Min, InCellSize, GridDimensions);
+
+	this->GridActor = InGridActor;
+
+	this->SampleCellHeights(InBounds);
+
+	UE_LOG(
+		LogPf2Playground,
+		Verbose,
+		TEXT("Movement grid configured with %s cells of size '%f' (%s)."),
+		*(GridDimensions.ToString()),
+		InCellSize,
+		this->bIsFlat ? TEXT("flat") : TEXT("uneven")
+	);
+}
+
+bool UOpenPF2PlaygroundMovementGridSubsystem::GetCellForLocation(const FVector& InLocation, FIntPoint& OutCell) const
+{
+	OutCell = FIntPoint(INDEX_NONE, INDEX_NONE);
+
+	if (!this->IsGridConfigured())
+	{
+		return false;
+	}
+
+	OutCell = FIntPoint(
+		FMath::FloorToInt32((InLocation.X - this->GridOrigin.X) / this->CellSize),
+		FMath::FloorToInt32((InLocation.Y - this->GridOrigin.Y) / this->CellSize)
+	);
+
+	return this->IsValidCell(OutCell);
+}
+
+bool UOpenPF2PlaygroundMovementGridSubsystem::GetCellForRay(const FVector& InRayOrigin,
+                                                            const FVector& InRayDirection,
+                                                            FIntPoint&     OutCell,
+                                                            FVector&       OutLocation) const
+{
+	bool bHitCell;
+
+	OutCell     = FIntPoint(INDEX_NONE, INDEX_NONE);
+	OutLocation = FVector::ZeroVector;
+
+	if (!this->IsGridConfigured())
+	{
+		return false;
+	}
+
+	if (this->bIsFlat)
+	{
+		bHitCell = this->GetCellForRayOverPlane(InRayOrigin, InRayDirection, OutCell, OutLocation);
+	}
+	else
+	{
+		bHitCell = this->GetCellForRayOverHeights(InRayOrigin, InRayDirection, OutCell, OutLocation);
+	}
+
+	if (bHitCell && this->BlockedCells[this->GetCellIndex(OutCell)])
+	{
+		// Blocked cells cannot be picked, whether the grid is flat or not.
+		OutCell     = FIntPoint(INDEX_NONE, INDEX_NONE);
+		OutLocation = FVector::ZeroVector;
+		bHitCell    = false;
+	}
+
+	return bHitCell;
+}
+
+bool UOpenPF2PlaygroundMovementGridSubsystem::GetHitResultForRay(const FVector& InRayOrigin,
+                                                                 const FVector& InRayDirection,
+                                                                 const float    InMaxDistance,
+                                                                 FHitResult&    OutHitResult) const
+{
+	FIntPoint HitCell;
+	FVector   HitLocation;
+	double    Distance;
+
+	OutHitResult.Reset(1.0f, false);
+
+	OutHitResult.TraceStart = InRayOrigin;
+	OutHitResult.TraceEnd   = InRayOrigin + (InRayDirection * InMaxDistance);
+
+	if (!this->GetCellForRay(InRayOrigin, InRayDirection, HitCell, HitLocation))
+	{
+		return false;
+	}
+
+	Distance = FVector::Dist(InRayOrigin, HitLocation);
+
+	if (Distance > InMaxDistance)
+	{
+		return false;
+	}
+
+	OutHitResult.bBlockingHit = true;
+	OutHitResult.Location     = HitLocation;
+	OutHitResult.ImpactPoint  = HitLocation;
+	OutHitResult.Normal       = FVector::UpVector;
+	OutHitResult.ImpactNormal = FVector::UpVector;
+	OutHitResult.Distance     = Distance;
+	OutHitResult.Time         = (InMaxDistance > 0.0f) ? (Distance / InMaxDistance) : 0.0f;
+
+	if (AActor* Actor = this->GridActor.Get(); Actor != nullptr)
+	{
+		OutHitResult.HitObjectHandle = FActorInstanceHandle(Actor);
+		OutHitResult.Component       = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+	}
+	else if (UPrimitiveComponent* FloorComponent = this->CellFloorComponents[this->GetCellIndex(HitCell)].Get();
+	         FloorComponent != nullptr)
+	{
+		// The grid was configured from level collision, so report the geometry that was traced for the floor of the
+		// cell.
+		OutHitResult.HitObjectHandle = FActorInstanceHandle(FloorComponent->GetOwner());
+		OutHitResult.Component       = FloorComponent;
+	}
+
+	return true;
+}
+
+FVector UOpenPF2PlaygroundMovementGridSubsystem::GetCellCenter(const FIntPoint& InCell) const
+{
+	const float HalfCellSize = this->CellSize / 2.0f;
+
+	return FVector(
+		this->GridOrigin.X + (InCell.X * this->CellSize) + HalfCellSize,
+		this->GridOrigin.Y + (InCell.Y * this->CellSize) + HalfCellSize,
+		this->GetCellHeight(InCell)
+	);
+}
+
+float UOpenPF2PlaygroundMovementGridSubsystem::GetCellHeight(const FIntPoint& InCell) const
+{
+	if (!this->IsValidCell(InCell))
+	{
+		return this->GridOrigin.Z;
+	}
+
+	return this->CellHeights[this->GetCellIndex(InCell)];
+}
+
+void UOpenPF2PlaygroundMovementGridSubsystem::SetCellHeight(const FIntPoint& InCell, const float InHeight)
+{
+	if (this->IsValidCell(InCell))
+	{
+		this->CellHeights[this->GetCellIndex(InCell)] = InHeight;
+
+		if (!FMath::IsNearlyEqual(InHeight, this->GridOrigin.Z))
+		{
+			this->bIsFlat = false;
+		}
+	}
+}
+
+bool UOpenPF2PlaygroundMovementGridSubsystem::IsCellBlocked(const FIntPoint& InCell) const
+{
+	if (!this->IsValidCell(InCell))
+	{
+		return true;
+	}
+
+	return this->BlockedCells[this->GetCellIndex(InCell)];
+}
+
+void UOpenPF2PlaygroundMovementGridSubsystem::SetCellBlocked(const FIntPoint& InCell, const bool bInBlocked)
+{
+	if (this->IsValidCell(InCell))
+	{
+		this->BlockedCells[this->GetCellIndex(InCell)] = bInBlocked;
+	}
+}
+
+bool UOpenPF2PlaygroundMovementGridSubsystem::IsCellOccupied(const FIntPoint& InCell) const
+{
+	if (!this->IsValidCell(InCell))
+	{
+		return false;
+	}
+
+	return this->OccupiedCells[this->GetCellIndex(InCell)];
+}
+
+void UOpenPF2PlaygroundMovementGridSubsystem::SetCellOccupied(const FIntPoint& InCell, const bool bInOccupied)
+{
+	if (this->IsValidCell(InCell))
+	{
+		this->OccupiedCells[this->GetCellIndex(InCell)] = bInOccupied;
+	}
+}
+
+void UOpenPF2PlaygroundMovementGridSubsystem::ClearOccupiedCells()
+{
+	this->OccupiedCells.Init(false, this->OccupiedCells.Num());
+}
+
+bool UOpenPF2PlaygroundMovementGridSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return (WorldType == EWorldType::Game) || (WorldType == EWorldType::PIE);
+}
+
+bool UOpenPF2PlaygroundMovementGridSubsystem::GetLevelCollisionBounds(FBox& OutBounds) const
+{
+	OutBounds.Init();
+
+	for (TActorIterator<AActor> ActorIt(this->GetWorld()); ActorIt; ++ActorIt)
+	{
+		ActorIt->ForEachComponent<UPrimitiveComponent>(
+			false,
+			[&OutBounds](const UPrimitiveComponent* Component)
+			{
+				if (Component->IsRegistered() &&
+				    Component->IsQueryCollisionEnabled() &&
+				    (Component->GetCollisionResponseToChannel(TraceChannel) == ECR_Block))
+				{
+					OutBounds += Component->Bounds.GetBox();
+				}
+			}
+		);
+	}
+
+	return OutBounds.IsValid != 0;
+}
+
+void UOpenPF2PlaygroundMovementGridSubsystem::SampleCellHeights(const FBox& InBounds)
+{
+	const UWorld*         World       = this->GetWorld();
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(MovementGridCellHeight), false);
+	float                 FirstHeight = this->GridOrigin.Z;
+	bool                  bFoundFloor = false;
+
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	this->bIsFlat = true;
+
+	if (AActor* Actor = this->GridActor.Get(); Actor != nullptr)
+	{
+		QueryParams.AddIgnoredActor(Actor);
+	}
+
+	for (int32 CellY = 0; CellY < this->GridSize.Y; ++CellY)
+	{
+		for (int32 CellX = 0; CellX < this->GridSize.X; ++CellX)
+		{
+			const FIntPoint Cell       = FIntPoint(CellX, CellY);
+			const int32     CellIndex  = this->GetCellIndex(Cell);
+			const FVector   CellCenter = this->GetCellCenter(Cell);
+			FHitResult      FloorHit;
+
+			const bool bHitFloor = World->LineTraceSingleByChannel(
+				FloorHit,
+				FVector(CellCenter.X, CellCenter.Y, InBounds.Max.Z),
+				FVector(CellCenter.X, CellCenter.Y, InBounds.Min.Z),
+				TraceChannel,
+				QueryParams
+			);
+
+			if (bHitFloor)
+			{
+				this->CellHeights[CellIndex]         = FloorHit.ImpactPoint.Z;
+				this->CellFloorComponents[CellIndex] = FloorHit.GetComponent();
+
+				if (!bFoundFloor)
+				{
+					FirstHeight = FloorHit.ImpactPoint.Z;
+					bFoundFloor = true;
+				}
+				else if (!FMath::IsNearlyEqual(FloorHit.ImpactPoint.Z, FirstHeight))
+				{
+					this->bIsFlat = false;
+				}
+			}
+			else
+			{
+				// There is nothing to stand on in this cell, so it can neither be entered nor picked.
+				this->BlockedCells[CellIndex]   = true;
+				this->FloorlessCells[CellIndex] = true;
+				this->bIsFlat                   = false;
+			}
+		}
+	}
+
+	if (this->bIsFlat)
+	{
+		// Every cell has a floor at the same height, so rays can be intersected with a single plane at that height.
+		this->GridOrigin.Z = FirstHeight;
+	}
+}
+
+bool UOpenPF2PlaygroundMovementGridSubsystem::GetCellForRayOverPlane(const FVector& InRayOrigin,
+                                                                     const FVector& InRayDirection,
+                                                                     FIntPoint&     OutCell,
+                                                                     FVector&       OutLocation) const
+{
+	double  Distance;
+	FVector PlaneLocation;
+
+	if (FMath::IsNearlyZero(InRayDirection.Z))
+	{
+		// The ray is parallel to the grid, so it can never intersect it.
+		return false;
+	}
+
+	Distance = (this->GridOrigin.Z - InRayOrigin.Z) / InRayDirection.Z;
+
+	if (Distance < 0.0)
+	{
+		// The grid is behind the origin of the ray.
+		return false;
+	}
+
+	PlaneLocation = InRayOrigin + (InRayDirection * Distance);
+
+	if (!this->GetCellForLocation(PlaneLocation, OutCell))
+	{
+		OutCell = FIntPoint(INDEX_NONE, INDEX_NONE);
+		return false;
+	}
+
+	OutLocation = PlaneLocation;
+
+	return true;
+}
+
+bool UOpenPF2PlaygroundMovementGridSubsystem::GetCellForRayOverHeights(const FVector& InRayOrigin,
+                                                                       const FVector& InRayDirection,
+                                                                       FIntPoint&     OutCell,
+                                                                       FVector&       OutLocation) const
+{
+	const FVector2D GridMin = FVector2D(this->GridOrigin.X, this->GridOrigin.Y);
+	const FVector2D GridMax = GridMin + (FVector2D(this->GridSize) * this->CellSize);
+	double          TEnter  = 0.0;
+	double          TExit   = UE_OLD_HALF_WORLD_MAX;
+	FIntPoint       Cell;
+	FIntPoint       Step;
+	FVector2D       TNext;
+	FVector2D       TDelta;
+	FVector         EnterLocation;
+
+	// Clip the ray to the part of it that lies over the grid, one axis at a time.
+	for (int32 Axis = 0; Axis < 2; ++Axis)
+	{
+		const double Origin    = InRayOrigin[Axis];
+		const double Direction = InRayDirection[Axis];
+
+		if (FMath::IsNearlyZero(Direction))
+		{
+			if ((Origin < GridMin[Axis]) || (Origin > GridMax[Axis]))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			double TNear = (GridMin[Axis] - Origin) / Direction;
+			double TFar  = (GridMax[Axis] - Origin) / Direction;
+
+			if (TNear > TFar)
+			{
+				Swap(TNear, TFar);
+			}
+
+			TEnter = FMath::Max(TEnter, TNear);
+			TExit  = FMath::Min(TExit, TFar);
+		}
+	}
+
+	if (TEnter > TExit)
+	{
+		return false;
+	}
+
+	EnterLocation = InRayOrigin + (InRayDirection * TEnter);
+
+	Cell = FIntPoint(
+		FMath::Clamp(
+			FMath::FloorToInt32((EnterLocation.X - GridMin.X) / this->CellSize),
+			0,
+			this->GridSize.X - 1
+		),
+		FMath::Clamp(
+			FMath::FloorToInt32((EnterLocation.Y - GridMin.Y) / this->CellSize),
+			0,
+			this->GridSize.Y - 1
+		)
+	);
+
+	// Set up a walk over the cells that the ray passes over (Amanatides & Woo), tracking the distance along the ray at
+	// which it crosses the next cell boundary on each axis.
+	for (int32 Axis = 0; Axis < 2; ++Axis)
+	{
+		const double Direction = InRayDirection[Axis];
+
+		if (FMath::IsNearlyZero(Direction))
+		{
+			Step[Axis]   = 0;
+			TNext[Axis]  = UE_OLD_HALF_WORLD_MAX;
+			TDelta[Axis] = UE_OLD_HALF_WORLD_MAX;
+		}
+		else
+		{
+			const double NextBoundary =
+				GridMin[Axis] + ((Cell[Axis] + ((Direction > 0.0) ? 1 : 0)) * this->CellSize);
+
+			Step[Axis]   = (Direction > 0.0) ? 1 : -1;
+			TNext[Axis]  = (NextBoundary - InRayOrigin[Axis]) / Direction;
+			TDelta[Axis] = this->CellSize / FMath::Abs(Direction);
+		}
+	}
+
+	for (double TCellEnter = TEnter; this->IsValidCell(Cell) && (TCellEnter <= TExit);)
+	{
+		const int32  CellIndex = this->GetCellIndex(Cell);
+		const double TCellExit = FMath::Min3(TNext.X, TNext.Y, TExit);
+
+		if (!this->FloorlessCells[CellIndex])
+		{
+			const double Height      = this->CellHeights[CellIndex];
+			const double EnterHeight = InRayOrigin.Z + (InRayDirection.Z * TCellEnter);
+
+			if ((EnterHeight < Height) && (TCellEnter > TEnter))
+			{
+				// The ray came from a lower cell and hit the side of the step up into this cell.
+				OutCell     = Cell;
+				OutLocation = InRayOrigin + (InRayDirection * TCellEnter);
+
+				return true;
+			}
+
+			if (!FMath::IsNearlyZero(InRayDirection.Z))
+			{
+				const double TFloor = (Height - InRayOrigin.Z) / InRayDirection.Z;
+
+				if ((TFloor >= TCellEnter) && (TFloor <= TCellExit))
+				{
+					OutCell     = Cell;
+					OutLocation = InRayOrigin + (InRayDirection * TFloor);
+
+					return true;
+				}
+			}
+		}
+
+		TCellEnter = TCellExit;
+
+		if (TCellExit >= TExit)
+		{
+			break;
+		}
+
+		if (TNext.X < TNext.Y)
+		{
+			Cell.X  += Step.X;
+			TNext.X += TDelta.X;
+		}
+		else
+		{
+			Cell.Y  += Step.Y;
+			TNext.Y += TDelta.Y;
+		}
+	}
+
+	return false;
+}
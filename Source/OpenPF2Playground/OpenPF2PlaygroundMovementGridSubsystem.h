@@ -0,0 +1,449 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Engine/EngineTypes.h>
+
+#include <Subsystems/WorldSubsystem.h>
+
+#include "OpenPF2PlaygroundMovementGridSubsystem.generated.h"
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A world subsystem that maps world-space points and rays to cells of the movement grid analytically.
+ *
+ * Because the movement grid is a regular grid of square cells, the cell under any point can be computed directly from
+ * the origin and cell size of the grid. The height of the floor of each cell is sampled once when the grid is
+ * configured, so the cell under a ray is found by walking the cells that the ray passes over and comparing the height
+ * of the ray to the height of each cell, rather than by tracing against grid collision on the MovementGrid trace
+ * channel. The cost of picking a cell is therefore independent of how much collision geometry is in the level. If
+ * every cell has the same height, the ray is intersected with the plane of the grid directly.
+ *
+ * The subsystem also tracks which cells are blocked (e.g., by walls, or because there is no floor under them) and
+ * which cells are occupied (e.g., by combatants), using one bit per cell.
+ *
+ * The grid is configured from level data on every machine, either by an AOpenPF2PlaygroundMovementGridVolume placed
+ * in the level or, if the level has no such volume, from the bounds of the geometry that blocks the MovementGrid trace
+ * channel.
+ */
+UCLASS(Config=Game)
+class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundMovementGridSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// =================================================================================================================
+	// Public Constants
+	// =================================================================================================================
+	/**
+	 * The trace channel against which movement grid collision blocks ("MovementGrid" in DefaultEngine.ini).
+	 */
+	static constexpr ECollisionChannel TraceChannel = ECC_GameTraceChannel1;
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * The location of the corner of the cell at (0, 0), in world space.
+	 *
+	 * The Z coordinate of this location is the height of the plane of the grid.
+	 */
+	FVector GridOrigin;
+
+	/**
+	 * The length of each side of a cell, in centimeters.
+	 */
+	float CellSize;
+
+	/**
+	 * The number of cells along the X axis and Y axis of the grid.
+	 */
+	FIntPoint GridSize;
+
+	/**
+	 * The height of the floor of each cell, in world space, indexed the same way as the bits of each bit array.
+	 */
+	TArray<float> CellHeights;
+
+	/**
+	 * Whether every cell has a floor at the same height (that of the grid origin).
+	 */
+	bool bIsFlat;
+
+	/**
+	 * The actor that configured the grid (if any), reported as the actor that was hit when a ray hits the grid.
+	 */
+	TWeakObjectPtr<AActor> GridActor;
+
+	/**
+	 * The length of each side of a cell (in centimeters) when the grid is configured from level collision.
+	 */
+	UPROPERTY(Config)
+	float DefaultCellSize;
+
+	/**
+	 * Whether to configure the grid from the geometry that blocks the MovementGrid trace channel when the level does
+	 * not contain a movement grid volume.
+	 */
+	UPROPERTY(Config)
+	bool bConfigureFromLevelCollision;
+
+	/**
+	 * One bit per cell, indicating whether each cell is blocked.
+	 */
+	TBitArray<> BlockedCells;
+
+	/**
+	 * One bit per cell, indicating whether each cell is occupied.
+	 */
+	TBitArray<> OccupiedCells;
+
+	/**
+	 * One bit per cell, indicating whether no floor was found for each cell when the heights of cells were sampled.
+	 *
+	 * Rays pass through cells without a floor, the same as they would pass through a gap in grid collision.
+	 */
+	TBitArray<> FloorlessCells;
+
+	/**
+	 * The geometry that was traced for the floor of each cell, when the heights of cells were sampled.
+	 *
+	 * This is reported as the component that was hit when a ray hits a grid that was configured from level collision.
+	 */
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> CellFloorComponents;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundMovementGridSubsystem() :
+		GridOrigin(FVector::ZeroVector),
+		CellSize(0.0f),
+		GridSize(FIntPoint::ZeroValue),
+		bIsFlat(true),
+		DefaultCellSize(152.4f),
+		bConfigureFromLevelCollision(true)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Methods - UWorldSubsystem Overrides
+	// =================================================================================================================
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Sets the placement and dimensions of the movement grid.
+	 *
+	 * All cells are reset to being neither blocked nor occupied, and to having the height of the grid origin.
+	 *
+	 * @param InGridOrigin
+	 *	The location of the corner of the cell at (0, 0), in world space. The Z coordinate of this location is the
+	 *	height of the plane of the grid.
+	 * @param InCellSize
+	 *	The length of each side of a cell, in centimeters. Must be greater than zero.
+	 * @param InGridSize
+	 *	The number of cells along the X axis and Y axis of the grid. Both components must be greater than zero.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Movement Grid")
+	void ConfigureGrid(const FVector& InGridOrigin, const float InCellSize, const FIntPoint& InGridSize);
+
+	/**
+	 * Sets the placement and dimensions of the movement grid to cover a box, and samples the height of each cell.
+	 *
+	 * The height of each cell is the height of the highest geometry that blocks the MovementGrid trace channel at the
+	 * center of the cell, within the box. Cells without any such geometry are marked as blocked.
+	 *
+	 * @param InBounds
+	 *	The box, in world space, that the grid is to cover.
+	 * @param InCellSize
+	 *	The length of each side of a cell, in centimeters. Must be greater than zero.
+	 * @param InGridActor
+	 *	The actor that is configuring the grid. Can be nullptr.
+	 */
+	void ConfigureGridFromBounds(const FBox& InBounds, const float InCellSize, AActor* InGridActor = nullptr);
+
+	/**
+	 * Gets the actor that configured the grid.
+	 *
+	 * @return
+	 *	The actor that configured the grid; or, nullptr if the grid was configured from level collision, through
+	 *	ConfigureGrid(), or not at all.
+	 */
+	FORCEINLINE AActor* GetGridActor() const
+	{
+		return this->GridActor.Get();
+	}
+
+	/**
+	 * Determines whether the placement and dimensions of the movement grid have been configured.
+	 *
+	 * @return
+	 *	true if the grid has been configured; or, false if it has not.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Movement Grid")
+	bool IsGridConfigured() const
+	{
+		return (this->CellSize > 0.0f) && (this->GridSize.X > 0) && (this->GridSize.Y > 0);
+	}
+
+	/**
+	 * Determines whether the given cell coordinate falls within the bounds of the grid.
+	 *
+	 * @param InCell
+	 *	The coordinate of the cell.
+	 *
+	 * @return
+	 *	true if the cell is part of the grid; or, false if it is not.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Movement Grid")
+	bool IsValidCell(const FIntPoint& InCell) const
+	{
+		return (InCell.X >= 0) && (InCell.Y >= 0) && (InCell.X < this->GridSize.X) && (InCell.Y < this->GridSize.Y);
+	}
+
+	/**
+	 * Gets the cell of the grid that contains the given location, ignoring the height of the location.
+	 *
+	 * @param InLocation
+	 *	The location, in world space.
+	 * @param OutCell
+	 *	The coordinate of the cell that contains the location; or, (-1, -1) if the grid has not been configured.
+	 *
+	 * @return
+	 *	true if the location is within the bounds of the grid; or, false if it is not or the grid has not been
+	 *	configured.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Movement Grid")
+	bool GetCellForLocation(const FVector& InLocation, FIntPoint& OutCell) const;
+
+	/**
+	 * Gets the cell of the grid that is intersected by the given ray.
+	 *
+	 * @param InRayOrigin
+	 *	The origin of the ray, in world space.
+	 * @param InRayDirection
+	 *	The direction of the ray, in world space.
+	 * @param OutCell
+	 *	The coordinate of the cell that the ray intersects; or, (-1, -1) if the ray does not intersect the grid.
+	 * @param OutLocation
+	 *	The location at which the ray intersects the floor of the cell; or, the zero vector if the ray does not
+	 *	intersect the grid.
+	 *
+	 * @return
+	 *	true if the ray intersects the floor of a cell of the grid; or, false if the ray misses every cell, the cell
+	 *	that it intersects is blocked, or the grid has not been configured.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Movement Grid")
+	bool GetCellForRay(const FVector& InRayOrigin,
+	                   const FVector& InRayDirection,
+	                   FIntPoint&     OutCell,
+	                   FVector&       OutLocation) const;
+
+	/**
+	 * Gets the hit result of a ray against the grid, as if it had been traced against grid collision.
+	 *
+	 * @param InRayOrigin
+	 *	The origin of the ray, in world space.
+	 * @param InRayDirection
+	 *	The direction of the ray, in world space. Must be normalized.
+	 * @param InMaxDistance
+	 *	How far along the ray to look for the grid.
+	 * @param OutHitResult
+	 *	The hit result. If the ray does not hit the grid within the maximum distance, the result is reset.
+	 *
+	 * @return
+	 *	true if the ray hits the floor of a cell of the grid within the maximum distance; or, false otherwise.
+	 */
+	bool GetHitResultForRay(const FVector& InRayOrigin,
+	                        const FVector& InRayDirection,
+	                        const float    InMaxDistance,
+	                        FHitResult&    OutHitResult) const;
+
+	/**
+	 * Gets the location of the center of the given cell, in world space.
+	 *
+	 * @param InCell
+	 *	The coordinate of the cell.
+	 *
+	 * @return
+	 *	The location of the center of the cell, on the floor of the cell.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Movement Grid")
+	FVector GetCellCenter(const FIntPoint& InCell) const;
+
+	/**
+	 * Gets the height of the floor of the given cell.
+	 *
+	 * @param InCell
+	 *	The coordinate of the cell.
+	 *
+	 * @return
+	 *	The height of the floor of the cell, in world space; or, the height of the grid origin if the cell is outside
+	 *	the bounds of the grid.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Movement Grid")
+	float GetCellHeight(const FIntPoint& InCell) const;
+
+	/**
+	 * Sets the height of the floor of the given cell.
+	 *
+	 * This has no effect if the cell is outside the bounds of the grid.
+	 *
+	 * @param InCell
+	 *	The coordinate of the cell.
+	 * @param InHeight
+	 *	The height of the floor of the cell, in world space.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Movement Grid")
+	void SetCellHeight(const FIntPoint& InCell, const float InHeight);
+
+	/**
+	 * Determines whether the given cell is blocked.
+	 *
+	 * @param InCell
+	 *	The coordinate of the cell.
+	 *
+	 * @return
+	 *	true if the cell is blocked or outside the bounds of the grid; or, false if it is not blocked.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Movement Grid")
+	bool IsCellBlocked(const FIntPoint& InCell) const;
+
+	/**
+	 * Sets whether the given cell is blocked.
+	 *
+	 * This has no effect if the cell is outside the bounds of the grid.
+	 *
+	 * @param InCell
+	 *	The coordinate of the cell.
+	 * @param bInBlocked
+	 *	Whether the cell is blocked.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Movement Grid")
+	void SetCellBlocked(const FIntPoint& InCell, const bool bInBlocked);
+
+	/**
+	 * Determines whether the given cell is occupied.
+	 *
+	 * @param InCell
+	 *	The coordinate of the cell.
+	 *
+	 * @return
+	 *	true if the cell is occupied; or, false if it is not occupied or it is outside the bounds of the grid.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Movement Grid")
+	bool IsCellOccupied(const FIntPoint& InCell) const;
+
+	/**
+	 * Sets whether the given cell is occupied.
+	 *
+	 * This has no effect if the cell is outside the bounds of the grid.
+	 *
+	 * @param InCell
+	 *	The coordinate of the cell.
+	 * @param bInOccupied
+	 *	Whether the cell is occupied.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Movement Grid")
+	void SetCellOccupied(const FIntPoint& InCell, const bool bInOccupied);
+
+	/**
+	 * Marks all cells of the grid as being unoccupied.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Movement Grid")
+	void ClearOccupiedCells();
+
+protected:
+	// =================================================================================================================
+	// Protected Methods - UWorldSubsystem Overrides
+	// =================================================================================================================
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Gets the bounds of all geometry in the level that blocks the MovementGrid trace channel.
+	 *
+	 * @param OutBounds
+	 *	The box that contains all of the geometry.
+	 *
+	 * @return
+	 *	true if the level contains any such geometry; or, false if it does not.
+	 */
+	bool GetLevelCollisionBounds(FBox& OutBounds) const;
+
+	/**
+	 * Samples the height of the floor of every cell by tracing down through a box.
+	 *
+	 * @param InBounds
+	 *	The box through which to trace.
+	 */
+	void SampleCellHeights(const FBox& InBounds);
+
+	/**
+	 * Finds the cell whose floor is intersected by a ray, when every cell has a floor at the height of the grid origin.
+	 *
+	 * @param InRayOrigin
+	 *	The origin of the ray, in world space.
+	 * @param InRayDirection
+	 *	The direction of the ray, in world space.
+	 * @param OutCell
+	 *	The coordinate of the cell that the ray intersects.
+	 * @param OutLocation
+	 *	The location at which the ray intersects the floor of the cell.
+	 *
+	 * @return
+	 *	true if the ray intersects the floor of a cell; or, false otherwise.
+	 */
+	bool GetCellForRayOverPlane(const FVector& InRayOrigin,
+	                            const FVector& InRayDirection,
+	                            FIntPoint&     OutCell,
+	                            FVector&       OutLocation) const;
+
+	/**
+	 * Finds the first cell whose floor is intersected by a ray, by walking the cells that the ray passes over.
+	 *
+	 * @param InRayOrigin
+	 *	The origin of the ray, in world space.
+	 * @param InRayDirection
+	 *	The direction of the ray, in world space.
+	 * @param OutCell
+	 *	The coordinate of the cell that the ray intersects.
+	 * @param OutLocation
+	 *	The location at which the ray intersects the floor of the cell.
+	 *
+	 * @return
+	 *	true if the ray intersects the floor of a cell; or, false otherwise.
+	 */
+	bool GetCellForRayOverHeights(const FVector& InRayOrigin,
+	                              const FVector& InRayDirection,
+	                              FIntPoint&     OutCell,
+	                              FVector&       OutLocation) const;
+
+	/**
+	 * Gets the index of the given cell in the bit arrays and the array of cell heights.
+	 *
+	 * @param InCell
+	 *	The coordinate of the cell. Must be within the bounds of the grid.
+	 *
+	 * @return
+	 *	The index of the cell.
+	 */
+	FORCEINLINE int32 GetCellIndex(const FIntPoint& InCell) const
+	{
+		return (InCell.Y * this->GridSize.X) + InCell.X;
+	}
+};
@@ -0,0 +1,53 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundMovementGridVolume.h"
+
+#include <Components/BrushComponent.h>
+
+#include <Engine/World.h>
+
+#include "OpenPF2PlaygroundMovementGridSubsystem.h"
+
+AOpenPF2PlaygroundMovementGridVolume::AOpenPF2PlaygroundMovementGridVolume()
+{
+	UBrushComponent* Brush = this->GetBrushComponent();
+
+	// This volume only describes where the grid is; it must never block traces or movement.
+	Brush->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Brush->SetCollisionResponseToAllChannels(ECR_Ignore);
+	Brush->SetGenerateOverlapEvents(false);
+
+	this->PrimaryActorTick.bCanEverTick = false;
+
+	// One 5-foot square.
+	this->CellSize = 152.4f;
+}
+
+void AOpenPF2PlaygroundMovementGridVolume::BeginPlay()
+{
+	const UOpenPF2PlaygroundMovementGridSubsystem* GridSubsystem =
+		UWorld::GetSubsystem<UOpenPF2PlaygroundMovementGridSubsystem>(this->GetWorld());
+
+	Super::BeginPlay();
+
+	// The subsystem configures the grid from volumes in the persistent level before actors begin play, so this only
+	// has work to do for volumes in levels that stream in later.
+	if ((GridSubsystem != nullptr) && (GridSubsystem->GetGridActor() != this))
+	{
+		this->ConfigureMovementGrid();
+	}
+}
+
+void AOpenPF2PlaygroundMovementGridVolume::ConfigureMovementGrid()
+{
+	UOpenPF2PlaygroundMovementGridSubsystem* GridSubsystem =
+		UWorld::GetSubsystem<UOpenPF2PlaygroundMovementGridSubsystem>(this->GetWorld());
+
+	if (GridSubsystem != nullptr)
+	{
+		GridSubsystem->ConfigureGridFromBounds(this->GetBrushComponent()->Bounds.GetBox(), this->CellSize, this);
+	}
+}
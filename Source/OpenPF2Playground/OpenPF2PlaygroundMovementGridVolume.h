@@ -0,0 +1,59 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <GameFramework/Volume.h>
+
+#include "OpenPF2PlaygroundMovementGridVolume.generated.h"
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A volume that marks the part of a level covered by the movement grid.
+ *
+ * When play begins, on the server and on every client, the movement grid subsystem is configured to cover the bounds
+ * of this volume and the height of the floor of each cell is sampled from the geometry inside it that blocks the
+ * MovementGrid trace channel. A level should contain at most one of these volumes.
+ */
+UCLASS()
+// ReSharper disable once CppClassCanBeFinal
+class OPENPF2PLAYGROUND_API AOpenPF2PlaygroundMovementGridVolume : public AVolume
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * The length of each side of a cell of the grid, in centimeters.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="OpenPF2 Playground|Movement Grid", meta=(ClampMin="1.0"))
+	float CellSize;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit AOpenPF2PlaygroundMovementGridVolume();
+
+	// =================================================================================================================
+	// Public Methods - AActor Overrides
+	// =================================================================================================================
+	virtual void BeginPlay() override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Configures the movement grid of the world to cover this volume.
+	 */
+	void ConfigureMovementGrid();
+};
@@ -0,0 +1,187 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundNetBotSubsystem.h"
+
+#include <AbilitySystemComponent.h>
+#include <AbilitySystemInterface.h>
+
+#include <Engine/World.h>
+
+#include <GameFramework/GameStateBase.h>
+
+#include <Misc/CommandLine.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundNetStatsSubsystem.h"
+#include "OpenPF2PlaygroundPlayerControllerBase.h"
+#include "PF2GameStateInterface.h"
+
+bool UOpenPF2PlaygroundNetBotSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return Super::ShouldCreateSubsystem(Outer) && FParse::Param(FCommandLine::Get(), TEXT("Pf2NetBot"));
+}
+
+void UOpenPF2PlaygroundNetBotSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	const TCHAR* CommandLine = FCommandLine::Get();
+	int32        Seed        = FPlatformProcess::GetCurrentProcessId();
+
+	Collection.InitializeDependency<UOpenPF2PlaygroundNetStatsSubsystem>();
+
+	Super::Initialize(Collection);
+
+	this->SessionDuration = this->DefaultSessionDuration;
+
+	FParse::Value(CommandLine, TEXT("Pf2NetBotDuration="), this->SessionDuration);
+	FParse::Value(CommandLine, TEXT("Pf2NetBotSeed="), Seed);
+
+	this->RandomStream.Initialize(Seed);
+
+	UE_LOG(
+		LogPf2Playground,
+		Display,
+		TEXT("Network load test bot enabled for %.0f second(s) (seed %d)."),
+		this->SessionDuration,
+		Seed
+	);
+}
+
+void UOpenPF2PlaygroundNetBotSubsystem::Tick(const float DeltaTime)
+{
+	UWorld*                                 World = this->GetWorld();
+	AOpenPF2PlaygroundPlayerControllerBase* PlayerController;
+
+	Super::Tick(DeltaTime);
+
+	if (this->bHasFinished || (World->GetNetMode() != NM_Client))
+	{
+		return;
+	}
+
+	PlayerController = Cast<AOpenPF2PlaygroundPlayerControllerBase>(World->GetFirstPlayerController());
+
+	if (PlayerController == nullptr)
+	{
+		// Still connecting to the server.
+		return;
+	}
+
+	if (this->SessionSeconds < 0.0)
+	{
+		this->SessionSeconds       = 0.0;
+		this->SecondsUntilNextStep = this->StepInterval;
+	}
+
+	this->SessionSeconds       += DeltaTime;
+	this->SecondsUntilNextStep -= DeltaTime;
+
+	if (this->SessionSeconds >= this->SessionDuration)
+	{
+		this->FinishSession();
+	}
+	else if (this->SecondsUntilNextStep <= 0.0f)
+	{
+		this->SecondsUntilNextStep += this->StepInterval;
+
+		this->TakeStep(PlayerController);
+	}
+}
+
+TStatId UOpenPF2PlaygroundNetBotSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UOpenPF2PlaygroundNetBotSubsystem, STATGROUP_Tickables);
+}
+
+bool UOpenPF2PlaygroundNetBotSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game;
+}
+
+void UOpenPF2PlaygroundNetBotSubsystem::TakeStep(AOpenPF2PlaygroundPlayerControllerBase* PlayerController)
+{
+	++this->NumSteps;
+
+	if ((this->NumSteps % FMath::Max(this->StepsPerModeOfPlayTransition, 1)) == 0)
+	{
+		this->RequestNextModeOfPlay(PlayerController);
+	}
+	else
+	{
+		this->ActivateRandomAbility(PlayerController);
+	}
+}
+
+void UOpenPF2PlaygroundNetBotSubsystem::RequestNextModeOfPlay(AOpenPF2PlaygroundPlayerControllerBase* PlayerController)
+{
+	const IPF2GameStateInterface* GameStateIntf = Cast<IPF2GameStateInterface>(this->GetWorld()->GetGameState());
+	const EPF2ModeOfPlayType      ModeOfPlay    =
+		(GameStateIntf != nullptr) ? GameStateIntf->GetModeOfPlay() : EPF2ModeOfPlayType::None;
+
+	++this->NumModeOfPlayRequests;
+
+	if (ModeOfPlay == EPF2ModeOfPlayType::Encounter)
+	{
+		PlayerController->Server_RequestModeOfPlayForLoadTest(EPF2ModeOfPlayType::Exploration);
+	}
+	else
+	{
+		PlayerController->Server_RequestModeOfPlayForLoadTest(EPF2ModeOfPlayType::Encounter);
+	}
+}
+
+void UOpenPF2PlaygroundNetBotSubsystem::ActivateRandomAbility(
+	const AOpenPF2PlaygroundPlayerControllerBase* PlayerController)
+{
+	const IAbilitySystemInterface* AscIntf = Cast<IAbilitySystemInterface>(PlayerController->GetPawn());
+	UAbilitySystemComponent*       Asc     = (AscIntf != nullptr) ? AscIntf->GetAbilitySystemComponent() : nullptr;
+	int32                          NumAbilities;
+
+	if (Asc == nullptr)
+	{
+		// The bot does not possess a character right now (e.g., during Encounter mode).
+		return;
+	}
+
+	NumAbilities = Asc->GetActivatableAbilities().Num();
+
+	if (NumAbilities == 0)
+	{
+		return;
+	}
+
+	++this->NumAbilityActivations;
+
+	// Activating locally sends the activation to the server, just as it would for a player pressing an input.
+	Asc->TryActivateAbility(
+		Asc->GetActivatableAbilities()[this->RandomStream.RandHelper(NumAbilities)].Handle
+	);
+}
+
+void UOpenPF2PlaygroundNetBotSubsystem::FinishSession()
+{
+	UOpenPF2PlaygroundNetStatsSubsystem* NetStats =
+		UWorld::GetSubsystem<UOpenPF2PlaygroundNetStatsSubsystem>(this->GetWorld());
+
+	this->bHasFinished = true;
+
+	UE_LOG(
+		LogPf2Playground,
+		Display,
+		TEXT("Network load test bot finished after %d step(s): %d ability activation(s) and %d mode of play request(s)."),
+		this->NumSteps,
+		this->NumAbilityActivations,
+		this->NumModeOfPlayRequests
+	);
+
+	if ((NetStats != nullptr) && !NetStats->WriteReport())
+	{
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+	}
+	else
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
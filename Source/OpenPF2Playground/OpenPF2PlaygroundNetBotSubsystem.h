@@ -0,0 +1,173 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Subsystems/WorldSubsystem.h>
+
+#include "OpenPF2PlaygroundNetBotSubsystem.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class AOpenPF2PlaygroundPlayerControllerBase;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A world subsystem that plays a scripted session as a headless bot client of a network load test.
+ *
+ * This is only created on clients launched with "-Pf2NetBot" (see UOpenPF2PlaygroundNetLoadTestCommandlet):
+ *
+ * OpenPF2Playground 127.0.0.1:<Port> -game -nullrhi -nosound -unattended -Pf2NetBot
+ *     [-Pf2NetBotDuration=<Seconds>] [-Pf2NetBotSeed=<Seed>] [-Pf2NetReport=<JSON Path>]
+ *
+ * Once the bot has a player controller, it takes one step every StepInterval seconds. Every
+ * StepsPerModeOfPlayTransition steps, it asks the server to switch between Exploration and Encounter mode; every other
+ * step, it tries to activate a random ability of the character it possesses (if any). After the duration of the
+ * session has elapsed, the bot writes its network stats report and exits, which disconnects it from the server.
+ */
+UCLASS(Config=Game)
+class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundNetBotSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * How long (in seconds) a bot plays before disconnecting, unless overridden on the command line.
+	 */
+	UPROPERTY(Config)
+	float DefaultSessionDuration;
+
+	/**
+	 * How long (in seconds) the bot waits between steps.
+	 */
+	UPROPERTY(Config)
+	float StepInterval;
+
+	/**
+	 * How many steps the bot takes between each request for a change in mode of play.
+	 */
+	UPROPERTY(Config)
+	int32 StepsPerModeOfPlayTransition;
+
+	/**
+	 * How long (in seconds) the bot plays before disconnecting.
+	 */
+	float SessionDuration;
+
+	/**
+	 * The source of random numbers for choosing abilities, seeded so that each bot can be replayed.
+	 */
+	FRandomStream RandomStream;
+
+	/**
+	 * The amount of game time (in seconds) since the bot first had a player controller; or, a negative number if it has
+	 * not had one yet.
+	 */
+	double SessionSeconds;
+
+	/**
+	 * The amount of game time (in seconds) until the next step.
+	 */
+	float SecondsUntilNextStep;
+
+	/**
+	 * The number of steps that the bot has taken.
+	 */
+	int32 NumSteps;
+
+	/**
+	 * The number of abilities that the bot has tried to activate.
+	 */
+	int32 NumAbilityActivations;
+
+	/**
+	 * The number of changes in mode of play that the bot has requested.
+	 */
+	int32 NumModeOfPlayRequests;
+
+	/**
+	 * Whether the session has finished.
+	 */
+	bool bHasFinished;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundNetBotSubsystem() :
+		DefaultSessionDuration(60.0f),
+		StepInterval(0.5f),
+		StepsPerModeOfPlayTransition(8),
+		SessionDuration(0.0f),
+		SessionSeconds(-1.0),
+		SecondsUntilNextStep(0.0f),
+		NumSteps(0),
+		NumAbilityActivations(0),
+		NumModeOfPlayRequests(0),
+		bHasFinished(false)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Methods - USubsystem Overrides
+	// =================================================================================================================
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// =================================================================================================================
+	// Public Methods - FTickableGameObject Overrides
+	// =================================================================================================================
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+	// =================================================================================================================
+	// Protected Methods - UWorldSubsystem Overrides
+	// =================================================================================================================
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Takes the next step of the scripted session.
+	 *
+	 * @param PlayerController
+	 *	The player controller of the bot.
+	 */
+	void TakeStep(AOpenPF2PlaygroundPlayerControllerBase* PlayerController);
+
+	/**
+	 * Asks the server to switch to whichever mode of play the game is not currently in.
+	 *
+	 * @param PlayerController
+	 *	The player controller of the bot.
+	 */
+	void RequestNextModeOfPlay(AOpenPF2PlaygroundPlayerControllerBase* PlayerController);
+
+	/**
+	 * Tries to activate a random ability of the character possessed by the bot.
+	 *
+	 * @param PlayerController
+	 *	The player controller of the bot.
+	 */
+	void ActivateRandomAbility(const AOpenPF2PlaygroundPlayerControllerBase* PlayerController);
+
+	/**
+	 * Writes the network stats report of the bot and asks the engine to exit.
+	 */
+	void FinishSession();
+};
@@ -0,0 +1,328 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundNetLoadTestCommandlet.h"
+
+#include <Dom/JsonObject.h>
+
+#include <HAL/FileManager.h>
+#include <HAL/PlatformProcess.h>
+
+#include <Misc/DateTime.h>
+#include <Misc/FileHelper.h>
+#include <Misc/Paths.h>
+
+#include <Serialization/JsonReader.h>
+#include <Serialization/JsonSerializer.h>
+#include <Serialization/JsonWriter.h>
+
+#include "OpenPF2Playground.h"
+
+UOpenPF2PlaygroundNetLoadTestCommandlet::UOpenPF2PlaygroundNetLoadTestCommandlet()
+{
+	this->IsClient       = false;
+	this->IsServer       = false;
+	this->IsEditor       = true;
+	this->LogToConsole   = true;
+	this->ShowErrorCount = true;
+
+	this->DefaultNumBots       = 8;
+	this->DefaultDuration      = 60.0f;
+	this->DefaultMap           = TEXT("/Game/OpenPF2Playground/Maps/Lvl_SoulCave_PF2");
+	this->DefaultPort          = 7777;
+	this->ServerStartupTimeout = 120.0f;
+	this->ProcessTimeout       = 120.0f;
+}
+
+int32 UOpenPF2PlaygroundNetLoadTestCommandlet::Main(const FString& Params)
+{
+	int32                           NumBots        = this->DefaultNumBots,
+	                                Port           = this->DefaultPort;
+	float                           Duration       = this->DefaultDuration;
+	FString                         Map            = this->DefaultMap,
+	                                Executable     = FPlatformProcess::ExecutablePath(),
+	                                OutputDirectory,
+	                                ServerArguments;
+	const bool                      bListenServer  = FParse::Param(*Params, TEXT("Listen"));
+	const FString                   ProjectPath    = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+	FString                         ReadyFilePath;
+	FProcHandle                     ServerHandle;
+	TArray<FProcHandle>             BotHandles;
+	double                          Deadline;
+	bool                            bSucceeded     = true;
+	const TSharedRef<FJsonObject>   Summary        = MakeShared<FJsonObject>();
+	const TSharedRef<FJsonObject>   Parameters     = MakeShared<FJsonObject>();
+	TSharedPtr<FJsonObject>         ServerReport;
+	TArray<TSharedPtr<FJsonValue>>  BotReports;
+	FString                         SummaryJson;
+
+	FParse::Value(*Params, TEXT("Bots="), NumBots);
+	FParse::Value(*Params, TEXT("Duration="), Duration);
+	FParse::Value(*Params, TEXT("Map="), Map);
+	FParse::Value(*Params, TEXT("Port="), Port);
+	FParse::Value(*Params, TEXT("Executable="), Executable);
+
+	if (!FParse::Value(*Params, TEXT("Output="), OutputDirectory))
+	{
+		OutputDirectory = FPaths::Combine(
+			FPaths::ProjectSavedDir(),
+			TEXT("NetLoadTests"),
+			FDateTime::UtcNow().ToString()
+		);
+	}
+
+	OutputDirectory = FPaths::ConvertRelativePathToFull(OutputDirectory);
+	ReadyFilePath   = FPaths::Combine(OutputDirectory, TEXT("Server.ready"));
+
+	if ((NumBots < 1) || (Duration <= 0.0f))
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT("Network load test requires at least 1 bot and a positive duration (got %d and %f)."),
+			NumBots,
+			Duration
+		);
+
+		return 1;
+	}
+
+	// The server gives up on its bots (and writes its report anyway) once every bot should have finished.
+	ServerArguments = FString::Printf(
+		TEXT("\"%s\" %s%s -Port=%d %s -unattended -Pf2NetLoadTest -Pf2NetLoadTestTimeout=%f -Pf2NetReport=\"%s\" ")
+		TEXT("-Pf2NetReadyFile=\"%s\" -trace=net -NetTrace=1 -tracefile=\"%s\""),
+		*ProjectPath,
+		*Map,
+		bListenServer ? TEXT("?listen") : TEXT(""),
+		Port,
+		bListenServer ? TEXT("-game -nullrhi -nosound") : TEXT("-server"),
+		this->ServerStartupTimeout + Duration + (this->ProcessTimeout * 2.0f),
+		*FPaths::Combine(OutputDirectory, TEXT("Server.json")),
+		*ReadyFilePath,
+		*FPaths::Combine(OutputDirectory, TEXT("Server.utrace"))
+	);
+
+	ServerHandle = this->LaunchProcess(Executable, TEXT("Server"), ServerArguments, OutputDirectory);
+
+	if (!ServerHandle.IsValid())
+	{
+		return 1;
+	}
+
+	// Clear out the signal of any earlier run that wrote to the same directory.
+	IFileManager::Get().Delete(*ReadyFilePath, false, true, true);
+
+	if (!this->WaitForServerReady(ServerHandle, ReadyFilePath))
+	{
+		return 1;
+	}
+
+	for (int32 BotIndex = 0; BotIndex < NumBots; ++BotIndex)
+	{
+		const FString BotName      = FString::Printf(TEXT("Bot-%d"), BotIndex);
+		const FString BotArguments = FString::Printf(
+			TEXT("\"%s\" 127.0.0.1:%d -game -nullrhi -nosound -unattended -Pf2NetBot -Pf2NetBotDuration=%f ")
+			TEXT("-Pf2NetBotSeed=%d -Pf2NetReport=\"%s\""),
+			*ProjectPath,
+			Port,
+			Duration,
+			BotIndex + 1,
+			*FPaths::Combine(OutputDirectory, BotName + TEXT(".json"))
+		);
+
+		FProcHandle BotHandle = this->LaunchProcess(Executable, BotName, BotArguments, OutputDirectory);
+
+		if (BotHandle.IsValid())
+		{
+			BotHandles.Add(BotHandle);
+		}
+		else
+		{
+			bSucceeded = false;
+		}
+	}
+
+	Deadline = FPlatformTime::Seconds() + Duration + this->ProcessTimeout;
+
+	for (int32 BotIndex = 0; BotIndex < BotHandles.Num(); ++BotIndex)
+	{
+		bSucceeded &= this->WaitForProcess(BotHandles[BotIndex], FString::Printf(TEXT("Bot-%d"), BotIndex), Deadline);
+	}
+
+	// The server exits on its own once the last bot has disconnected.
+	bSucceeded &= this->WaitForProcess(ServerHandle, TEXT("Server"), Deadline + this->ProcessTimeout);
+
+	ServerReport = LoadReport(FPaths::Combine(OutputDirectory, TEXT("Server.json")));
+
+	if (!ServerReport.IsValid())
+	{
+		bSucceeded = false;
+	}
+
+	for (int32 BotIndex = 0; BotIndex < NumBots; ++BotIndex)
+	{
+		const TSharedPtr<FJsonObject> BotReport =
+			LoadReport(FPaths::Combine(OutputDirectory, FString::Printf(TEXT("Bot-%d.json"), BotIndex)));
+
+		if (BotReport.IsValid())
+		{
+			BotReports.Add(MakeShared<FJsonValueObject>(BotReport));
+		}
+		else
+		{
+			bSucceeded = false;
+		}
+	}
+
+	Parameters->SetNumberField(TEXT("Bots"), NumBots);
+	Parameters->SetNumberField(TEXT("DurationSeconds"), Duration);
+	Parameters->SetStringField(TEXT("Map"), Map);
+	Parameters->SetBoolField(TEXT("ListenServer"), bListenServer);
+
+	Summary->SetBoolField(TEXT("Succeeded"), bSucceeded);
+	Summary->SetObjectField(TEXT("Parameters"), Parameters);
+
+	if (ServerReport.IsValid())
+	{
+		Summary->SetObjectField(TEXT("Server"), ServerReport);
+	}
+
+	Summary->SetArrayField(TEXT("Bots"), BotReports);
+	Summary->SetStringField(TEXT("NetTrace"), FPaths::Combine(OutputDirectory, TEXT("Server.utrace")));
+
+	FJsonSerializer::Serialize(Summary, TJsonWriterFactory<>::Create(&SummaryJson));
+
+	if (!FFileHelper::SaveStringToFile(SummaryJson, *FPaths::Combine(OutputDirectory, TEXT("Summary.json"))))
+	{
+		UE_LOG(LogPf2Playground, Error, TEXT("Failed to write network load test summary to '%s'."), *OutputDirectory);
+		return 1;
+	}
+
+	UE_LOG(
+		LogPf2Playground,
+		Display,
+		TEXT("Network load test %s. Results written to '%s'."),
+		bSucceeded ? TEXT("succeeded") : TEXT("failed"),
+		*OutputDirectory
+	);
+
+	return bSucceeded ? 0 : 1;
+}
+
+FProcHandle UOpenPF2PlaygroundNetLoadTestCommandlet::LaunchProcess(const FString& Executable,
+                                                                   const FString& ProcessName,
+                                                                   const FString& Arguments,
+                                                                   const FString& OutputDirectory) const
+{
+	const FString FullArguments = FString::Printf(
+		TEXT("%s -abslog=\"%s\""),
+		*Arguments,
+		*FPaths::Combine(OutputDirectory, ProcessName + TEXT(".log"))
+	);
+
+	FProcHandle ProcessHandle =
+		FPlatformProcess::CreateProc(*Executable, *FullArguments, false, true, true, nullptr, 0, nullptr, nullptr);
+
+	if (ProcessHandle.IsValid())
+	{
+		UE_LOG(LogPf2Playground, Display, TEXT("Launched %s: %s %s"), *ProcessName, *Executable, *FullArguments);
+	}
+	else
+	{
+		UE_LOG(LogPf2Playground, Error, TEXT("Failed to launch %s: %s %s"), *ProcessName, *Executable, *FullArguments);
+	}
+
+	return ProcessHandle;
+}
+
+bool UOpenPF2PlaygroundNetLoadTestCommandlet::WaitForProcess(FProcHandle&   ProcessHandle,
+                                                             const FString& ProcessName,
+                                                             const double   Deadline) const
+{
+	int32 ReturnCode = 0;
+
+	while (FPlatformProcess::IsProcRunning(ProcessHandle))
+	{
+		if (FPlatformTime::Seconds() > Deadline)
+		{
+			UE_LOG(LogPf2Playground, Error, TEXT("%s did not finish in time and has been killed."), *ProcessName);
+
+			FPlatformProcess::TerminateProc(ProcessHandle, true);
+			FPlatformProcess::CloseProc(ProcessHandle);
+
+			return false;
+		}
+
+		FPlatformProcess::Sleep(0.5f);
+	}
+
+	FPlatformProcess::GetProcReturnCode(ProcessHandle, &ReturnCode);
+	FPlatformProcess::CloseProc(ProcessHandle);
+
+	if (ReturnCode != 0)
+	{
+		UE_LOG(LogPf2Playground, Error, TEXT("%s exited with code %d."), *ProcessName, ReturnCode);
+		return false;
+	}
+
+	return true;
+}
+
+bool UOpenPF2PlaygroundNetLoadTestCommandlet::WaitForServerReady(FProcHandle&   ServerHandle,
+                                                                 const FString& ReadyFilePath) const
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	while (!FPaths::FileExists(ReadyFilePath))
+	{
+		if (!FPlatformProcess::IsProcRunning(ServerHandle))
+		{
+			UE_LOG(LogPf2Playground, Error, TEXT("Server exited before any bots could connect."));
+
+			FPlatformProcess::CloseProc(ServerHandle);
+			return false;
+		}
+
+		if ((FPlatformTime::Seconds() - StartTime) > this->ServerStartupTimeout)
+		{
+			UE_LOG(
+				LogPf2Playground,
+				Error,
+				TEXT("Server did not start listening within %.0f second(s) and has been killed."),
+				this->ServerStartupTimeout
+			);
+
+			FPlatformProcess::TerminateProc(ServerHandle, true);
+			FPlatformProcess::CloseProc(ServerHandle);
+			return false;
+		}
+
+		FPlatformProcess::Sleep(0.25f);
+	}
+
+	UE_LOG(
+		LogPf2Playground,
+		Display,
+		TEXT("Server started listening after %.1f second(s)."),
+		FPlatformTime::Seconds() - StartTime
+	);
+
+	return true;
+}
+
+TSharedPtr<FJsonObject> UOpenPF2PlaygroundNetLoadTestCommandlet::LoadReport(const FString& ReportPath)
+{
+	FString                 ReportJson;
+	TSharedPtr<FJsonObject> Report;
+
+	if (!FFileHelper::LoadFileToString(ReportJson, *ReportPath) ||
+	    !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(ReportJson), Report))
+	{
+		UE_LOG(LogPf2Playground, Error, TEXT("Failed to read network load test report ('%s')."), *ReportPath);
+		return nullptr;
+	}
+
+	return Report;
+}
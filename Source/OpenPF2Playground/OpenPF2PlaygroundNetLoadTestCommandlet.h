@@ -0,0 +1,164 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Commandlets/Commandlet.h>
+
+#include "OpenPF2PlaygroundNetLoadTestCommandlet.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class FJsonObject;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A commandlet that load-tests replication by running a server and several headless bot clients over loopback.
+ *
+ * The commandlet launches a dedicated server (or, with "-Listen", a listen server) on the given map, polls for it to
+ * signal that it is listening, and then launches each bot as a separate client process that connects to it over
+ * 127.0.0.1. Each bot plays a scripted session (see UOpenPF2PlaygroundNetBotSubsystem), switching between Exploration
+ * and Encounter mode and activating abilities, and then disconnects. The server exits once every bot has disconnected.
+ *
+ * The server and each bot write a JSON report of the bytes they sent for each class of actor, the calls they made to
+ * each RPC, and the totals of each connection (see UOpenPF2PlaygroundNetStatsSubsystem). The commandlet combines these
+ * into a single summary. The server also captures a networking trace, which breaks bandwidth down by property when it
+ * is opened in Networking Insights.
+ *
+ * Usage:
+ * UnrealEditor-Cmd OpenPF2Playground.uproject -run=OpenPF2PlaygroundNetLoadTest -unattended
+ *     [-Bots=<N>] [-Duration=<Seconds>] [-Listen] [-Map=<Map Path>] [-Port=<Port>] [-Executable=<Path>]
+ *     [-Output=<Directory>]
+ *
+ * The commandlet returns a non-zero exit code if any process fails to start, exits with an error, or has to be killed
+ * because it did not finish in time.
+ */
+UCLASS(Config=Game)
+class UOpenPF2PlaygroundNetLoadTestCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * The number of bot clients to launch, unless overridden on the command line.
+	 */
+	UPROPERTY(Config)
+	int32 DefaultNumBots;
+
+	/**
+	 * How long (in seconds) each bot plays before disconnecting, unless overridden on the command line.
+	 */
+	UPROPERTY(Config)
+	float DefaultDuration;
+
+	/**
+	 * The map on which to run the load test, unless overridden on the command line.
+	 */
+	UPROPERTY(Config)
+	FString DefaultMap;
+
+	/**
+	 * The port on which the server listens, unless overridden on the command line.
+	 */
+	UPROPERTY(Config)
+	int32 DefaultPort;
+
+	/**
+	 * The most time (in seconds) to give the server to start listening before giving up on the load test.
+	 *
+	 * Bots are launched as soon as the server signals that it is listening, so this only matters if the server hangs.
+	 */
+	UPROPERTY(Config)
+	float ServerStartupTimeout;
+
+	/**
+	 * How long (in seconds) to give each process to load, connect, and exit, in addition to the duration of the test.
+	 */
+	UPROPERTY(Config)
+	float ProcessTimeout;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundNetLoadTestCommandlet();
+
+	// =================================================================================================================
+	// Public Methods - UCommandlet Overrides
+	// =================================================================================================================
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Launches a server or bot process, with its log written to the output directory.
+	 *
+	 * @param Executable
+	 *	The path to the executable to launch.
+	 * @param ProcessName
+	 *	The name of the process, for logging and for the names of its output files.
+	 * @param Arguments
+	 *	The arguments to pass to the process (not including the path to the log).
+	 * @param OutputDirectory
+	 *	The directory to which the log of the process is to be written.
+	 *
+	 * @return
+	 *	The handle of the new process. The handle is not valid if the process could not be launched.
+	 */
+	FProcHandle LaunchProcess(const FString& Executable,
+	                          const FString& ProcessName,
+	                          const FString& Arguments,
+	                          const FString& OutputDirectory) const;
+
+	/**
+	 * Waits for a process to exit, and kills it if it does not exit in time.
+	 *
+	 * @param ProcessHandle
+	 *	The handle of the process. The handle is closed before returning.
+	 * @param ProcessName
+	 *	The name of the process, for logging.
+	 * @param Deadline
+	 *	The wall-clock time (in seconds) by which the process must have exited.
+	 *
+	 * @return
+	 *	true if the process exited in time with an exit code of zero; or, false otherwise.
+	 */
+	bool WaitForProcess(FProcHandle& ProcessHandle, const FString& ProcessName, const double Deadline) const;
+
+	/**
+	 * Waits for the server to signal that it is listening for connections.
+	 *
+	 * @param ServerHandle
+	 *	The handle of the server process.
+	 * @param ReadyFilePath
+	 *	The path of the file that the server creates once it is listening.
+	 *
+	 * @return
+	 *	true if the server is ready; or, false if it exited or did not become ready within ServerStartupTimeout.
+	 */
+	bool WaitForServerReady(FProcHandle& ServerHandle, const FString& ReadyFilePath) const;
+
+	/**
+	 * Loads a JSON report written by a server or bot process.
+	 *
+	 * @param ReportPath
+	 *	The path to the report.
+	 *
+	 * @return
+	 *	The report; or, nullptr if it does not exist or could not be parsed.
+	 */
+	static TSharedPtr<FJsonObject> LoadReport(const FString& ReportPath);
+};
@@ -0,0 +1,291 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundNetStatsSubsystem.h"
+
+#include <Dom/JsonObject.h>
+
+#include <Engine/ActorChannel.h>
+#include <Engine/NetConnection.h>
+#include <Engine/NetDriver.h>
+#include <Engine/World.h>
+
+#include <Misc/CommandLine.h>
+#include <Misc/FileHelper.h>
+
+#include <Serialization/JsonSerializer.h>
+#include <Serialization/JsonWriter.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundBenchmarkCommandlet.h"
+
+int32 UOpenPF2PlaygroundNetStatsSubsystem::NumAccountingWorlds = 0;
+
+bool UOpenPF2PlaygroundNetStatsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const TCHAR* CommandLine = FCommandLine::Get();
+
+	return Super::ShouldCreateSubsystem(Outer) &&
+		(FParse::Param(CommandLine, TEXT("Pf2NetLoadTest")) || FParse::Param(CommandLine, TEXT("Pf2NetBot")));
+}
+
+void UOpenPF2PlaygroundNetStatsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	const TCHAR* CommandLine = FCommandLine::Get();
+
+	Super::Initialize(Collection);
+
+	++NumAccountingWorlds;
+
+	this->bIsLoadTestServer = FParse::Param(CommandLine, TEXT("Pf2NetLoadTest"));
+
+	FParse::Value(CommandLine, TEXT("Pf2NetReport="), this->ReportPath);
+	FParse::Value(CommandLine, TEXT("Pf2NetReadyFile="), this->ReadyFilePath);
+	FParse::Value(CommandLine, TEXT("Pf2NetLoadTestTimeout="), this->LoadTestTimeout);
+}
+
+void UOpenPF2PlaygroundNetStatsSubsystem::Deinitialize()
+{
+	UNetDriver* NetDriver = this->BoundNetDriver.Get();
+
+	if (NetDriver != nullptr)
+	{
+		NetDriver->SendRPCDel.Unbind();
+	}
+
+	// Only the world that is being played (not the transition or entry map) has anything worth reporting.
+	if (this->TrafficByClass.Num() != 0)
+	{
+		this->WriteReport();
+	}
+
+	--NumAccountingWorlds;
+
+	Super::Deinitialize();
+}
+
+void UOpenPF2PlaygroundNetStatsSubsystem::Tick(const float DeltaTime)
+{
+	UNetDriver* NetDriver = this->GetWorld()->GetNetDriver();
+	int32       NumClientConnections;
+
+	Super::Tick(DeltaTime);
+
+	if ((NetDriver == nullptr) || this->bHasWrittenReport)
+	{
+		return;
+	}
+
+	if (!this->BoundNetDriver.IsValid())
+	{
+		NetDriver->SendRPCDel.BindUObject(this, &UOpenPF2PlaygroundNetStatsSubsystem::Native_OnSendRpc);
+
+		this->BoundNetDriver = NetDriver;
+	}
+
+	this->SampleConnectionTotals(NetDriver);
+
+	if (!this->bIsLoadTestServer)
+	{
+		return;
+	}
+
+	if (!this->ReadyFilePath.IsEmpty() && NetDriver->IsServer())
+	{
+		// The net driver of a server only exists once it is listening, so bots can connect from now on.
+		if (!FFileHelper::SaveStringToFile(this->GetWorld()->GetMapName(), *this->ReadyFilePath))
+		{
+			UE_LOG(LogPf2Playground, Error, TEXT("Failed to signal readiness through '%s'."), *this->ReadyFilePath);
+		}
+
+		this->ReadyFilePath.Empty();
+	}
+
+	NumClientConnections = NetDriver->ClientConnections.Num();
+
+	if ((this->FirstConnectionTime == 0.0) && (NumClientConnections != 0))
+	{
+		this->FirstConnectionTime = FPlatformTime::Seconds();
+	}
+
+	if ((this->FirstConnectionTime != 0.0) && (NumClientConnections == 0))
+	{
+		UE_LOG(LogPf2Playground, Display, TEXT("All load test bots have disconnected."));
+
+		this->WriteReport();
+		FPlatformMisc::RequestExit(false);
+	}
+	else if ((this->LoadTestTimeout > 0.0f) && (FPlatformTime::Seconds() - GStartTime) > this->LoadTestTimeout)
+	{
+		UE_LOG(LogPf2Playground, Error, TEXT("Load test timed out waiting for bots to disconnect."));
+
+		this->WriteReport();
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+	}
+}
+
+TStatId UOpenPF2PlaygroundNetStatsSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UOpenPF2PlaygroundNetStatsSubsystem, STATGROUP_Tickables);
+}
+
+void UOpenPF2PlaygroundNetStatsSubsystem::RecordBunch(const UChannel* Channel, const int64 NumBits)
+{
+	const UActorChannel* ActorChannel = Cast<UActorChannel>(Channel);
+	FName                Key;
+
+	if ((ActorChannel != nullptr) && (ActorChannel->Actor != nullptr))
+	{
+		Key = ActorChannel->Actor->GetClass()->GetFName();
+	}
+	else if (Channel != nullptr)
+	{
+		// Control, voice, and actor channels that are closing are accounted for by type of channel.
+		Key = Channel->ChName;
+	}
+	else
+	{
+		Key = NAME_None;
+	}
+
+	FOpenPF2PlaygroundNetClassTraffic& Traffic = this->TrafficByClass.FindOrAdd(Key);
+
+	++Traffic.NumBunches;
+	Traffic.NumBits += NumBits;
+}
+
+bool UOpenPF2PlaygroundNetStatsSubsystem::WriteReport()
+{
+	FString ReportJson;
+
+	if (this->bHasWrittenReport)
+	{
+		return true;
+	}
+
+	this->bHasWrittenReport = true;
+
+	if (this->BoundNetDriver.IsValid())
+	{
+		this->SampleConnectionTotals(this->BoundNetDriver.Get());
+	}
+
+	FJsonSerializer::Serialize(this->BuildReport(), TJsonWriterFactory<>::Create(&ReportJson));
+
+	if (this->ReportPath.IsEmpty())
+	{
+		UE_LOG(LogPf2Playground, Display, TEXT("Network load test results:\n%s"), *ReportJson);
+		return true;
+	}
+
+	if (!FFileHelper::SaveStringToFile(ReportJson, *this->ReportPath))
+	{
+		UE_LOG(LogPf2Playground, Error, TEXT("Failed to write network load test results to '%s'."), *this->ReportPath);
+		return false;
+	}
+
+	UE_LOG(LogPf2Playground, Display, TEXT("Network load test results written to '%s'."), *this->ReportPath);
+
+	return true;
+}
+
+bool UOpenPF2PlaygroundNetStatsSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game;
+}
+
+void UOpenPF2PlaygroundNetStatsSubsystem::SampleConnectionTotals(const UNetDriver* NetDriver)
+{
+	if (NetDriver->ServerConnection != nullptr)
+	{
+		this->SampleConnectionTotals(NetDriver->ServerConnection);
+	}
+
+	for (const UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		this->SampleConnectionTotals(Connection);
+	}
+}
+
+void UOpenPF2PlaygroundNetStatsSubsystem::SampleConnectionTotals(const UNetConnection* Connection)
+{
+	FOpenPF2PlaygroundNetConnectionTotals& Totals =
+		this->TotalsByConnection.FindOrAdd(Connection->LowLevelGetRemoteAddress(true));
+
+	Totals.OutBytes   = Connection->OutTotalBytes;
+	Totals.InBytes    = Connection->InTotalBytes;
+	Totals.OutPackets = Connection->OutTotalPackets;
+	Totals.InPackets  = Connection->InTotalPackets;
+}
+
+TSharedRef<FJsonObject> UOpenPF2PlaygroundNetStatsSubsystem::BuildReport() const
+{
+	const TSharedRef<FJsonObject> Report      = UOpenPF2PlaygroundBenchmarkCommandlet::CreateReport();
+	const TSharedRef<FJsonObject> Classes     = MakeShared<FJsonObject>();
+	const TSharedRef<FJsonObject> Rpcs        = MakeShared<FJsonObject>();
+	const TSharedRef<FJsonObject> Connections = MakeShared<FJsonObject>();
+	const double                  Duration    =
+		(this->FirstConnectionTime != 0.0) ? (FPlatformTime::Seconds() - this->FirstConnectionTime) : 0.0;
+
+	for (const TPair<FName, FOpenPF2PlaygroundNetClassTraffic>& ClassTraffic : this->TrafficByClass)
+	{
+		const TSharedRef<FJsonObject> Entry = MakeShared<FJsonObject>();
+
+		Entry->SetNumberField(TEXT("Bunches"), ClassTraffic.Value.NumBunches);
+		Entry->SetNumberField(TEXT("Bytes"), ClassTraffic.Value.NumBits / 8.0);
+
+		Classes->SetObjectField(ClassTraffic.Key.ToString(), Entry);
+	}
+
+	for (const TPair<FString, FOpenPF2PlaygroundNetRpcCalls>& RpcCalls : this->CallsByRpc)
+	{
+		const TSharedRef<FJsonObject> Entry = MakeShared<FJsonObject>();
+
+		Entry->SetNumberField(TEXT("Calls"), RpcCalls.Value.NumCalls);
+		Entry->SetBoolField(TEXT("Reliable"), RpcCalls.Value.bIsReliable);
+
+		Rpcs->SetObjectField(RpcCalls.Key, Entry);
+	}
+
+	for (const TPair<FString, FOpenPF2PlaygroundNetConnectionTotals>& ConnectionTotals : this->TotalsByConnection)
+	{
+		const TSharedRef<FJsonObject> Entry = MakeShared<FJsonObject>();
+
+		Entry->SetNumberField(TEXT("OutBytes"), ConnectionTotals.Value.OutBytes);
+		Entry->SetNumberField(TEXT("InBytes"), ConnectionTotals.Value.InBytes);
+		Entry->SetNumberField(TEXT("OutPackets"), ConnectionTotals.Value.OutPackets);
+		Entry->SetNumberField(TEXT("InPackets"), ConnectionTotals.Value.InPackets);
+
+		Connections->SetObjectField(ConnectionTotals.Key, Entry);
+	}
+
+	Report->SetStringField(TEXT("Role"), this->bIsLoadTestServer ? TEXT("Server") : TEXT("Bot"));
+	Report->SetStringField(TEXT("Map"), this->GetWorld()->GetMapName());
+	Report->SetNumberField(TEXT("DurationSeconds"), Duration);
+	Report->SetObjectField(TEXT("SentByClass"), Classes);
+	Report->SetObjectField(TEXT("SentRpcs"), Rpcs);
+	Report->SetObjectField(TEXT("Connections"), Connections);
+
+	return Report;
+}
+
+void UOpenPF2PlaygroundNetStatsSubsystem::Native_OnSendRpc(AActor*      Actor,
+                                                           UFunction*   Function,
+                                                           void*        Parameters,
+                                                           FOutParmRec* OutParms,
+                                                           FFrame*      Stack,
+                                                           UObject*     SubObject,
+                                                           bool&        bBlockSendRPC)
+{
+	FOpenPF2PlaygroundNetRpcCalls& Calls = this->CallsByRpc.FindOrAdd(Function->GetPathName());
+
+	++Calls.NumCalls;
+	Calls.bIsReliable = Function->HasAnyFunctionFlags(FUNC_NetReliable);
+
+	if (this->FirstConnectionTime == 0.0)
+	{
+		this->FirstConnectionTime = FPlatformTime::Seconds();
+	}
+}
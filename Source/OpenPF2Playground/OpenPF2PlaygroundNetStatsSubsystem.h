@@ -0,0 +1,300 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Subsystems/WorldSubsystem.h>
+
+#include "OpenPF2PlaygroundNetStatsSubsystem.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class FJsonObject;
+class UChannel;
+class UNetConnection;
+class UNetDriver;
+struct FFrame;
+struct FOutParmRec;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * The network traffic that has been sent on behalf of a class of actor (or a type of channel).
+ */
+struct FOpenPF2PlaygroundNetClassTraffic
+{
+	/**
+	 * The number of bunches that have been sent.
+	 */
+	int64 NumBunches = 0;
+
+	/**
+	 * The number of bits in all of the bunches that have been sent.
+	 */
+	int64 NumBits = 0;
+};
+
+/**
+ * The number of times that a remote function has been called.
+ */
+struct FOpenPF2PlaygroundNetRpcCalls
+{
+	/**
+	 * The number of calls.
+	 */
+	int64 NumCalls = 0;
+
+	/**
+	 * Whether the remote function is reliable.
+	 */
+	bool bIsReliable = false;
+};
+
+/**
+ * The totals of a network connection, as of the last time they were sampled.
+ */
+struct FOpenPF2PlaygroundNetConnectionTotals
+{
+	/**
+	 * The number of bytes that have been sent over the connection.
+	 */
+	int64 OutBytes = 0;
+
+	/**
+	 * The number of bytes that have been received over the connection.
+	 */
+	int64 InBytes = 0;
+
+	/**
+	 * The number of packets that have been sent over the connection.
+	 */
+	int64 OutPackets = 0;
+
+	/**
+	 * The number of packets that have been received over the connection.
+	 */
+	int64 InPackets = 0;
+};
+
+/**
+ * A world subsystem that accounts for the network traffic of a network load test, by class of actor and by RPC.
+ *
+ * This is only created on a server launched with "-Pf2NetLoadTest" and on bot clients launched with "-Pf2NetBot" (see
+ * UOpenPF2PlaygroundNetLoadTestCommandlet). It records:
+ *  - The bunches sent for each class of actor (properties and RPCs combined), as reported by
+ *    UOpenPF2PlaygroundIpConnection. Subobjects such as ASCs are included in the class of the actor that owns them.
+ *  - The number of calls to each remote function sent by this machine.
+ *  - The total bytes and packets of each connection.
+ *
+ * The report is written as JSON to the path given by "-Pf2NetReport=<Path>". For a breakdown of bandwidth by property,
+ * the load test harness also captures a networking trace ("-trace=net -NetTrace=1") that can be opened in Networking
+ * Insights.
+ *
+ * A server running a load test creates the file given by "-Pf2NetReadyFile=<Path>" (if any) once it is listening for
+ * connections, so that the load test harness can launch bots as soon as the server is ready. It writes its report and
+ * exits once every bot that connected to it has disconnected.
+ */
+UCLASS()
+class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundNetStatsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Static Fields
+	// =================================================================================================================
+	/**
+	 * The number of worlds that are accounting for network traffic. This keeps accounting free when no load test is
+	 * running.
+	 *
+	 * This is a count rather than a flag because the subsystem of the next world is initialized before that of the
+	 * previous world is torn down during a map change.
+	 */
+	static int32 NumAccountingWorlds;
+
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * The traffic that has been sent for each class of actor or type of channel, by name.
+	 */
+	TMap<FName, FOpenPF2PlaygroundNetClassTraffic> TrafficByClass;
+
+	/**
+	 * The calls that have been made to each remote function, by the path name of the function.
+	 */
+	TMap<FString, FOpenPF2PlaygroundNetRpcCalls> CallsByRpc;
+
+	/**
+	 * The totals of each connection that has been seen, by remote address.
+	 */
+	TMap<FString, FOpenPF2PlaygroundNetConnectionTotals> TotalsByConnection;
+
+	/**
+	 * The net driver whose RPCs are being counted (if any).
+	 */
+	TWeakObjectPtr<UNetDriver> BoundNetDriver;
+
+	/**
+	 * The path to which the report is to be written.
+	 */
+	FString ReportPath;
+
+	/**
+	 * The path of the file to create once the server is listening for connections; or, an empty string if the server
+	 * has already signaled that it is ready (or nobody is waiting for it).
+	 */
+	FString ReadyFilePath;
+
+	/**
+	 * Whether this is the server of a load test (as opposed to a bot client).
+	 */
+	bool bIsLoadTestServer;
+
+	/**
+	 * The wall-clock time (in seconds) at which the first connection was seen; or, zero if none has been seen yet.
+	 */
+	double FirstConnectionTime;
+
+	/**
+	 * The number of wall-clock seconds after which a load test server gives up on its bots and exits.
+	 */
+	float LoadTestTimeout;
+
+	/**
+	 * Whether the report has already been written.
+	 */
+	bool bHasWrittenReport;
+
+public:
+	// =================================================================================================================
+	// Public Static Methods
+	// =================================================================================================================
+	/**
+	 * Determines whether network traffic is being accounted for in any world.
+	 *
+	 * @return
+	 *	true if a network load test is running in this process; or, false otherwise.
+	 */
+	FORCEINLINE static bool IsAccountingEnabled()
+	{
+		return NumAccountingWorlds != 0;
+	}
+
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundNetStatsSubsystem() :
+		bIsLoadTestServer(false),
+		FirstConnectionTime(0.0),
+		LoadTestTimeout(600.0f),
+		bHasWrittenReport(false)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Methods - USubsystem Overrides
+	// =================================================================================================================
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	// =================================================================================================================
+	// Public Methods - FTickableGameObject Overrides
+	// =================================================================================================================
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Records a bunch that has been sent over a connection of this world.
+	 *
+	 * @param Channel
+	 *	The channel on which the bunch was sent.
+	 * @param NumBits
+	 *	The size of the bunch, in bits.
+	 */
+	void RecordBunch(const UChannel* Channel, const int64 NumBits);
+
+	/**
+	 * Writes the report of the traffic that has been recorded so far, if it has not been written already.
+	 *
+	 * @return
+	 *	true if the report was written (or there is nowhere to write it); or, false if it could not be written.
+	 */
+	bool WriteReport();
+
+protected:
+	// =================================================================================================================
+	// Protected Methods - UWorldSubsystem Overrides
+	// =================================================================================================================
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Samples the totals of every connection of the net driver of this world.
+	 *
+	 * @param NetDriver
+	 *	The net driver whose connections are to be sampled.
+	 */
+	void SampleConnectionTotals(const UNetDriver* NetDriver);
+
+	/**
+	 * Samples the totals of a single connection.
+	 *
+	 * @param Connection
+	 *	The connection to sample.
+	 */
+	void SampleConnectionTotals(const UNetConnection* Connection);
+
+	/**
+	 * Builds the report of the traffic that has been recorded so far.
+	 *
+	 * @return
+	 *	The report, as a JSON object.
+	 */
+	TSharedRef<FJsonObject> BuildReport() const;
+
+	// =================================================================================================================
+	// Protected Native Event Callbacks
+	// =================================================================================================================
+	/**
+	 * Native callback invoked by the net driver of this world before it sends an RPC.
+	 *
+	 * @param Actor
+	 *	The actor on which the RPC is being called.
+	 * @param Function
+	 *	The remote function being called.
+	 * @param Parameters
+	 *	The parameters of the call.
+	 * @param OutParms
+	 *	The out parameters of the call.
+	 * @param Stack
+	 *	The stack frame of the call.
+	 * @param SubObject
+	 *	The subobject (e.g., a component) on which the RPC is being called; or, nullptr if it is called on the actor.
+	 * @param bBlockSendRPC
+	 *	Set to true to prevent the RPC from being sent. This callback never blocks RPCs.
+	 */
+	void Native_OnSendRpc(AActor*      Actor,
+	                      UFunction*   Function,
+	                      void*        Parameters,
+	                      FOutParmRec* OutParms,
+	                      FFrame*      Stack,
+	                      UObject*     SubObject,
+	                      bool&        bBlockSendRPC);
+};
@@ -5,36 +5,219 @@
 
 #include "OpenPF2PlaygroundPlayerControllerBase.h"
 
+#include <AbilitySystemComponent.h>
+#include <AbilitySystemGlobals.h>
+
+#include <Abilities/GameplayAbilityTargetTypes.h>
+
+#include <Kismet/GameplayStatics.h>
+
+#include <Misc/CoreDelegates.h>
+
+#include <Net/UnrealNetwork.h>
+
+#include <Net/Core/PushModel/PushModel.h>
+
 #include "InputBindableCharacterInterface.h"
-#include "PF2CharacterBase.h"
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundCharacterBase.h"
+#include "OpenPF2PlaygroundEventLog.h"
+#include "OpenPF2PlaygroundMovementGridSubsystem.h"
+#include "OpenPF2PlaygroundReplicationGraph.h"
 #include "PF2CharacterInterface.h"
+#include "PF2GameModeInterface.h"
+
+#include "Commands/PF2CharacterCommand.h"
 
 AOpenPF2PlaygroundPlayerControllerBase::AOpenPF2PlaygroundPlayerControllerBase()
 {
 	// set our turn rates for input
 	this->BaseTurnRate   = 45.0f;
 	this->BaseLookUpRate = 45.0f;
+
+	this->NumCameraManagementTransitions          = 0;
+	this->NumRedundantCameraManagementTransitions = 0;
+
+	this->bCacheScreenTraces    = true;
+	this->ScreenTraceCacheFrame = 0;
+
+	this->LastPartyHandoverTime = 0.0f;
+
+	this->bFlushQueuedAbilityCommandsEachFrame = true;
+	this->MaxQueuedAbilityCommandsPerBatch     = 16;
 }
 
-void AOpenPF2PlaygroundPlayerControllerBase::SetPawn(APawn* InPawn)
+void AOpenPF2PlaygroundPlayerControllerBase::GetLifetimeReplicatedProps(
+	TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-	APF2CharacterBase*       OldCharacterIntf = Cast<APF2CharacterBase>(this->GetPawn());
-	const APF2CharacterBase* NewCharacterIntf = Cast<APF2CharacterBase>(InPawn);
+	FDoRepLifetimeParams OwnerOnlyParams;
+
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	OwnerOnlyParams.Condition    = COND_OwnerOnly;
+	OwnerOnlyParams.bIsPushBased = true;
 
+	DOREPLIFETIME_WITH_PARAMS_FAST(AOpenPF2PlaygroundPlayerControllerBase, CameraManagementState, OwnerOnlyParams);
+}
+
+void AOpenPF2PlaygroundPlayerControllerBase::SetPawn(APawn* InPawn)
+{
 	Super::SetPawn(InPawn);
 
-	if ((OldCharacterIntf != nullptr) && (OldCharacterIntf != NewCharacterIntf))
+	this->LoadDeferredInputBindings();
+}
+
+bool AOpenPF2PlaygroundPlayerControllerBase::Server_RequestModeOfPlayForLoadTest_Validate(
+	const EPF2ModeOfPlayType ModeOfPlay)
+{
+	// Load tests never run against Shipping builds, so any client calling this there is misbehaving.
+	return !UE_BUILD_SHIPPING;
+}
+
+void AOpenPF2PlaygroundPlayerControllerBase::Server_RequestModeOfPlayForLoadTest_Implementation(
+	const EPF2ModeOfPlayType ModeOfPlay)
+{
+#if !UE_BUILD_SHIPPING
+	IPF2GameModeInterface* GameModeIntf;
+
+	if (!FParse::Param(FCommandLine::Get(), TEXT("Pf2NetLoadTest")))
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Warning,
+			TEXT("[%s] Ignoring request for a change in mode of play from a client outside of a network load test."),
+			*(this->GetName())
+		);
+
+		return;
+	}
+
+	GameModeIntf = Cast<IPF2GameModeInterface>(this->GetWorld()->GetAuthGameMode());
+
+	if (GameModeIntf == nullptr)
 	{
-		const UWorld*  World        = this->GetWorld();
-		FTimerManager& TimerManager = World->GetTimerManager();
+		UE_LOG(
+			LogPf2Playground,
+			Error,
+			TEXT("[%s] The current game mode is not compatible with OpenPF2."),
+			*(this->GetName())
+		);
 
-		// BUGBUG (UE-78453): There is a delay in replicating controller ownership changes to clients. So, if we refresh
-		// the ASC during the same frame as the ownership change happens, the client will tend to cache the old
-		// controller as the current controller of the old character even though it's not. This breaks execution of
-		// abilities and montages, so as a workaround we schedule the ASC to be updated during the next frame after
-		// replication has happened.
-		TimerManager.SetTimerForNextTick(OldCharacterIntf, &APF2CharacterBase::InitializeOrRefreshAbilities);
+		return;
 	}
+
+	switch (ModeOfPlay)
+	{
+		case EPF2ModeOfPlayType::Encounter:
+			GameModeIntf->RequestEncounterMode();
+			break;
+
+		case EPF2ModeOfPlayType::Exploration:
+			GameModeIntf->RequestExplorationMode();
+			break;
+
+		default:
+			break;
+	}
+#endif
+}
+
+void AOpenPF2PlaygroundPlayerControllerBase::NotifyPossessionSwapRequested()
+{
+	AOpenPF2PlaygroundCharacterBase* CurrentCharacter = Cast<AOpenPF2PlaygroundCharacterBase>(this->GetPawn());
+
+	if (CurrentCharacter != nullptr)
+	{
+		// The current character refreshes its own ASC once the change of controller is visible on this machine (see
+		// AOpenPF2PlaygroundCharacterBase::NotifyControllerChanged()). We just start the clock on the swap.
+		CurrentCharacter->NotifyPossessionSwapStarted();
+	}
+}
+
+bool AOpenPF2PlaygroundPlayerControllerBase::QueueAbilityCommand(AActor*                          Character,
+                                                                 const FGameplayAbilitySpecHandle AbilitySpecHandle)
+{
+	FOpenPF2PlaygroundQueuedAbilityCommand Command(Character, AbilitySpecHandle);
+	FOpenPF2PlaygroundQueuedAbilityTarget  QueuedTarget;
+
+	// The target selection is read directly, rather than through target data, so that nothing is allocated for a
+	// command that is only going to be quantized anyway.
+	switch (this->GetTargetSelectionType())
+	{
+		case EPF2TargetSelectionType::None:
+			break;
+
+		case EPF2TargetSelectionType::Character:
+		{
+			AActor* TargetActor = Cast<AActor>(this->GetTargetCharacter().GetObject());
+
+			if (TargetActor == nullptr)
+			{
+				return false;
+			}
+
+			QueuedTarget.TargetActors.Add(TargetActor);
+			Command.Targets.Add(QueuedTarget);
+			break;
+		}
+
+		case EPF2TargetSelectionType::Location:
+		{
+			const UOpenPF2PlaygroundMovementGridSubsystem* GridSubsystem =
+				this->GetWorld()->GetSubsystem<UOpenPF2PlaygroundMovementGridSubsystem>();
+			FIntPoint                                      TargetCell;
+
+			if ((GridSubsystem == nullptr) ||
+			    !GridSubsystem->GetCellForLocation(this->GetTargetLocation(), TargetCell) ||
+			    !FOpenPF2PlaygroundQueuedAbilityTarget::CanQuantizeCell(TargetCell))
+			{
+				return false;
+			}
+
+			QueuedTarget.SetTargetCell(TargetCell);
+			Command.Targets.Add(QueuedTarget);
+			break;
+		}
+
+		default:
+			// Targets that are neither characters nor locations cannot be represented in a queued command.
+			return false;
+	}
+
+	this->QueuedAbilityCommands.Add(Command);
+
+	if (this->QueuedAbilityCommands.Num() >= this->MaxQueuedAbilityCommandsPerBatch)
+	{
+		this->FlushQueuedAbilityCommands();
+	}
+	else if (this->bFlushQueuedAbilityCommandsEachFrame)
+	{
+		FTimerManager& TimerManager = this->GetWorldTimerManager();
+
+		if (!TimerManager.TimerExists(this->QueuedAbilityCommandsHandle))
+		{
+			this->QueuedAbilityCommandsHandle = TimerManager.SetTimerForNextTick(
+				this,
+				&AOpenPF2PlaygroundPlayerControllerBase::FlushQueuedAbilityCommands
+			);
+		}
+	}
+
+	return true;
+}
+
+void AOpenPF2PlaygroundPlayerControllerBase::FlushQueuedAbilityCommands()
+{
+	this->GetWorldTimerManager().ClearTimer(this->QueuedAbilityCommandsHandle);
+
+	if (this->QueuedAbilityCommands.Num() == 0)
+	{
+		return;
+	}
+
+	this->Server_ExecuteQueuedAbilityCommands(this->QueuedAbilityCommands);
+
+	this->QueuedAbilityCommands.Reset();
 }
 
 void AOpenPF2PlaygroundPlayerControllerBase::Native_OnCharacterGiven(
@@ -43,7 +226,27 @@ void AOpenPF2PlaygroundPlayerControllerBase::Native_OnCharacterGiven(
 {
 	Super::Native_OnCharacterGiven(CharacterQueueComponent, GivenCharacter);
 
-	this->AcknowledgeOwnership(GivenCharacter);
+	UOpenPF2PlaygroundReplicationGraph::NotifyCharacterPartyChanged(Cast<AActor>(GivenCharacter.GetObject()));
+
+	// Characters are given to us one at a time, so they are collected until the end of the frame (i.e., before they
+	// are rendered or receive input) and then acknowledged together as a single party.
+	this->CharactersAwaitingAcknowledgement.AddUnique(GivenCharacter);
+
+	if (!this->AcknowledgeGivenCharactersHandle.IsValid())
+	{
+		this->AcknowledgeGivenCharactersHandle = FCoreDelegates::OnEndFrame.AddUObject(
+			this,
+			&AOpenPF2PlaygroundPlayerControllerBase::AcknowledgeGivenCharacters
+		);
+	}
+}
+
+void AOpenPF2PlaygroundPlayerControllerBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FCoreDelegates::OnEndFrame.Remove(this->AcknowledgeGivenCharactersHandle);
+	this->AcknowledgeGivenCharactersHandle.Reset();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AOpenPF2PlaygroundPlayerControllerBase::AcknowledgeOwnership(
@@ -62,29 +265,297 @@ void AOpenPF2PlaygroundPlayerControllerBase::AcknowledgeOwnership(
 	}
 }
 
+void AOpenPF2PlaygroundPlayerControllerBase::AcknowledgeOwnershipOfParty(
+	const TArray<TScriptInterface<IPF2CharacterInterface>>& InCharacters)
+{
+	const double StartTime          = FPlatformTime::Seconds();
+	const APawn* PossessedPawn      = this->GetPawn();
+	int32        NumDeferredInBatch = 0;
+
+	for (const TScriptInterface<IPF2CharacterInterface>& Character : InCharacters)
+	{
+		UObject*                          CharacterObject       = Character.GetObject();
+		IInputBindableCharacterInterface* BindableCharacterIntf =
+			Cast<IInputBindableCharacterInterface>(CharacterObject);
+
+		if (CharacterObject == nullptr)
+		{
+			continue;
+		}
+
+		// Ensure the ASC has been initialized on the server.
+		Character->InitializeOrRefreshAbilities();
+
+		if (BindableCharacterIntf != nullptr)
+		{
+			if ((PossessedPawn == nullptr) || (CharacterObject == PossessedPawn))
+			{
+				BindableCharacterIntf->LoadInputAbilityBindings();
+				BindableCharacterIntf->SetupClientAbilityChangeListener();
+			}
+			else
+			{
+				// The listener only exists to reload input bindings, so it is deferred along with them.
+				this->CharactersAwaitingInputBindings.AddUnique(Character);
+				++NumDeferredInBatch;
+			}
+		}
+	}
+
+	this->LastPartyHandoverTime = FPlatformTime::Seconds() - StartTime;
+
+	OpenPF2PlaygroundEventLog::Record(
+		EOpenPF2PlaygroundEvent::PartyOwnershipAcknowledged,
+		this,
+		InCharacters.Num(),
+		NumDeferredInBatch,
+		this->LastPartyHandoverTime * 1000.0f
+	);
+}
+
+void AOpenPF2PlaygroundPlayerControllerBase::AcknowledgeGivenCharacters()
+{
+	const TArray<TScriptInterface<IPF2CharacterInterface>> GivenCharacters =
+		MoveTemp(this->CharactersAwaitingAcknowledgement);
+
+	FCoreDelegates::OnEndFrame.Remove(this->AcknowledgeGivenCharactersHandle);
+	this->AcknowledgeGivenCharactersHandle.Reset();
+
+	this->AcknowledgeOwnershipOfParty(GivenCharacters);
+}
+
+void AOpenPF2PlaygroundPlayerControllerBase::LoadDeferredInputBindings()
+{
+	const APawn* PossessedPawn = this->GetPawn();
+
+	for (auto CharacterIterator = this->CharactersAwaitingInputBindings.CreateIterator();
+	     CharacterIterator;
+	     ++CharacterIterator)
+	{
+		UObject*                          CharacterObject       = CharacterIterator->GetObject();
+		IInputBindableCharacterInterface* BindableCharacterIntf =
+			Cast<IInputBindableCharacterInterface>(CharacterObject);
+
+		if (BindableCharacterIntf == nullptr)
+		{
+			// The character is gone.
+			CharacterIterator.RemoveCurrent();
+		}
+		else if ((PossessedPawn == nullptr) || (CharacterObject == PossessedPawn))
+		{
+			BindableCharacterIntf->LoadInputAbilityBindings();
+			BindableCharacterIntf->SetupClientAbilityChangeListener();
+			CharacterIterator.RemoveCurrent();
+		}
+	}
+}
+
 bool AOpenPF2PlaygroundPlayerControllerBase::GetHitResultForScreenPosition(const FVector2D         InPosition,
                                                                            const ECollisionChannel InTraceChannel,
                                                                            const bool              bInTraceComplex,
                                                                            FHitResult&             OutHitResult) const
 {
-	const bool bHit = this->GetHitResultAtScreenPosition(InPosition, InTraceChannel, bInTraceComplex, OutHitResult);
+	PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundScreenTrace, ScreenTrace);
 
-	if (!bHit)
+	const FOpenPF2PlaygroundScreenTraceQuery       Query(InPosition, InTraceChannel, bInTraceComplex);
+	const FHitResult*                              CachedHitResult = this->FindCachedScreenTrace(Query);
+	const UOpenPF2PlaygroundMovementGridSubsystem* GridSubsystem   =
+		this->GetMovementGridForTraceChannel(InTraceChannel);
+	bool                                           bHit;
+
+	if (CachedHitResult != nullptr)
 	{
-		// If there was no hit we reset the results. This is redundant but helps Blueprint users
-		OutHitResult = FHitResult();
+		OutHitResult = *CachedHitResult;
+		bHit         = OutHitResult.bBlockingHit;
+	}
+	else
+	{
+		if (GridSubsystem != nullptr)
+		{
+			FVector WorldOrigin,
+			        WorldDirection;
+
+			bHit = UGameplayStatics::DeprojectScreenToWorld(this, InPosition, WorldOrigin, WorldDirection) &&
+			       GridSubsystem->GetHitResultForRay(
+			           WorldOrigin,
+			           WorldDirection,
+			           this->HitResultTraceDistance,
+			           OutHitResult
+			       );
+		}
+		else
+		{
+			bHit = this->GetHitResultAtScreenPosition(InPosition, InTraceChannel, bInTraceComplex, OutHitResult);
+		}
+
+		if (!bHit)
+		{
+			// If there was no hit we reset the results. This is redundant but helps Blueprint users
+			OutHitResult = FHitResult();
+		}
+
+		this->CacheScreenTrace(Query, OutHitResult);
 	}
 
 	return bHit;
 }
 
+int32 AOpenPF2PlaygroundPlayerControllerBase::GetHitResultsForScreenPositions(
+	const TArray<FOpenPF2PlaygroundScreenTraceQuery>& InQueries,
+	TArray<FHitResult>&                               OutHitResults) const
+{
+	PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundScreenTraceBatch, ScreenTraceBatch);
+
+	int32                                                NumHits = 0;
+	TMap<FOpenPF2PlaygroundScreenTraceQuery, FHitResult> BatchResults;
+	TMap<FVector2D, TPair<FVector, FVector>>             ProjectedPositions;
+
+	OutHitResults.Reset(InQueries.Num());
+
+	for (const FOpenPF2PlaygroundScreenTraceQuery& Query : InQueries)
+	{
+		const FHitResult* ExistingResult = BatchResults.Find(Query);
+
+		if (ExistingResult == nullptr)
+		{
+			ExistingResult = this->FindCachedScreenTrace(Query);
+		}
+
+		if (ExistingResult == nullptr)
+		{
+			const TPair<FVector, FVector>* WorldRay = ProjectedPositions.Find(Query.Position);
+			FHitResult                     HitResult;
+
+			if (WorldRay == nullptr)
+			{
+				FVector WorldOrigin,
+				        WorldDirection;
+
+				if (UGameplayStatics::DeprojectScreenToWorld(this, Query.Position, WorldOrigin, WorldDirection))
+				{
+					WorldRay = &ProjectedPositions.Add(
+						Query.Position,
+						TPair<FVector, FVector>(WorldOrigin, WorldDirection)
+					);
+				}
+			}
+
+			if (WorldRay != nullptr)
+			{
+				HitResult = this->TraceFromWorldRay(Query, WorldRay->Key, WorldRay->Value);
+			}
+
+			this->CacheScreenTrace(Query, HitResult);
+
+			ExistingResult = &BatchResults.Add(Query, HitResult);
+		}
+
+		if (ExistingResult->bBlockingHit)
+		{
+			++NumHits;
+		}
+
+		OutHitResults.Add(*ExistingResult);
+	}
+
+	return NumHits;
+}
+
+bool AOpenPF2PlaygroundPlayerControllerBase::GetMovementGridCellForScreenPosition(const FVector2D InPosition,
+                                                                                  FIntPoint&      OutCell,
+                                                                                  FVector&        OutLocation) const
+{
+	const UOpenPF2PlaygroundMovementGridSubsystem* GridSubsystem =
+		this->GetWorld()->GetSubsystem<UOpenPF2PlaygroundMovementGridSubsystem>();
+	FVector                                        WorldOrigin,
+	                                               WorldDirection;
+
+	if ((GridSubsystem == nullptr) ||
+		!UGameplayStatics::DeprojectScreenToWorld(this, InPosition, WorldOrigin, WorldDirection))
+	{
+		return false;
+	}
+
+	return GridSubsystem->GetCellForRay(WorldOrigin, WorldDirection, OutCell, OutLocation);
+}
+
+bool AOpenPF2PlaygroundPlayerControllerBase::RequestAsyncHitResultForScreenPosition(
+	const FVector2D                                      InPosition,
+	const ECollisionChannel                              InTraceChannel,
+	const bool                                           bInTraceComplex,
+	const FOpenPF2PlaygroundScreenTraceCompleteDelegate& InOnTraceComplete) const
+{
+	const UOpenPF2PlaygroundMovementGridSubsystem* GridSubsystem = this->GetMovementGridForTraceChannel(InTraceChannel);
+	FVector                                        WorldOrigin,
+	                                               WorldDirection;
+
+	if (!UGameplayStatics::DeprojectScreenToWorld(this, InPosition, WorldOrigin, WorldDirection))
+	{
+		return false;
+	}
+
+	if (GridSubsystem != nullptr)
+	{
+		FHitResult HitResult;
+		const bool bHit =
+			GridSubsystem->GetHitResultForRay(WorldOrigin, WorldDirection, this->HitResultTraceDistance, HitResult);
+
+		// The grid answers right away, but callers expect the result during the next frame, like an async trace.
+		this->GetWorldTimerManager().SetTimerForNextTick(
+			FTimerDelegate::CreateWeakLambda(
+				this,
+				[InOnTraceComplete, bHit, HitResult]()
+				{
+					InOnTraceComplete.ExecuteIfBound(bHit, HitResult);
+				}
+			)
+		);
+
+		return true;
+	}
+
+	const FCollisionQueryParams CollisionQueryParams(SCENE_QUERY_STAT(ClickableTrace), bInTraceComplex);
+	const FTraceDelegate        TraceDelegate =
+		FTraceDelegate::CreateUObject(
+			this,
+			&AOpenPF2PlaygroundPlayerControllerBase::Native_OnAsyncScreenTraceComplete,
+			InOnTraceComplete
+		);
+
+	this->GetWorld()->AsyncLineTraceByChannel(
+		EAsyncTraceType::Single,
+		WorldOrigin,
+		WorldOrigin + (WorldDirection * this->HitResultTraceDistance),
+		InTraceChannel,
+		CollisionQueryParams,
+		FCollisionResponseParams::DefaultResponseParam,
+		&TraceDelegate
+	);
+
+	return true;
+}
+
+bool AOpenPF2PlaygroundPlayerControllerBase::RequestAsyncHitResultForCenterOfViewport(
+	const ECollisionChannel                              InTraceChannel,
+	const bool                                           bInTraceComplex,
+	const FOpenPF2PlaygroundScreenTraceCompleteDelegate& InOnTraceComplete) const
+{
+	return this->RequestAsyncHitResultForScreenPosition(
+		this->GetCenterOfViewport(),
+		InTraceChannel,
+		bInTraceComplex,
+		InOnTraceComplete
+	);
+}
+
 FVector2D AOpenPF2PlaygroundPlayerControllerBase::GetCenterOfViewport() const
 {
-	FVector2D                  CenterPosition;
+	FVector2D                  CenterPosition = FVector2D::ZeroVector;
 	const ULocalPlayer*        LocalPlayer    = this->GetLocalPlayer();
-	const UGameViewportClient* ViewportClient = LocalPlayer->ViewportClient;
+	const UGameViewportClient* ViewportClient = (LocalPlayer != nullptr) ? LocalPlayer->ViewportClient : nullptr;
 
-	if ((LocalPlayer != nullptr) && (ViewportClient != nullptr))
+	// Dedicated servers and headless clients have no local player or viewport to find the center of.
+	if (ViewportClient != nullptr)
 	{
 		FVector2D ViewportSize;
 
@@ -99,12 +570,340 @@ FVector2D AOpenPF2PlaygroundPlayerControllerBase::GetCenterOfViewport() const
 	return CenterPosition;
 }
 
-void AOpenPF2PlaygroundPlayerControllerBase::Multicast_DisableAutomaticCameraManagement_Implementation()
+void AOpenPF2PlaygroundPlayerControllerBase::DisableAutomaticCameraManagement(AActor* InViewTarget)
+{
+	this->SetCameraManagementState(
+		FOpenPF2PlaygroundCameraManagementState(EOpenPF2PlaygroundCameraManagementMode::Manual, InViewTarget)
+	);
+}
+
+void AOpenPF2PlaygroundPlayerControllerBase::EnableAutomaticCameraManagement()
+{
+	this->SetCameraManagementState(
+		FOpenPF2PlaygroundCameraManagementState(EOpenPF2PlaygroundCameraManagementMode::Automatic, nullptr)
+	);
+}
+
+bool AOpenPF2PlaygroundPlayerControllerBase::SetCameraManagementState(
+	const FOpenPF2PlaygroundCameraManagementState& InState)
 {
-	this->bAutoManageActiveCameraTarget = false;
+	if (this->CameraManagementState == InState)
+	{
+		// Nothing to do, so nothing to send to the client either.
+		++this->NumRedundantCameraManagementTransitions;
+		return false;
+	}
+
+	this->CameraManagementState = InState;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(AOpenPF2PlaygroundPlayerControllerBase, CameraManagementState, this);
+
+	this->ApplyCameraManagementState();
+
+	return true;
 }
 
-void AOpenPF2PlaygroundPlayerControllerBase::Multicast_EnableAutomaticCameraManagement_Implementation()
+void AOpenPF2PlaygroundPlayerControllerBase::ApplyCameraManagementState()
 {
-	this->bAutoManageActiveCameraTarget = true;
+	AActor* ViewTarget = this->CameraManagementState.ViewTarget;
+
+	++this->NumCameraManagementTransitions;
+
+	this->bAutoManageActiveCameraTarget = this->CameraManagementState.IsAutomatic();
+
+	// The view target is only changed on the machine of the owning player. Doing it on the server for a remote player
+	// would send a reliable ClientSetViewTarget() RPC, which is what replicating the state avoids in the first place.
+	if (!this->IsLocalController())
+	{
+		return;
+	}
+
+	if (this->bAutoManageActiveCameraTarget)
+	{
+		APawn* PossessedPawn = this->GetPawn();
+
+		// Return the camera to whatever we are possessing, since the manual camera target may no longer apply. If we
+		// are not possessing anything, keep the current view target rather than letting the camera fall back to this
+		// controller; the camera is managed again once something is possessed.
+		if (PossessedPawn != nullptr)
+		{
+			this->AutoManageActiveCameraTarget(PossessedPawn);
+		}
+	}
+	else if (ViewTarget != nullptr)
+	{
+		this->SetViewTarget(ViewTarget);
+	}
+}
+
+const UOpenPF2PlaygroundMovementGridSubsystem* AOpenPF2PlaygroundPlayerControllerBase::GetMovementGridForTraceChannel(
+	const ECollisionChannel InTraceChannel) const
+{
+	const UOpenPF2PlaygroundMovementGridSubsystem* GridSubsystem;
+
+	if (InTraceChannel != UOpenPF2PlaygroundMovementGridSubsystem::TraceChannel)
+	{
+		return nullptr;
+	}
+
+	GridSubsystem = this->GetWorld()->GetSubsystem<UOpenPF2PlaygroundMovementGridSubsystem>();
+
+	if ((GridSubsystem == nullptr) || !GridSubsystem->IsGridConfigured())
+	{
+		return nullptr;
+	}
+
+	return GridSubsystem;
+}
+
+FHitResult AOpenPF2PlaygroundPlayerControllerBase::TraceFromWorldRay(
+	const FOpenPF2PlaygroundScreenTraceQuery& InQuery,
+	const FVector&                           InWorldOrigin,
+	const FVector&                           InWorldDirection) const
+{
+	FHitResult                                     HitResult;
+	const UOpenPF2PlaygroundMovementGridSubsystem* GridSubsystem =
+		this->GetMovementGridForTraceChannel(InQuery.TraceChannel);
+
+	if (GridSubsystem != nullptr)
+	{
+		GridSubsystem->GetHitResultForRay(InWorldOrigin, InWorldDirection, this->HitResultTraceDistance, HitResult);
+
+		return HitResult;
+	}
+
+	const FCollisionQueryParams CollisionQueryParams(SCENE_QUERY_STAT(ClickableTrace), InQuery.bTraceComplex);
+	const bool                  bHit =
+		this->GetWorld()->LineTraceSingleByChannel(
+			HitResult,
+			InWorldOrigin,
+			InWorldOrigin + (InWorldDirection * this->HitResultTraceDistance),
+			InQuery.TraceChannel,
+			CollisionQueryParams
+		);
+
+	if (!bHit)
+	{
+		HitResult = FHitResult();
+	}
+
+	return HitResult;
+}
+
+const FHitResult* AOpenPF2PlaygroundPlayerControllerBase::FindCachedScreenTrace(
+	const FOpenPF2PlaygroundScreenTraceQuery& InQuery) const
+{
+	const FHitResult* CachedHitResult;
+
+	if (!this->bCacheScreenTraces || (this->ScreenTraceCacheFrame != GFrameCounter))
+	{
+		return nullptr;
+	}
+
+	CachedHitResult = this->ScreenTraceCache.Find(InQuery);
+
+	if (CachedHitResult != nullptr)
+	{
+		INC_DWORD_STAT(STAT_Pf2PlaygroundScreenTraceCacheHits);
+	}
+
+	return CachedHitResult;
+}
+
+void AOpenPF2PlaygroundPlayerControllerBase::CacheScreenTrace(
+	const FOpenPF2PlaygroundScreenTraceQuery& InQuery,
+	const FHitResult&                        InHitResult) const
+{
+	if (!this->bCacheScreenTraces)
+	{
+		return;
+	}
+
+	if (this->ScreenTraceCacheFrame != GFrameCounter)
+	{
+		// Results from earlier frames are stale; the camera or the world may have moved since then.
+		this->ScreenTraceCache.Reset();
+		this->ScreenTraceCacheFrame = GFrameCounter;
+	}
+
+	this->ScreenTraceCache.Add(InQuery, InHitResult);
+}
+
+void AOpenPF2PlaygroundPlayerControllerBase::Server_ExecuteQueuedAbilityCommands_Implementation(
+	const TArray<FOpenPF2PlaygroundQueuedAbilityCommand>& Commands)
+{
+	PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundExecuteQueuedAbilityCommands, ExecuteQueuedAbilityCommands);
+
+	const UOpenPF2PlaygroundMovementGridSubsystem* GridSubsystem =
+		this->GetWorld()->GetSubsystem<UOpenPF2PlaygroundMovementGridSubsystem>();
+
+	if (Commands.Num() > this->MaxQueuedAbilityCommandsPerBatch)
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Warning,
+			TEXT("[%s] Rejecting a batch of %d ability commands (at most %d are allowed)."),
+			*(this->GetName()),
+			Commands.Num(),
+			this->MaxQueuedAbilityCommandsPerBatch
+		);
+
+		return;
+	}
+
+	INC_DWORD_STAT_BY(STAT_Pf2PlaygroundQueuedAbilityCommands, Commands.Num());
+
+	for (const FOpenPF2PlaygroundQueuedAbilityCommand& Command : Commands)
+	{
+		this->ExecuteQueuedAbilityCommand(Command, GridSubsystem);
+	}
+}
+
+bool AOpenPF2PlaygroundPlayerControllerBase::ExecuteQueuedAbilityCommand(
+	const FOpenPF2PlaygroundQueuedAbilityCommand&  Command,
+	const UOpenPF2PlaygroundMovementGridSubsystem* GridSubsystem) const
+{
+	const IPF2CharacterInterface* CharacterIntf    = Cast<IPF2CharacterInterface>(Command.Character);
+	UAbilitySystemComponent*      Asc              =
+		UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Command.Character);
+	FGameplayEventData            Payload;
+	APF2CharacterCommand*         CharacterCommand;
+
+	// Clients can only command the characters in their own party.
+	if ((CharacterIntf == nullptr) || (CharacterIntf->GetPlayerController().GetObject() != this) || (Asc == nullptr))
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Warning,
+			TEXT("[%s] Ignoring a queued ability command for a character ('%s') that is not owned by this player."),
+			*(this->GetName()),
+			*GetNameSafe(Command.Character)
+		);
+
+		return false;
+	}
+
+	if (Asc->FindAbilitySpecFromHandle(Command.AbilitySpecHandle) == nullptr)
+	{
+		UE_LOG(
+			LogPf2Playground,
+			Warning,
+			TEXT("[%s] Ignoring a queued ability command for an ability ('%s') that character ('%s') does not have."),
+			*(this->GetName()),
+			*(Command.AbilitySpecHandle.ToString()),
+			*(Command.Character->GetName())
+		);
+
+		return false;
+	}
+
+	for (const FOpenPF2PlaygroundQueuedAbilityTarget& Target : Command.Targets)
+	{
+		if (Target.bHasTargetCell)
+		{
+			const FIntPoint                          TargetCell = Target.GetTargetCell();
+			FGameplayAbilityTargetData_LocationInfo* TargetLocation;
+
+			if ((GridSubsystem == nullptr) || !GridSubsystem->IsValidCell(TargetCell))
+			{
+				UE_LOG(
+					LogPf2Playground,
+					Warning,
+					TEXT(
+						"[%s] Ignoring a queued ability command that targets a cell ('%s') outside the movement "
+						"grid."
+					),
+					*(this->GetName()),
+					*(TargetCell.ToString())
+				);
+
+				return false;
+			}
+
+			TargetLocation = new FGameplayAbilityTargetData_LocationInfo();
+
+			TargetLocation->TargetLocation.LocationType     = EGameplayAbilityTargetingLocationType::LiteralTransform;
+			TargetLocation->TargetLocation.LiteralTransform = FTransform(GridSubsystem->GetCellCenter(TargetCell));
+
+			// The handle takes ownership of the target data.
+			Payload.TargetData.Add(TargetLocation);
+		}
+		else
+		{
+			FGameplayAbilityTargetData_ActorArray* TargetActors = new FGameplayAbilityTargetData_ActorArray();
+
+			// The handle takes ownership of the target data.
+			Payload.TargetData.Add(TargetActors);
+
+			for (AActor* TargetActor : Target.TargetActors)
+			{
+				// Actors can be destroyed (or fail to resolve on the server) while the command is in flight.
+				if (TargetActor == nullptr)
+				{
+					UE_LOG(
+						LogPf2Playground,
+						Warning,
+						TEXT("[%s] Ignoring a queued ability command that targets an actor that no longer exists."),
+						*(this->GetName())
+					);
+
+					return false;
+				}
+
+				TargetActors->TargetActorArray.Add(TargetActor);
+
+				if (Payload.Target == nullptr)
+				{
+					Payload.Target = TargetActor;
+				}
+			}
+		}
+	}
+
+	Payload.Instigator = Command.Character;
+
+	if (Payload.Target == nullptr)
+	{
+		Payload.Target = Command.Character;
+	}
+
+	// Hand the command to the same pipeline as a command that arrived on its own, so that the rule set of the current
+	// mode of play decides whether it executes now or is queued until the turn of the character (and so that it shows
+	// up in the command queue of the character either way).
+	CharacterCommand = APF2CharacterCommand::Create(Command.Character, Command.AbilitySpecHandle, Payload);
+
+	if (CharacterCommand == nullptr)
+	{
+		return false;
+	}
+
+	CharacterCommand->AttemptExecuteOrQueue();
+
+	return true;
+}
+
+void AOpenPF2PlaygroundPlayerControllerBase::OnRep_CameraManagementState()
+{
+	this->ApplyCameraManagementState();
+}
+
+void AOpenPF2PlaygroundPlayerControllerBase::Native_OnAsyncScreenTraceComplete(
+	const FTraceHandle&                                  TraceHandle,
+	FTraceDatum&                                         TraceDatum,
+	const FOpenPF2PlaygroundScreenTraceCompleteDelegate& OnTraceComplete) const
+{
+	FHitResult HitResult;
+	bool       bHit = false;
+
+	for (const FHitResult& CurrentHitResult : TraceDatum.OutHits)
+	{
+		if (CurrentHitResult.bBlockingHit)
+		{
+			HitResult = CurrentHitResult;
+			bHit      = true;
+			break;
+		}
+	}
+
+	OnTraceComplete.ExecuteIfBound(bHit, HitResult);
 }
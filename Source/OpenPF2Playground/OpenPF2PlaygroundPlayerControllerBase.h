@@ -5,13 +5,39 @@
 
 #pragma once
 
+#include <WorldCollision.h>
+
+#include "OpenPF2PlaygroundCameraManagementState.h"
+#include "OpenPF2PlaygroundQueuedAbilityCommand.h"
+#include "OpenPF2PlaygroundScreenTraceQuery.h"
+#include "PF2GameStateInterface.h"
 #include "PF2PlayerControllerBase.h"
+
 #include "OpenPF2PlaygroundPlayerControllerBase.generated.h"
 
 // =====================================================================================================================
 // Forward Declarations (to minimize header dependencies)
 // =====================================================================================================================
 class UEnhancedInputComponent;
+class UOpenPF2PlaygroundMovementGridSubsystem;
+struct FGameplayAbilityTargetDataHandle;
+
+// =====================================================================================================================
+// Delegate Types
+// =====================================================================================================================
+/**
+ * Delegate for Blueprints to react to the completion of an asynchronous screen-space trace.
+ *
+ * @param bHit
+ *	Whether the collision trace was successful (intersected world geometry).
+ * @param HitResult
+ *	The hit result. If the trace did not intersect world geometry, the result is reset.
+ */
+DECLARE_DYNAMIC_DELEGATE_TwoParams(
+	FOpenPF2PlaygroundScreenTraceCompleteDelegate,
+	bool,              bHit,
+	const FHitResult&, HitResult
+);
 
 // =====================================================================================================================
 // Normal Declarations
@@ -41,6 +67,110 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
 	float BaseLookUpRate;
 
+	/**
+	 * How the camera target of the player is being managed.
+	 *
+	 * This is only replicated to the player who owns this controller, and only when it changes. Players who join or
+	 * reconnect in the middle of an encounter receive the current state along with the rest of the controller.
+	 *
+	 * The bytes saved over the reliable multicast RPCs that this replaces have not been measured yet. Compare the
+	 * outgoing bytes on the server in 'stat Net' or Network Insights during a mode-switch stress test to measure them.
+	 */
+	UPROPERTY(ReplicatedUsing=OnRep_CameraManagementState, BlueprintReadOnly, Category=Camera)
+	FOpenPF2PlaygroundCameraManagementState CameraManagementState;
+
+	/**
+	 * The number of times that the camera management state of this controller has actually changed.
+	 */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category=Camera)
+	int32 NumCameraManagementTransitions;
+
+	/**
+	 * The number of requests to change camera management that were skipped because they would not change anything.
+	 */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category=Camera)
+	int32 NumRedundantCameraManagementTransitions;
+
+	/**
+	 * Whether the results of screen-space traces should be cached for the rest of the frame in which they are made.
+	 *
+	 * When this is enabled, repeated traces for the same screen position, trace channel, and complexity during the same
+	 * frame (e.g., from several Blueprints that each need to know what is under the cursor) re-use the result of the
+	 * first trace instead of tracing again.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="OpenPF2 Playground|Targeting")
+	bool bCacheScreenTraces;
+
+	/**
+	 * The results of screen-space traces that have already been performed during the current frame.
+	 */
+	mutable TMap<FOpenPF2PlaygroundScreenTraceQuery, FHitResult> ScreenTraceCache;
+
+	/**
+	 * The frame number for which the results in the screen trace cache were captured.
+	 */
+	mutable uint64 ScreenTraceCacheFrame;
+
+	/**
+	 * Characters that have been given to this player controller during the current frame, but whose ownership has not
+	 * yet been acknowledged.
+	 *
+	 * These are acknowledged together at the end of the frame, so that a party that is given to this player controller
+	 * all at once is handed over as a single batch.
+	 */
+	UPROPERTY()
+	TArray<TScriptInterface<IPF2CharacterInterface>> CharactersAwaitingAcknowledgement;
+
+	/**
+	 * The handle of the end-of-frame callback that acknowledges the characters given during the current frame (if any).
+	 */
+	FDelegateHandle AcknowledgeGivenCharactersHandle;
+
+	/**
+	 * Characters owned by this player controller that have not yet had their abilities bound to input.
+	 *
+	 * Loading input bindings and listening for ability changes are deferred for characters that are not possessed at
+	 * the time that ownership of them is acknowledged. Both happen once this player controller possesses them, or once
+	 * this player controller stops possessing characters (e.g., when entering Encounter mode).
+	 */
+	UPROPERTY()
+	TArray<TScriptInterface<IPF2CharacterInterface>> CharactersAwaitingInputBindings;
+
+	/**
+	 * How long (in seconds) it took to acknowledge ownership of the last batch of characters given to this player
+	 * controller, from the first character of the batch to the last.
+	 */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="OpenPF2 Playground|Player Controllers")
+	float LastPartyHandoverTime;
+
+	/**
+	 * Whether commands queued during a frame should be sent to the server automatically at the start of the next frame.
+	 *
+	 * If this is disabled, queued commands are only sent when FlushQueuedAbilityCommands() is called (e.g., when the
+	 * player ends their turn), so that all the commands for a turn are sent in a single RPC.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="OpenPF2 Playground|Encounters")
+	bool bFlushQueuedAbilityCommandsEachFrame;
+
+	/**
+	 * The most commands that can be sent to the server in a single batch.
+	 *
+	 * Queuing more commands than this flushes the queue early. The server rejects larger batches outright.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="OpenPF2 Playground|Encounters", meta=(ClampMin=1))
+	int32 MaxQueuedAbilityCommandsPerBatch;
+
+	/**
+	 * Ability commands that have been queued by the player but not yet sent to the server.
+	 */
+	UPROPERTY()
+	TArray<FOpenPF2PlaygroundQueuedAbilityCommand> QueuedAbilityCommands;
+
+	/**
+	 * The handle of the timer for sending queued ability commands to the server (if any).
+	 */
+	FTimerHandle QueuedAbilityCommandsHandle;
+
 public:
 	// =================================================================================================================
 	// Public Constructors
@@ -53,8 +183,66 @@ public:
 	// =================================================================================================================
 	// Public Methods - APF2PlayerControllerBase Overrides
 	// =================================================================================================================
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	virtual void SetPawn(APawn* InPawn) override;
 
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Asks the server to switch the game into the given mode of play, on behalf of a network load test bot.
+	 *
+	 * This is only honored by servers that were launched with "-Pf2NetLoadTest" (see
+	 * UOpenPF2PlaygroundNetLoadTestCommandlet), so that bots can drive the same transitions that the game mode would
+	 * normally drive without giving ordinary players control over the mode of play.
+	 *
+	 * This does nothing in Shipping builds, and Shipping servers disconnect any client that calls it. (UHT does not
+	 * allow RPCs to be declared conditionally, so only the implementation is compiled out.)
+	 *
+	 * @param ModeOfPlay
+	 *	The mode of play to request. Only Encounter and Exploration are supported.
+	 */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void Server_RequestModeOfPlayForLoadTest(const EPF2ModeOfPlayType ModeOfPlay);
+
+	/**
+	 * Notifies this player controller that the player is about to ask to swap to a different character.
+	 *
+	 * This must be invoked on the machine of the player right before the request to possess the other character is
+	 * sent, so that the latency of the swap is measured from the moment that the player asked for it rather than from
+	 * whenever the change of pawn happens to replicate.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Characters")
+	void NotifyPossessionSwapRequested();
+
+	/**
+	 * Queues a command to activate an ability of a character, to be sent to the server along with other commands.
+	 *
+	 * The current target selection of this player controller is read directly into the command. A character being
+	 * targeted (e.g., an enemy being attacked) is sent as a reference, while a location is quantized to the cell of
+	 * the movement grid that contains it. Commands are sent in the order that they were queued, in a single RPC,
+	 * either at the start of the next frame or when FlushQueuedAbilityCommands() is called (see
+	 * bFlushQueuedAbilityCommandsEachFrame).
+	 *
+	 * @param Character
+	 *	The character whose ability is to be activated.
+	 * @param AbilitySpecHandle
+	 *	The handle of the ability to activate, in the ASC of the character.
+	 *
+	 * @return
+	 *	true if the command was queued; or, false if the target selection is neither a character nor a location that
+	 *	can be quantized to a cell of the movement grid, in which case the caller should activate the ability without
+	 *	batching.
+	 */
+	bool QueueAbilityCommand(AActor* Character, const FGameplayAbilitySpecHandle AbilitySpecHandle);
+
+	/**
+	 * Sends all queued ability commands to the server in a single RPC.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Encounters")
+	void FlushQueuedAbilityCommands();
+
 protected:
 	// =================================================================================================================
 	// Protected Methods - APF2PlayerControllerBase Overrides
@@ -62,6 +250,11 @@ protected:
 	virtual void Native_OnCharacterGiven(const TScriptInterface<IPF2CharacterQueueInterface>& CharacterQueueComponent,
 	                                     const TScriptInterface<IPF2CharacterInterface>&      GivenCharacter) override;
 
+	// =================================================================================================================
+	// Protected Methods - AActor Overrides
+	// =================================================================================================================
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// =================================================================================================================
 	// Protected Methods
 	// =================================================================================================================
@@ -85,12 +278,43 @@ protected:
 	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Player Controllers")
 	void AcknowledgeOwnership(TScriptInterface<IPF2CharacterInterface> InCharacter) const;
 
+	/**
+	 * Acknowledges that this player controller owns/can control all of the specified characters.
+	 *
+	 * This has the same effect as calling AcknowledgeOwnership() for each character, except that loading input bindings
+	 * and listening for ability changes are deferred for each character that is not currently possessed by this player
+	 * controller until it is possessed by this player controller or this player controller stops possessing characters
+	 * altogether. This makes handing over an entire party (e.g., at the start of a match) cheaper, since input bindings
+	 * are only loaded for the characters that the player is actually controlling.
+	 *
+	 * @param InCharacters
+	 *	The characters of which this player controller is taking ownership.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Player Controllers")
+	void AcknowledgeOwnershipOfParty(const TArray<TScriptInterface<IPF2CharacterInterface>>& InCharacters);
+
+	/**
+	 * Acknowledges ownership of all of the characters that were given to this player controller during this frame.
+	 */
+	void AcknowledgeGivenCharacters();
+
+	/**
+	 * Loads input bindings for characters whose bindings were deferred, if they are now being used.
+	 *
+	 * Bindings are loaded for the currently-possessed character if its bindings were deferred, or for all characters
+	 * with deferred bindings if this player controller is not possessing any character.
+	 */
+	void LoadDeferredInputBindings();
+
 	/**
 	 * Performs a collision query on a trace channel using a specific point in screen space.
 	 *
 	 * The upper-left corner of the screen is (0, 0). Positive X numbers move further right, while positive Y numbers
 	 * move further down.
 	 *
+	 * Queries on the MovementGrid trace channel are answered by the movement grid subsystem without tracing against
+	 * collision, if the grid of the level has been configured.
+	 *
 	 * @param InPosition
 	 *	The position to project into the game world.
 	 * @param InTraceChannel
@@ -117,6 +341,122 @@ protected:
 		UPARAM(DisplayName="Hit Result")
 		FHitResult& OutHitResult) const;
 
+	/**
+	 * Performs collision queries for several points in screen space at once.
+	 *
+	 * Duplicate queries are only traced once, and each distinct screen position is only projected into the game world
+	 * once no matter how many trace channels are queried for it. If screen trace caching is enabled, results traced
+	 * earlier in the same frame are re-used as well.
+	 *
+	 * @param InQueries
+	 *	The screen positions, trace channels, and trace complexity of each query.
+	 * @param OutHitResults
+	 *	The hit result for each query, in the same order as the queries. If a query did not intersect world geometry,
+	 *	its hit result is reset.
+	 *
+	 * @return
+	 *	The number of queries that intersected world geometry.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Player Controllers")
+	int32 GetHitResultsForScreenPositions(
+		UPARAM(DisplayName="Queries")
+		const TArray<FOpenPF2PlaygroundScreenTraceQuery>& InQueries,
+
+		UPARAM(DisplayName="Hit Results")
+		TArray<FHitResult>& OutHitResults) const;
+
+	/**
+	 * Gets the cell of the movement grid that is under a specific point in screen space.
+	 *
+	 * Unlike tracing against the MovementGrid trace channel, this does not perform a collision query. Instead, the
+	 * screen position is projected into the game world and then intersected with the plane of the movement grid
+	 * analytically. The movement grid must have been configured in the movement grid subsystem of the world.
+	 *
+	 * @param InPosition
+	 *	The position to project into the game world.
+	 * @param OutCell
+	 *	The coordinate of the cell under the screen position.
+	 * @param OutLocation
+	 *	The location, in world space, at which the screen position intersects the plane of the movement grid.
+	 *
+	 * @return
+	 *	Whether the screen position is over a cell of the movement grid.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Player Controllers")
+	bool GetMovementGridCellForScreenPosition(
+		UPARAM(DisplayName="Position")
+		const FVector2D InPosition,
+
+		UPARAM(DisplayName="Cell")
+		FIntPoint& OutCell,
+
+		UPARAM(DisplayName="Location")
+		FVector& OutLocation) const;
+
+	/**
+	 * Performs a collision query on a trace channel using a specific point in screen space, without blocking the game
+	 * thread.
+	 *
+	 * The screen position is projected into the game world immediately, but the trace itself is run through the async
+	 * trace API of the world. The result is delivered to the given callback during the next frame. This is intended for
+	 * queries that are performed every frame (e.g., hover targeting under the cursor) and that can tolerate the result
+	 * lagging by a frame. Queries on the MovementGrid trace channel are answered by the movement grid subsystem instead
+	 * (if the grid of the level has been configured), but are still delivered during the next frame.
+	 *
+	 * @param InPosition
+	 *	The position to project into the game world.
+	 * @param InTraceChannel
+	 *	The channel on which to perform the trace.
+	 * @param bInTraceComplex
+	 *	Whether to perform the trace against complex collision or simple collision.
+	 * @param InOnTraceComplete
+	 *	The callback to invoke with the result of the trace.
+	 *
+	 * @return
+	 *	Whether the trace was started. If the screen position could not be projected into the game world, no trace is
+	 *	performed and the callback is not invoked.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Player Controllers", meta=(bInTraceComplex=true))
+	bool RequestAsyncHitResultForScreenPosition(
+		UPARAM(DisplayName="Position")
+		const FVector2D InPosition,
+
+		UPARAM(DisplayName="Trace Channel")
+		const ECollisionChannel InTraceChannel,
+
+		UPARAM(DisplayName="Trace Complex")
+		const bool bInTraceComplex,
+
+		UPARAM(DisplayName="On Trace Complete")
+		const FOpenPF2PlaygroundScreenTraceCompleteDelegate& InOnTraceComplete) const;
+
+	/**
+	 * Performs a collision query on a trace channel from the center of the viewport, without blocking the game thread.
+	 *
+	 * The result is delivered to the given callback during the next frame.
+	 *
+	 * @param InTraceChannel
+	 *	The channel on which to perform the trace.
+	 * @param bInTraceComplex
+	 *	Whether to perform the trace against complex collision or simple collision.
+	 * @param InOnTraceComplete
+	 *	The callback to invoke with the result of the trace.
+	 *
+	 * @return
+	 *	Whether the trace was started. If the center of the viewport could not be projected into the game world, no
+	 *	trace is performed and the callback is not invoked.
+	 */
+	UFUNCTION(BlueprintCallable, Category="OpenPF2 Playground|Player Controllers", meta=(bInTraceComplex=true))
+	bool RequestAsyncHitResultForCenterOfViewport(
+		UPARAM(DisplayName="Trace Channel")
+		const ECollisionChannel InTraceChannel,
+
+		UPARAM(DisplayName="Trace Complex")
+		const bool bInTraceComplex,
+
+		UPARAM(DisplayName="On Trace Complete")
+		const FOpenPF2PlaygroundScreenTraceCompleteDelegate& InOnTraceComplete) const;
+
 	/**
 	 * Gets a vector representing the position (in pixels) of the center of the game viewport.
 	 *
@@ -129,14 +469,150 @@ protected:
 	/**
 	 * Stop this player controller from managing the camera target during the possession of pawns.
 	 *
-	 * This allows camera targets to be managed manually.
+	 * This allows camera targets to be managed manually. The change replicates to the owning player; requests that
+	 * would not change the current state are ignored.
+	 *
+	 * @param InViewTarget
+	 *	The actor to use as the camera target while the camera is being managed manually. Can be nullptr to leave the
+	 *	current camera target as-is.
 	 */
-	UFUNCTION(BlueprintCallable, NetMulticast, Reliable, Category="OpenPF2 Playground|Player Controllers")
-	void Multicast_DisableAutomaticCameraManagement();
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="OpenPF2 Playground|Player Controllers")
+	void DisableAutomaticCameraManagement(AActor* InViewTarget = nullptr);
 
 	/**
 	 * Resume having this player controller manage the camera target during the possession of pawns.
+	 *
+	 * The camera target is returned to the pawn that this controller is currently possessing, if any. The change
+	 * replicates to the owning player; requests that would not change the current state are ignored.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="OpenPF2 Playground|Player Controllers")
+	void EnableAutomaticCameraManagement();
+
+	/**
+	 * Changes how the camera target of the player is being managed.
+	 *
+	 * @param InState
+	 *	The new camera management state.
+	 *
+	 * @return
+	 *	true if the state was changed; or, false if this controller was already in the requested state.
+	 */
+	bool SetCameraManagementState(const FOpenPF2PlaygroundCameraManagementState& InState);
+
+	/**
+	 * Applies the current camera management state to this controller and its camera manager.
+	 */
+	void ApplyCameraManagementState();
+
+	/**
+	 * Gets the movement grid that answers queries on the given trace channel.
+	 *
+	 * @param InTraceChannel
+	 *	The channel on which a trace is to be performed.
+	 *
+	 * @return
+	 *	The movement grid subsystem of the world, if the channel is the MovementGrid trace channel and the grid has been
+	 *	configured; or, nullptr if the query must be traced against collision.
+	 */
+	const UOpenPF2PlaygroundMovementGridSubsystem* GetMovementGridForTraceChannel(
+		const ECollisionChannel InTraceChannel) const;
+
+	/**
+	 * Performs a collision query from a point in screen space that has already been projected into the game world.
+	 *
+	 * @param InQuery
+	 *	The query being performed.
+	 * @param InWorldOrigin
+	 *	The origin of the query in world space.
+	 * @param InWorldDirection
+	 *	The direction of the query in world space.
+	 *
+	 * @return
+	 *	The hit result of the trace. If the trace did not intersect world geometry, the result is reset.
+	 */
+	FHitResult TraceFromWorldRay(const FOpenPF2PlaygroundScreenTraceQuery& InQuery,
+	                             const FVector&                           InWorldOrigin,
+	                             const FVector&                           InWorldDirection) const;
+
+	/**
+	 * Looks up the result of a trace performed earlier during the current frame.
+	 *
+	 * @param InQuery
+	 *	The query for which a result is desired.
+	 *
+	 * @return
+	 *	Either a pointer to the cached result; or, nullptr if the query has not been traced during this frame or screen
+	 *	trace caching is disabled.
+	 */
+	const FHitResult* FindCachedScreenTrace(const FOpenPF2PlaygroundScreenTraceQuery& InQuery) const;
+
+	/**
+	 * Records the result of a trace for re-use during the rest of the current frame.
+	 *
+	 * @param InQuery
+	 *	The query that was traced.
+	 * @param InHitResult
+	 *	The result of the trace.
+	 */
+	void CacheScreenTrace(const FOpenPF2PlaygroundScreenTraceQuery& InQuery, const FHitResult& InHitResult) const;
+
+	/**
+	 * Submits, on the server, a batch of ability commands queued by the player who owns this controller.
+	 *
+	 * Commands are submitted in the order in which they were queued. Commands for characters that this controller does
+	 * not own, or for abilities that the character does not have, are skipped.
+	 *
+	 * @param Commands
+	 *	The commands to execute.
+	 */
+	UFUNCTION(Server, Reliable)
+	void Server_ExecuteQueuedAbilityCommands(const TArray<FOpenPF2PlaygroundQueuedAbilityCommand>& Commands);
+
+	/**
+	 * Expands a single queued command back into an OpenPF2 character command, and submits it.
+	 *
+	 * Target cells become location target data at the center of the cell, and target actors become actor array target
+	 * data. The first target actor (if any) is also used as the target of the payload of the command.
+	 *
+	 * The character command is handed to the same pipeline as a command that the player submits on its own, so the
+	 * rule set of the current mode of play still decides whether the ability is activated immediately or queued until
+	 * the turn of the character. Batching only saves RPCs; it never lets an ability skip turn order.
+	 *
+	 * @param Command
+	 *	The command to execute.
+	 * @param GridSubsystem
+	 *	The movement grid of this world, used to locate the center of each target cell. Can be nullptr if the grid is
+	 *	not available, in which case commands that target a cell are skipped.
+	 *
+	 * @return
+	 *	true if the command was submitted to the rule set; or, false if it was skipped.
+	 */
+	bool ExecuteQueuedAbilityCommand(const FOpenPF2PlaygroundQueuedAbilityCommand& Command,
+	                                 const UOpenPF2PlaygroundMovementGridSubsystem* GridSubsystem) const;
+
+	// =================================================================================================================
+	// Protected Replication Callbacks
+	// =================================================================================================================
+	/**
+	 * Callback invoked when the camera management state of this controller is replicated to the owning player.
+	 */
+	UFUNCTION()
+	void OnRep_CameraManagementState();
+
+	// =================================================================================================================
+	// Protected Native Event Callbacks
+	// =================================================================================================================
+	/**
+	 * Native callback invoked by the world when an asynchronous screen-space trace has completed.
+	 *
+	 * @param TraceHandle
+	 *	The handle of the trace that has completed.
+	 * @param TraceDatum
+	 *	The inputs and results of the trace.
+	 * @param OnTraceComplete
+	 *	The callback that was provided when the trace was requested.
 	 */
-	UFUNCTION(BlueprintCallable, NetMulticast, Reliable, Category="OpenPF2 Playground|Player Controllers")
-	void Multicast_EnableAutomaticCameraManagement();
+	void Native_OnAsyncScreenTraceComplete(const FTraceHandle&                                  TraceHandle,
+	                                       FTraceDatum&                                         TraceDatum,
+	                                       const FOpenPF2PlaygroundScreenTraceCompleteDelegate& OnTraceComplete) const;
 };
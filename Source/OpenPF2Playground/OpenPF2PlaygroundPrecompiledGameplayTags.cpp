@@ -0,0 +1,118 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundPrecompiledGameplayTags.h"
+
+#include <GameplayTagsManager.h>
+
+#include <Engine/DataTable.h>
+
+FOpenPF2PlaygroundPrecompiledGameplayTags FOpenPF2PlaygroundPrecompiledGameplayTags::CaptureFromManager()
+{
+	const UGameplayTagsManager&               TagsManager = UGameplayTagsManager::Get();
+	FOpenPF2PlaygroundPrecompiledGameplayTags Table;
+
+	for (const TSharedPtr<FGameplayTagNode>& Node : TagsManager.GetNetworkGameplayTagNodeIndex())
+	{
+		bool bIsPrecompiledTag;
+
+		if (!Node.IsValid())
+		{
+			continue;
+		}
+
+		bIsPrecompiledTag = Node->IsExplicitTag();
+
+#if WITH_EDITORONLY_DATA
+		// Native tags are registered by the code that declares them in every build, so they must not be precompiled;
+		// otherwise, tags declared by editor-only modules would end up in builds that do not have those modules.
+		for (const FName& SourceName : Node->GetAllSourceNames())
+		{
+			const FGameplayTagSource* Source = TagsManager.FindTagSource(SourceName);
+
+			if ((Source != nullptr) && (Source->SourceType == EGameplayTagSourceType::Native))
+			{
+				bIsPrecompiledTag = false;
+				break;
+			}
+		}
+#endif
+
+		Table.TagNames.Add(Node->GetCompleteTagName());
+		Table.ExplicitTagFlags.Add(bIsPrecompiledTag);
+	}
+
+	Table.NetworkIndexHash = TagsManager.GetNetworkGameplayTagNodeIndexHash();
+
+	return Table;
+}
+
+int32 FOpenPF2PlaygroundPrecompiledGameplayTags::GetNumExplicitTags() const
+{
+	int32 NumExplicitTags = 0;
+
+	for (const bool bIsExplicitTag : this->ExplicitTagFlags)
+	{
+		if (bIsExplicitTag)
+		{
+			++NumExplicitTags;
+		}
+	}
+
+	return NumExplicitTags;
+}
+
+void FOpenPF2PlaygroundPrecompiledGameplayTags::WriteToDataTable(UDataTable& DataTable) const
+{
+	DataTable.EmptyTable();
+	DataTable.RowStruct = FGameplayTagTableRow::StaticStruct();
+
+	for (int32 TagIndex = 0; TagIndex < this->TagNames.Num(); ++TagIndex)
+	{
+		if (this->ExplicitTagFlags[TagIndex])
+		{
+			const FName TagName = this->TagNames[TagIndex];
+
+			DataTable.AddRow(TagName, FGameplayTagTableRow(TagName));
+		}
+	}
+}
+
+bool FOpenPF2PlaygroundPrecompiledGameplayTags::MatchesDataTable(const UDataTable& DataTable) const
+{
+	TSet<FName> ExplicitTagNames;
+	bool        bAllRowsMatch = true;
+
+	if (DataTable.GetRowStruct() != FGameplayTagTableRow::StaticStruct())
+	{
+		return false;
+	}
+
+	for (int32 TagIndex = 0; TagIndex < this->TagNames.Num(); ++TagIndex)
+	{
+		if (this->ExplicitTagFlags[TagIndex])
+		{
+			ExplicitTagNames.Add(this->TagNames[TagIndex]);
+		}
+	}
+
+	if (DataTable.GetRowMap().Num() != ExplicitTagNames.Num())
+	{
+		return false;
+	}
+
+	DataTable.ForeachRow<FGameplayTagTableRow>(
+		TEXT("FOpenPF2PlaygroundPrecompiledGameplayTags::MatchesDataTable"),
+		[&ExplicitTagNames, &bAllRowsMatch](const FName& RowName, const FGameplayTagTableRow& Row)
+		{
+			if (!ExplicitTagNames.Contains(Row.Tag))
+			{
+				bAllRowsMatch = false;
+			}
+		}
+	);
+
+	return bAllRowsMatch;
+}
@@ -0,0 +1,115 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include "OpenPF2PlaygroundPrecompiledGameplayTags.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class UDataTable;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * The merged gameplay tag tree of the project, as captured from the gameplay tag manager.
+ *
+ * The explicit tags of the tree are precompiled into a gameplay tag data table, which the gameplay tag manager loads
+ * by itself while it constructs the tag tree (see "GameplayTagTableList" in the gameplay tag settings). Builds that do
+ * not import tags from config can therefore still request any tag of the project as soon as the manager exists,
+ * including from CDOs and plugins that are loaded before the game module.
+ *
+ * Since the manager builds its network index by sorting tag names, a data table with the same explicit tags produces
+ * the same index (and hash) as the ini files from which the tags were captured. The hash is kept so that this can be
+ * confirmed, since clients and servers with different indices cannot replicate tags to each other.
+ */
+USTRUCT()
+struct OPENPF2PLAYGROUND_API FOpenPF2PlaygroundPrecompiledGameplayTags
+{
+	GENERATED_BODY()
+
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * The hash of the network index of the gameplay tag manager that captured this table.
+	 */
+	UPROPERTY()
+	uint32 NetworkIndexHash;
+
+	/**
+	 * The complete name of every tag in the tree, in network index order.
+	 */
+	UPROPERTY()
+	TArray<FName> TagNames;
+
+	/**
+	 * Whether each tag in TagNames was declared explicitly in config (true), or was either declared natively (in code)
+	 * or only exists as the parent of another tag (false).
+	 *
+	 * Only the tags that were declared explicitly in config need to be precompiled.
+	 */
+	UPROPERTY()
+	TArray<bool> ExplicitTagFlags;
+
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor for FOpenPF2PlaygroundPrecompiledGameplayTags.
+	 */
+	explicit FOpenPF2PlaygroundPrecompiledGameplayTags() : NetworkIndexHash(0)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Static Methods
+	// =================================================================================================================
+	/**
+	 * Captures the current tag tree of the gameplay tag manager.
+	 *
+	 * @return
+	 *	A table containing every tag known to the manager, in network index order.
+	 */
+	static FOpenPF2PlaygroundPrecompiledGameplayTags CaptureFromManager();
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Gets the number of tags in this table that were declared explicitly in config.
+	 *
+	 * @return
+	 *	The number of explicit tags, which is the number of rows needed to precompile this table into a data table.
+	 */
+	int32 GetNumExplicitTags() const;
+
+	/**
+	 * Replaces the rows of a gameplay tag data table with the explicit tags of this table.
+	 *
+	 * Parents are added to the tag tree along with their children, and native tags are registered by the code that
+	 * declares them, so only tags that were declared explicitly in config are written.
+	 *
+	 * @param DataTable
+	 *	The data table to overwrite. Its row structure is set to FGameplayTagTableRow.
+	 */
+	void WriteToDataTable(UDataTable& DataTable) const;
+
+	/**
+	 * Determines whether a gameplay tag data table declares exactly the explicit tags of this table.
+	 *
+	 * @param DataTable
+	 *	The data table to check.
+	 *
+	 * @return
+	 *	true if the data table is a gameplay tag table that declares the same explicit tags as this table; or, false if
+	 *	it is not a gameplay tag table, or tags have been added or removed since it was written (i.e., it is stale).
+	 */
+	bool MatchesDataTable(const UDataTable& DataTable) const;
+};
@@ -0,0 +1,172 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <GameplayAbilitySpecHandle.h>
+
+#include <GameFramework/Actor.h>
+
+#include "OpenPF2PlaygroundQueuedAbilityCommand.generated.h"
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * One target of a queued ability command, mirroring a single entry of the target data of the ability activation.
+ *
+ * Actors being targeted (e.g., an enemy being attacked) are sent as references. Locations being targeted are not sent
+ * as a full hit result; instead, they are quantized to the cell of the movement grid that contains them. Cells are
+ * sent as 16-bit coordinates and are expanded back into a location at the center of the cell on the server.
+ */
+USTRUCT()
+struct FOpenPF2PlaygroundQueuedAbilityTarget
+{
+	GENERATED_BODY()
+
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * The actors being targeted (if any).
+	 */
+	UPROPERTY()
+	TArray<AActor*> TargetActors;
+
+	/**
+	 * The X coordinate of the movement grid cell being targeted (if any).
+	 */
+	UPROPERTY()
+	int16 TargetCellX;
+
+	/**
+	 * The Y coordinate of the movement grid cell being targeted (if any).
+	 */
+	UPROPERTY()
+	int16 TargetCellY;
+
+	/**
+	 * Whether this target is a cell of the movement grid rather than a set of actors.
+	 */
+	UPROPERTY()
+	bool bHasTargetCell;
+
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor for FOpenPF2PlaygroundQueuedAbilityTarget.
+	 */
+	explicit FOpenPF2PlaygroundQueuedAbilityTarget() :
+		TargetCellX(0),
+		TargetCellY(0),
+		bHasTargetCell(false)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Static Methods
+	// =================================================================================================================
+	/**
+	 * Determines whether a cell of the movement grid can be represented in a queued command.
+	 *
+	 * @param InCell
+	 *	The cell to check.
+	 *
+	 * @return
+	 *	true if both coordinates of the cell fit in 16 bits; or, false otherwise.
+	 */
+	FORCEINLINE static bool CanQuantizeCell(const FIntPoint& InCell)
+	{
+		return (InCell.X >= MIN_int16) && (InCell.X <= MAX_int16) && (InCell.Y >= MIN_int16) && (InCell.Y <= MAX_int16);
+	}
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Gets the cell of the movement grid being targeted.
+	 *
+	 * @return
+	 *	The targeted cell. This is only meaningful if bHasTargetCell is true.
+	 */
+	FORCEINLINE FIntPoint GetTargetCell() const
+	{
+		return FIntPoint(this->TargetCellX, this->TargetCellY);
+	}
+
+	/**
+	 * Sets the cell of the movement grid being targeted.
+	 *
+	 * @param InCell
+	 *	The targeted cell. The caller must ensure that the cell can be quantized (see CanQuantizeCell()).
+	 */
+	FORCEINLINE void SetTargetCell(const FIntPoint& InCell)
+	{
+		check(CanQuantizeCell(InCell));
+
+		this->TargetCellX    = static_cast<int16>(InCell.X);
+		this->TargetCellY    = static_cast<int16>(InCell.Y);
+		this->bHasTargetCell = true;
+	}
+};
+
+/**
+ * A command to activate an ability of a character, queued by a player to be sent to the server in a batch.
+ *
+ * Every entry of the target data of the ability activation is carried as a compact target (see
+ * FOpenPF2PlaygroundQueuedAbilityTarget), in the same order, so that the server can rebuild equivalent target data.
+ */
+USTRUCT()
+struct FOpenPF2PlaygroundQueuedAbilityCommand
+{
+	GENERATED_BODY()
+
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * The character whose ability is to be activated.
+	 */
+	UPROPERTY()
+	AActor* Character;
+
+	/**
+	 * The handle of the ability to activate, in the ASC of the character.
+	 */
+	UPROPERTY()
+	FGameplayAbilitySpecHandle AbilitySpecHandle;
+
+	/**
+	 * The targets of the ability, one for each entry in the target data of the activation.
+	 */
+	UPROPERTY()
+	TArray<FOpenPF2PlaygroundQueuedAbilityTarget> Targets;
+
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor for FOpenPF2PlaygroundQueuedAbilityCommand.
+	 */
+	explicit FOpenPF2PlaygroundQueuedAbilityCommand() : Character(nullptr)
+	{
+	}
+
+	/**
+	 * Constructor for FOpenPF2PlaygroundQueuedAbilityCommand, for a command that does not (yet) have any targets.
+	 *
+	 * @param Character
+	 *	The character whose ability is to be activated.
+	 * @param AbilitySpecHandle
+	 *	The handle of the ability to activate, in the ASC of the character.
+	 */
+	explicit FOpenPF2PlaygroundQueuedAbilityCommand(AActor*                          Character,
+	                                                const FGameplayAbilitySpecHandle AbilitySpecHandle) :
+		Character(Character),
+		AbilitySpecHandle(AbilitySpecHandle)
+	{
+	}
+};
@@ -0,0 +1,221 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundReplicationGraph.h"
+
+#include <Engine/NetConnection.h>
+#include <Engine/NetDriver.h>
+#include <Engine/World.h>
+
+#include <GameFramework/PlayerController.h>
+
+#include "OpenPF2PlaygroundCharacterBase.h"
+#include "OpenPF2PlaygroundGameState.h"
+#include "OpenPF2PlaygroundReplicationGraphNode_Encounter.h"
+#include "OpenPF2PlaygroundReplicationGraphNode_Party.h"
+
+void UOpenPF2PlaygroundReplicationGraph::NotifyCharacterPartyChanged(AActor* Character)
+{
+	const UWorld*                       World = (Character != nullptr) ? Character->GetWorld() : nullptr;
+	const UNetDriver*                   NetDriver;
+	UOpenPF2PlaygroundReplicationGraph* Graph;
+
+	if ((World == nullptr) || !Character->HasAuthority())
+	{
+		return;
+	}
+
+	NetDriver = World->GetNetDriver();
+	Graph     =
+		(NetDriver != nullptr) ? NetDriver->GetReplicationDriver<UOpenPF2PlaygroundReplicationGraph>() : nullptr;
+
+	if ((Graph != nullptr) && Graph->PlaygroundCharacters.Contains(Character))
+	{
+		Graph->UpdateCharacterParty(Character);
+
+		if (Graph->EncounterCombatants.Contains(Character))
+		{
+			Graph->UpdateEncounterParticipants();
+		}
+	}
+}
+
+void UOpenPF2PlaygroundReplicationGraph::NotifyEncounterRosterChanged(const AOpenPF2PlaygroundGameState* GameState)
+{
+	const UWorld*                       World = (GameState != nullptr) ? GameState->GetWorld() : nullptr;
+	const UNetDriver*                   NetDriver;
+	UOpenPF2PlaygroundReplicationGraph* Graph;
+
+	if ((World == nullptr) || !GameState->HasAuthority())
+	{
+		return;
+	}
+
+	NetDriver = World->GetNetDriver();
+	Graph     =
+		(NetDriver != nullptr) ? NetDriver->GetReplicationDriver<UOpenPF2PlaygroundReplicationGraph>() : nullptr;
+
+	if (Graph != nullptr)
+	{
+		Graph->UpdateEncounterCombatants(GameState);
+	}
+}
+
+void UOpenPF2PlaygroundReplicationGraph::ResetGameWorldState()
+{
+	Super::ResetGameWorldState();
+
+	this->PlaygroundCharacters.Reset();
+	this->CharacterPartyConnections.Reset();
+	this->EncounterCombatants.Reset();
+	this->EncounterParticipantConnections.Reset();
+}
+
+void UOpenPF2PlaygroundReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* ConnectionManager)
+{
+	UOpenPF2PlaygroundReplicationGraphNode_Party*     PartyNode;
+	UOpenPF2PlaygroundReplicationGraphNode_Encounter* EncounterNode;
+
+	Super::InitConnectionGraphNodes(ConnectionManager);
+
+	PartyNode = this->CreateNewNode<UOpenPF2PlaygroundReplicationGraphNode_Party>();
+
+	EncounterNode = this->CreateNewNode<UOpenPF2PlaygroundReplicationGraphNode_Encounter>();
+
+	this->AddConnectionGraphNode(PartyNode, ConnectionManager);
+	this->AddConnectionGraphNode(EncounterNode, ConnectionManager);
+
+	this->PartyNodes.Add(ConnectionManager->NetConnection, PartyNode);
+}
+
+void UOpenPF2PlaygroundReplicationGraph::RemoveClientConnection(UNetConnection* NetConnection)
+{
+	for (auto EntryIterator = this->CharacterPartyConnections.CreateIterator(); EntryIterator; ++EntryIterator)
+	{
+		if (EntryIterator->Value == NetConnection)
+		{
+			EntryIterator.RemoveCurrent();
+		}
+	}
+
+	this->PartyNodes.Remove(NetConnection);
+	this->EncounterParticipantConnections.Remove(NetConnection);
+
+	Super::RemoveClientConnection(NetConnection);
+}
+
+void UOpenPF2PlaygroundReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo,
+                                                                     FGlobalActorReplicationInfo&   GlobalInfo)
+{
+	if (Cast<AOpenPF2PlaygroundCharacterBase>(ActorInfo.Actor) != nullptr)
+	{
+		this->PlaygroundCharacters.Add(ActorInfo.Actor);
+		this->UpdateCharacterParty(ActorInfo.Actor);
+
+		if (this->EncounterCombatants.Contains(ActorInfo.Actor))
+		{
+			this->UpdateEncounterParticipants();
+		}
+	}
+
+	// Characters are still spatialized as usual, so that players outside the party can see them when they are nearby.
+	Super::RouteAddNetworkActorToNodes(ActorInfo, GlobalInfo);
+}
+
+void UOpenPF2PlaygroundReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	if (Cast<AOpenPF2PlaygroundCharacterBase>(ActorInfo.Actor) != nullptr)
+	{
+		this->PlaygroundCharacters.RemoveFast(ActorInfo.Actor);
+		this->RemoveCharacterFromParty(ActorInfo.Actor);
+	}
+
+	if (this->EncounterCombatants.RemoveFast(ActorInfo.Actor))
+	{
+		this->UpdateEncounterParticipants();
+	}
+
+	Super::RouteRemoveNetworkActorToNodes(ActorInfo);
+}
+
+void UOpenPF2PlaygroundReplicationGraph::UpdateCharacterParty(AActor* Character)
+{
+	const APlayerController*                      PartyOwner =
+		UOpenPF2PlaygroundReplicationGraphNode_Party::GetPartyOwnerOf(Character);
+	const UNetConnection*                         Connection =
+		(PartyOwner != nullptr) ? PartyOwner->NetConnection : nullptr;
+	UOpenPF2PlaygroundReplicationGraphNode_Party* PartyNode  = this->PartyNodes.FindRef(Connection);
+	const UNetConnection* const*                  OldConnection;
+
+	if (PartyNode == nullptr)
+	{
+		// Either the character is not in the party of any player, or its player is local to the server.
+		this->RemoveCharacterFromParty(Character);
+		return;
+	}
+
+	OldConnection = this->CharacterPartyConnections.Find(Character);
+
+	if ((OldConnection != nullptr) && (*OldConnection == Connection))
+	{
+		// Still in the same party.
+		return;
+	}
+
+	this->RemoveCharacterFromParty(Character);
+
+	PartyNode->AddPartyMember(Character);
+	this->CharacterPartyConnections.Add(Character, Connection);
+}
+
+void UOpenPF2PlaygroundReplicationGraph::RemoveCharacterFromParty(AActor* Character)
+{
+	const UNetConnection*                         OldConnection;
+	UOpenPF2PlaygroundReplicationGraphNode_Party* OldPartyNode;
+
+	if (!this->CharacterPartyConnections.RemoveAndCopyValue(Character, OldConnection))
+	{
+		return;
+	}
+
+	OldPartyNode = this->PartyNodes.FindRef(OldConnection);
+
+	if (OldPartyNode != nullptr)
+	{
+		OldPartyNode->RemovePartyMember(Character);
+	}
+}
+
+void UOpenPF2PlaygroundReplicationGraph::UpdateEncounterCombatants(const AOpenPF2PlaygroundGameState* GameState)
+{
+	this->EncounterCombatants.Reset();
+
+	for (const FOpenPF2PlaygroundEncounterRosterEntry& Entry : GameState->GetEncounterRosterEntries())
+	{
+		AActor* Combatant = Entry.Combatant;
+
+		if ((Combatant != nullptr) && Combatant->GetIsReplicated())
+		{
+			this->EncounterCombatants.Add(Combatant);
+		}
+	}
+
+	this->UpdateEncounterParticipants();
+}
+
+void UOpenPF2PlaygroundReplicationGraph::UpdateEncounterParticipants()
+{
+	this->EncounterParticipantConnections.Reset();
+
+	for (const FActorRepListType& Combatant : this->EncounterCombatants)
+	{
+		const UNetConnection* const* Connection = this->CharacterPartyConnections.Find(Combatant);
+
+		if (Connection != nullptr)
+		{
+			this->EncounterParticipantConnections.Add(*Connection);
+		}
+	}
+}
@@ -0,0 +1,187 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <BasicReplicationGraph.h>
+
+#include "OpenPF2PlaygroundReplicationGraph.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class AOpenPF2PlaygroundGameState;
+class UOpenPF2PlaygroundReplicationGraphNode_Party;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * The replication graph for the OpenPF2 Playground.
+ *
+ * In addition to the spatial and always-relevant nodes of the basic replication graph, every connection gets:
+ *  - A party node, which keeps all members of the party of the player relevant to that player, even when they are far
+ *    away from the camera.
+ *  - An encounter node, which keeps all combatants of the current encounter relevant to every player who has a party
+ *    member taking part in that encounter.
+ *
+ * This replaces the per-actor, per-connection relevancy checks of the default net driver with lists that are gathered
+ * once per connection per frame. The party list of each connection is maintained by this graph as characters are
+ * added, removed, or change hands (see NotifyCharacterPartyChanged()), so gathering it does not scan any characters.
+ * Likewise, a single list of encounter combatants is shared by all connections and only rebuilt when the roster
+ * changes (see NotifyEncounterRosterChanged()), so each encounter node only has to check whether its connection is
+ * taking part in the encounter.
+ *
+ * The bandwidth and server CPU savings of this graph over the legacy net driver have not been measured yet. See the
+ * 'stat Pf2Playground' gather timings for how to compare the two.
+ */
+UCLASS(Transient, Config=Engine)
+class UOpenPF2PlaygroundReplicationGraph : public UBasicReplicationGraph
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * All of the playground characters that are currently replicated, regardless of which player they belong to.
+	 */
+	FActorRepListRefView PlaygroundCharacters;
+
+	/**
+	 * The party node of each client connection.
+	 */
+	TMap<const UNetConnection*, UOpenPF2PlaygroundReplicationGraphNode_Party*> PartyNodes;
+
+	/**
+	 * The connection of the player whose party each playground character is currently in.
+	 *
+	 * Characters that are not in the party of any remote player are not in this map.
+	 */
+	TMap<FActorRepListType, const UNetConnection*> CharacterPartyConnections;
+
+	/**
+	 * The replicated combatants of the current encounter, shared by the encounter nodes of all connections.
+	 */
+	FActorRepListRefView EncounterCombatants;
+
+	/**
+	 * The connections of the players who have a party member among the combatants of the current encounter.
+	 */
+	TSet<const UNetConnection*> EncounterParticipantConnections;
+
+public:
+	// =================================================================================================================
+	// Public Static Methods
+	// =================================================================================================================
+	/**
+	 * Notifies the replication graph of the world of a character that the party the character is in may have changed.
+	 *
+	 * This must be invoked on the server whenever the controller of a character changes or a character is given to or
+	 * released by a player controller. It has no effect if the world does not use this replication graph.
+	 *
+	 * @param Character
+	 *	The character whose party may have changed.
+	 */
+	static void NotifyCharacterPartyChanged(AActor* Character);
+
+	/**
+	 * Notifies the replication graph of the world of a game state that the encounter roster has changed.
+	 *
+	 * This must be invoked on the server whenever combatants are added to, removed from, or updated in the roster. It
+	 * has no effect if the world does not use this replication graph.
+	 *
+	 * @param GameState
+	 *	The game state whose encounter roster has changed.
+	 */
+	static void NotifyEncounterRosterChanged(const AOpenPF2PlaygroundGameState* GameState);
+
+	// =================================================================================================================
+	// Public Methods - UReplicationGraph Overrides
+	// =================================================================================================================
+	virtual void ResetGameWorldState() override;
+
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* ConnectionManager) override;
+
+	virtual void RemoveClientConnection(UNetConnection* NetConnection) override;
+
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo,
+	                                         FGlobalActorReplicationInfo&   GlobalInfo) override;
+
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Gets all of the playground characters that are currently replicated.
+	 *
+	 * @return
+	 *	The list of replicated playground characters.
+	 */
+	FORCEINLINE const FActorRepListRefView& GetPlaygroundCharacters() const
+	{
+		return this->PlaygroundCharacters;
+	}
+
+	/**
+	 * Gets the replicated combatants of the current encounter.
+	 *
+	 * @return
+	 *	The list of replicated combatants, shared by all connections.
+	 */
+	FORCEINLINE const FActorRepListRefView& GetEncounterCombatants() const
+	{
+		return this->EncounterCombatants;
+	}
+
+	/**
+	 * Determines whether the player for a connection has a party member among the combatants of the current encounter.
+	 *
+	 * @param Connection
+	 *	The connection of the player.
+	 *
+	 * @return
+	 *	true if the player is taking part in the current encounter; or, false if they are not.
+	 */
+	FORCEINLINE bool IsEncounterParticipant(const UNetConnection* Connection) const
+	{
+		return this->EncounterParticipantConnections.Contains(Connection);
+	}
+
+protected:
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Moves a character to the party node of the connection of the player whose party it is now in.
+	 *
+	 * @param Character
+	 *	The character whose party may have changed.
+	 */
+	void UpdateCharacterParty(AActor* Character);
+
+	/**
+	 * Removes a character from the party node that it is currently in, if any.
+	 *
+	 * @param Character
+	 *	The character to remove.
+	 */
+	void RemoveCharacterFromParty(AActor* Character);
+
+	/**
+	 * Rebuilds the shared list of encounter combatants from the roster of the given game state.
+	 *
+	 * @param GameState
+	 *	The game state that holds the encounter roster.
+	 */
+	void UpdateEncounterCombatants(const AOpenPF2PlaygroundGameState* GameState);
+
+	/**
+	 * Recalculates which connections have a party member among the combatants of the current encounter.
+	 */
+	void UpdateEncounterParticipants();
+};
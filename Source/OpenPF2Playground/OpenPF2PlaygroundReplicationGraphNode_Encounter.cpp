@@ -0,0 +1,29 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundReplicationGraphNode_Encounter.h"
+
+#include <Engine/NetConnection.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundReplicationGraph.h"
+
+void UOpenPF2PlaygroundReplicationGraphNode_Encounter::GatherActorListsForConnection(
+	const FConnectionGatherActorListParameters& Params)
+{
+	PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundRepGraphGatherEncounter, RepGraphGatherEncounter);
+
+	const UOpenPF2PlaygroundReplicationGraph* Graph = Cast<UOpenPF2PlaygroundReplicationGraph>(this->GetOuter());
+
+	if ((Graph == nullptr) || (Graph->GetEncounterCombatants().Num() == 0))
+	{
+		return;
+	}
+
+	if (Graph->IsEncounterParticipant(Params.ConnectionManager.NetConnection))
+	{
+		Params.OutGatheredReplicationLists.AddReplicationActorList(Graph->GetEncounterCombatants());
+	}
+}
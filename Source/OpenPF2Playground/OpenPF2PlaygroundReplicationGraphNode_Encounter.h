@@ -0,0 +1,52 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <ReplicationGraph.h>
+
+#include "OpenPF2PlaygroundReplicationGraphNode_Encounter.generated.h"
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A per-connection replication graph node that makes all combatants of an encounter relevant to its participants.
+ *
+ * If any member of the party of the player for a connection is in the roster of the current encounter, every combatant
+ * in the roster is relevant to that player, no matter how far away from the camera it is.
+ *
+ * The list of combatants is owned by the replication graph and shared by the encounter nodes of all connections. It is
+ * only rebuilt when the roster changes, so gathering for a connection just checks whether that connection is taking
+ * part in the encounter.
+ */
+UCLASS()
+class UOpenPF2PlaygroundReplicationGraphNode_Encounter : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+	// =================================================================================================================
+	// Public Methods - UReplicationGraphNode Overrides
+	// =================================================================================================================
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override
+	{
+		// Combatants are tracked by the replication graph rather than by each per-connection node.
+	}
+
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo,
+	                                      bool                           bWarnIfNotFound = true) override
+	{
+		// Combatants are tracked by the replication graph rather than by each per-connection node.
+		return false;
+	}
+
+	virtual void NotifyResetAllNetworkActors() override
+	{
+		// Combatants are tracked by the replication graph rather than by each per-connection node.
+	}
+
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+};
@@ -0,0 +1,50 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundReplicationGraphNode_Party.h"
+
+#include <GameFramework/Pawn.h>
+#include <GameFramework/PlayerController.h>
+
+#include "OpenPF2Playground.h"
+#include "PF2CharacterInterface.h"
+#include "PF2PlayerControllerInterface.h"
+
+const APlayerController* UOpenPF2PlaygroundReplicationGraphNode_Party::GetPartyOwnerOf(const AActor* Character)
+{
+	const APawn*                  Pawn          = Cast<APawn>(Character);
+	const IPF2CharacterInterface* CharacterIntf = Cast<IPF2CharacterInterface>(Character);
+	const APlayerController*      PartyOwner    =
+		(Pawn != nullptr) ? Cast<APlayerController>(Pawn->GetController()) : nullptr;
+
+	if ((PartyOwner == nullptr) && (CharacterIntf != nullptr))
+	{
+		PartyOwner = Cast<APlayerController>(CharacterIntf->GetPlayerController().GetObject());
+	}
+
+	return PartyOwner;
+}
+
+bool UOpenPF2PlaygroundReplicationGraphNode_Party::IsCharacterInPartyOf(const AActor*            Character,
+                                                                        const APlayerController* PlayerController)
+{
+	return (PlayerController != nullptr) && (GetPartyOwnerOf(Character) == PlayerController);
+}
+
+void UOpenPF2PlaygroundReplicationGraphNode_Party::NotifyResetAllNetworkActors()
+{
+	this->PartyMembers.Reset();
+}
+
+void UOpenPF2PlaygroundReplicationGraphNode_Party::GatherActorListsForConnection(
+	const FConnectionGatherActorListParameters& Params)
+{
+	PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundRepGraphGatherParty, RepGraphGatherParty);
+
+	if (this->PartyMembers.Num() != 0)
+	{
+		Params.OutGatheredReplicationLists.AddReplicationActorList(this->PartyMembers);
+	}
+}
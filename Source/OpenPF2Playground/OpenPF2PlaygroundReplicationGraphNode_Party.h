@@ -0,0 +1,111 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <ReplicationGraph.h>
+
+#include "OpenPF2PlaygroundReplicationGraphNode_Party.generated.h"
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A per-connection replication graph node that makes every member of a player's party always relevant to that player.
+ *
+ * A character is considered to be part of the party of a player if the player controller of the character is the
+ * player controller of the connection. This keeps party members that are far away from the camera (e.g., members being
+ * driven by AI controllers in Exploration mode) relevant to the player that owns them.
+ *
+ * The list of party members is maintained by UOpenPF2PlaygroundReplicationGraph as characters change hands, so
+ * gathering actors for a connection costs the same no matter how many characters are replicated.
+ */
+UCLASS()
+class UOpenPF2PlaygroundReplicationGraphNode_Party : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * The members of the party of the player for this connection.
+	 */
+	FActorRepListRefView PartyMembers;
+
+public:
+	// =================================================================================================================
+	// Public Static Methods
+	// =================================================================================================================
+	/**
+	 * Gets the player controller whose party the given character belongs to.
+	 *
+	 * @param Character
+	 *	The character to check.
+	 *
+	 * @return
+	 *	The player controller that is controlling or owns the character; or, nullptr if the character is not in the party
+	 *	of any player.
+	 */
+	static const APlayerController* GetPartyOwnerOf(const AActor* Character);
+
+	/**
+	 * Determines whether the given character belongs to the party of the given player controller.
+	 *
+	 * @param Character
+	 *	The character to check.
+	 * @param PlayerController
+	 *	The player controller of the connection.
+	 *
+	 * @return
+	 *	true if the character is controlled or owned by the player controller; or, false otherwise.
+	 */
+	static bool IsCharacterInPartyOf(const AActor* Character, const APlayerController* PlayerController);
+
+	// =================================================================================================================
+	// Public Methods - UReplicationGraphNode Overrides
+	// =================================================================================================================
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override
+	{
+		// Party members are routed to this node by the replication graph through AddPartyMember().
+	}
+
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo,
+	                                      bool                           bWarnIfNotFound = true) override
+	{
+		// Party members are removed from this node by the replication graph through RemovePartyMember().
+		return false;
+	}
+
+	virtual void NotifyResetAllNetworkActors() override;
+
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Adds a character to the party of the player for this connection.
+	 *
+	 * @param Character
+	 *	The character that has joined the party.
+	 */
+	FORCEINLINE void AddPartyMember(AActor* Character)
+	{
+		this->PartyMembers.Add(Character);
+	}
+
+	/**
+	 * Removes a character from the party of the player for this connection.
+	 *
+	 * @param Character
+	 *	The character that has left the party.
+	 */
+	FORCEINLINE void RemovePartyMember(AActor* Character)
+	{
+		this->PartyMembers.RemoveFast(Character);
+	}
+};
@@ -0,0 +1,116 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Engine/EngineTypes.h>
+
+#include "OpenPF2PlaygroundScreenTraceQuery.generated.h"
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * A request to perform a collision query on a trace channel from a specific point in screen space.
+ */
+USTRUCT(BlueprintType)
+struct FOpenPF2PlaygroundScreenTraceQuery
+{
+	GENERATED_BODY()
+
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * The position to project into the game world.
+	 *
+	 * The upper-left corner of the screen is (0, 0). Positive X numbers move further right, while positive Y numbers
+	 * move further down.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="OpenPF2 Playground|Targeting")
+	FVector2D Position;
+
+	/**
+	 * The channel on which to perform the trace.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="OpenPF2 Playground|Targeting")
+	TEnumAsByte<ECollisionChannel> TraceChannel;
+
+	/**
+	 * Whether to perform the trace against complex collision or simple collision.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="OpenPF2 Playground|Targeting")
+	bool bTraceComplex;
+
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor for FOpenPF2PlaygroundScreenTraceQuery.
+	 */
+	explicit FOpenPF2PlaygroundScreenTraceQuery() :
+		Position(FVector2D::ZeroVector),
+		TraceChannel(ECC_Visibility),
+		bTraceComplex(true)
+	{
+	}
+
+	/**
+	 * Constructor for FOpenPF2PlaygroundScreenTraceQuery.
+	 *
+	 * @param Position
+	 *	The position to project into the game world.
+	 * @param TraceChannel
+	 *	The channel on which to perform the trace.
+	 * @param bTraceComplex
+	 *	Whether to perform the trace against complex collision or simple collision.
+	 */
+	explicit FOpenPF2PlaygroundScreenTraceQuery(const FVector2D&         Position,
+	                                            const ECollisionChannel TraceChannel,
+	                                            const bool              bTraceComplex) :
+		Position(Position),
+		TraceChannel(TraceChannel),
+		bTraceComplex(bTraceComplex)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Operators
+	// =================================================================================================================
+	/**
+	 * Equality operator for FOpenPF2PlaygroundScreenTraceQuery.
+	 *
+	 * @param Other
+	 *	The other query against which to compare.
+	 *
+	 * @return
+	 *	true if both queries would produce the same trace; or, false if they would not.
+	 */
+	FORCEINLINE bool operator==(const FOpenPF2PlaygroundScreenTraceQuery& Other) const
+	{
+		return (this->Position == Other.Position) &&
+			(this->TraceChannel == Other.TraceChannel) &&
+			(this->bTraceComplex == Other.bTraceComplex);
+	}
+};
+
+/**
+ * Gets a hash of a screen trace query, so that it can be used as the key of a map or set.
+ *
+ * @param Query
+ *	The query for which a hash is desired.
+ *
+ * @return
+ *	The hash of the query.
+ */
+FORCEINLINE uint32 GetTypeHash(const FOpenPF2PlaygroundScreenTraceQuery& Query)
+{
+	uint32 Hash = GetTypeHash(Query.Position);
+
+	Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Query.TraceChannel.GetValue())));
+	Hash = HashCombine(Hash, GetTypeHash(Query.bTraceComplex));
+
+	return Hash;
+}
@@ -0,0 +1,155 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundSimulationAiController.h"
+
+#include <AbilitySystemComponent.h>
+#include <AbilitySystemGlobals.h>
+
+#include <Engine/World.h>
+
+#include "OpenPF2PlaygroundGameState.h"
+
+AOpenPF2PlaygroundSimulationAiController::AOpenPF2PlaygroundSimulationAiController() :
+	AttackRange(150.0f),
+	NumTurnsTaken(0),
+	NumAbilityActivations(0)
+{
+}
+
+void AOpenPF2PlaygroundSimulationAiController::OnPossess(APawn* InPawn)
+{
+	AOpenPF2PlaygroundGameState* GameState = this->GetWorld()->GetGameState<AOpenPF2PlaygroundGameState>();
+
+	Super::OnPossess(InPawn);
+
+	this->RandomStream.Initialize(GetTypeHash(InPawn->GetName()));
+
+	if (GameState != nullptr)
+	{
+		this->BoundGameState = GameState;
+
+		GameState->GetActiveCombatantChangedEvent().AddUniqueDynamic(
+			this,
+			&AOpenPF2PlaygroundSimulationAiController::Native_OnActiveCombatantChanged
+		);
+	}
+}
+
+void AOpenPF2PlaygroundSimulationAiController::OnUnPossess()
+{
+	AOpenPF2PlaygroundGameState* GameState = this->BoundGameState.Get();
+
+	if (GameState != nullptr)
+	{
+		GameState->GetActiveCombatantChangedEvent().RemoveDynamic(
+			this,
+			&AOpenPF2PlaygroundSimulationAiController::Native_OnActiveCombatantChanged
+		);
+	}
+
+	this->BoundGameState = nullptr;
+
+	Super::OnUnPossess();
+}
+
+void AOpenPF2PlaygroundSimulationAiController::TakeTurn()
+{
+	const AOpenPF2PlaygroundGameState* GameState = this->BoundGameState.Get();
+	UAbilitySystemComponent*           Asc       =
+		UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(this->GetPawn());
+	AActor*                            Opponent;
+	TArray<FGameplayAbilitySpecHandle> AbilityHandles;
+	int32                              FirstAbilityIndex;
+
+	if ((GameState == nullptr) || (Asc == nullptr))
+	{
+		return;
+	}
+
+	++this->NumTurnsTaken;
+
+	Opponent = this->FindNearestOpponent(GameState);
+
+	if (Opponent != nullptr)
+	{
+		this->SetFocus(Opponent);
+		this->MoveToActor(Opponent, this->AttackRange);
+	}
+
+	for (const FGameplayAbilitySpec& AbilitySpec : Asc->GetActivatableAbilities())
+	{
+		AbilityHandles.Add(AbilitySpec.Handle);
+	}
+
+	if (AbilityHandles.Num() == 0)
+	{
+		return;
+	}
+
+	// Start from a random ability, and fall back to the others in order if it cannot be activated right now (e.g.,
+	// because it is on cooldown or the character cannot afford it).
+	FirstAbilityIndex = this->RandomStream.RandHelper(AbilityHandles.Num());
+
+	for (int32 Offset = 0; Offset < AbilityHandles.Num(); ++Offset)
+	{
+		const FGameplayAbilitySpecHandle AbilityHandle =
+			AbilityHandles[(FirstAbilityIndex + Offset) % AbilityHandles.Num()];
+
+		if (Asc->TryActivateAbility(AbilityHandle))
+		{
+			++this->NumAbilityActivations;
+			break;
+		}
+	}
+}
+
+AActor* AOpenPF2PlaygroundSimulationAiController::FindNearestOpponent(
+	const AOpenPF2PlaygroundGameState* GameState) const
+{
+	const APawn*                                          Character = this->GetPawn();
+	const TArray<FOpenPF2PlaygroundEncounterRosterEntry>& Roster    = GameState->GetEncounterRosterEntries();
+	const FOpenPF2PlaygroundEncounterRosterEntry*         OwnEntry  = Roster.FindByPredicate(
+		[Character](const FOpenPF2PlaygroundEncounterRosterEntry& Entry)
+		{
+			return Entry.Combatant == Character;
+		}
+	);
+	AActor*                                               Nearest           = nullptr;
+	double                                                NearestDistanceSq = TNumericLimits<double>::Max();
+
+	if (OwnEntry == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (const FOpenPF2PlaygroundEncounterRosterEntry& Entry : Roster)
+	{
+		double DistanceSq;
+
+		if ((Entry.Combatant == nullptr) || (Entry.bIsEnemy == OwnEntry->bIsEnemy) || (Entry.HitPoints <= 0.0f))
+		{
+			continue;
+		}
+
+		DistanceSq = FVector::DistSquared(Character->GetActorLocation(), Entry.Combatant->GetActorLocation());
+
+		if (DistanceSq < NearestDistanceSq)
+		{
+			Nearest           = Entry.Combatant;
+			NearestDistanceSq = DistanceSq;
+		}
+	}
+
+	return Nearest;
+}
+
+void AOpenPF2PlaygroundSimulationAiController::Native_OnActiveCombatantChanged(AActor* ActiveCombatant)
+{
+	if ((ActiveCombatant != nullptr) && (ActiveCombatant == this->GetPawn()))
+	{
+		this->TakeTurn();
+	}
+}
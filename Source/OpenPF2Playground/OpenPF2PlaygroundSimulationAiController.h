@@ -0,0 +1,137 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <AIController.h>
+
+#include "OpenPF2PlaygroundSimulationAiController.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class AOpenPF2PlaygroundGameState;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * An AI controller that fights on behalf of a combatant in a headless encounter simulation.
+ *
+ * Whenever the game state reports that it is the turn of the possessed character, the controller focuses the nearest
+ * opponent that can still fight, moves towards it, and activates one of the abilities of the character at random.
+ * Abilities are chosen with a stream seeded from the name of the character, so that repeated runs of the same map
+ * make the same choices.
+ */
+UCLASS()
+// ReSharper disable once CppClassCanBeFinal
+class AOpenPF2PlaygroundSimulationAiController : public AAIController
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * How close (in cm) to get to an opponent before attacking it.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category="OpenPF2 Playground|Simulation")
+	float AttackRange;
+
+	/**
+	 * The source of random ability choices.
+	 */
+	FRandomStream RandomStream;
+
+	/**
+	 * The game state to which this controller is listening for the start of each turn.
+	 */
+	UPROPERTY()
+	TWeakObjectPtr<AOpenPF2PlaygroundGameState> BoundGameState;
+
+	/**
+	 * The number of turns that this controller has taken.
+	 */
+	int32 NumTurnsTaken;
+
+	/**
+	 * The number of abilities that this controller has activated successfully.
+	 */
+	int32 NumAbilityActivations;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit AOpenPF2PlaygroundSimulationAiController();
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Gets the number of turns that this controller has taken.
+	 *
+	 * @return
+	 *	The number of turns taken.
+	 */
+	FORCEINLINE int32 GetNumTurnsTaken() const
+	{
+		return this->NumTurnsTaken;
+	}
+
+	/**
+	 * Gets the number of abilities that this controller has activated successfully.
+	 *
+	 * @return
+	 *	The number of abilities activated.
+	 */
+	FORCEINLINE int32 GetNumAbilityActivations() const
+	{
+		return this->NumAbilityActivations;
+	}
+
+protected:
+	// =================================================================================================================
+	// Protected Methods - AController Overrides
+	// =================================================================================================================
+	virtual void OnPossess(APawn* InPawn) override;
+
+	virtual void OnUnPossess() override;
+
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Takes the turn of the possessed character: focuses and approaches an opponent, then activates an ability.
+	 */
+	void TakeTurn();
+
+	/**
+	 * Locates the nearest combatant on the opposing side of the encounter that can still fight.
+	 *
+	 * @param GameState
+	 *	The game state, which holds the roster of the current encounter.
+	 *
+	 * @return
+	 *	The nearest opponent; or, nullptr if the possessed character is not in the roster or has no opponents left.
+	 */
+	AActor* FindNearestOpponent(const AOpenPF2PlaygroundGameState* GameState) const;
+
+	// =================================================================================================================
+	// Protected Native Event Callbacks
+	// =================================================================================================================
+	/**
+	 * Native callback invoked by the game state when the turn of a combatant starts.
+	 *
+	 * @param ActiveCombatant
+	 *	The combatant whose turn it now is; or, nullptr if no combatant is taking a turn.
+	 */
+	UFUNCTION()
+	void Native_OnActiveCombatantChanged(AActor* ActiveCombatant);
+};
@@ -0,0 +1,406 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "OpenPF2PlaygroundTickBudgetSubsystem.h"
+
+#include <Components/SkeletalMeshComponent.h>
+
+#include <Engine/World.h>
+
+#include <GameFramework/CharacterMovementComponent.h>
+#include <GameFramework/GameStateBase.h>
+#include <GameFramework/PlayerController.h>
+
+#include "OpenPF2Playground.h"
+#include "OpenPF2PlaygroundCharacterBase.h"
+#include "OpenPF2PlaygroundGameState.h"
+#include "PF2CharacterInterface.h"
+#include "PF2PlayerControllerInterface.h"
+
+void UOpenPF2PlaygroundTickBudgetSubsystem::Deinitialize()
+{
+	AOpenPF2PlaygroundGameState* GameState = this->BoundGameState.Get();
+
+	if (GameState != nullptr)
+	{
+		GameState->GetActiveCombatantChangedEvent().RemoveDynamic(
+			this,
+			&UOpenPF2PlaygroundTickBudgetSubsystem::Native_OnActiveCombatantChanged
+		);
+	}
+
+	for (FOpenPF2PlaygroundTickBudgetEntry& Entry : this->Entries)
+	{
+		this->ApplySignificance(Entry, EOpenPF2PlaygroundTickSignificance::Full);
+	}
+
+	SET_DWORD_STAT(STAT_Pf2PlaygroundTickBudgetThrottled, 0);
+
+	this->Entries.Empty();
+
+	Super::Deinitialize();
+}
+
+void UOpenPF2PlaygroundTickBudgetSubsystem::Tick(const float DeltaTime)
+{
+	PF2_PLAYGROUND_SCOPE_CYCLE_COUNTER(STAT_Pf2PlaygroundTickBudget, TickBudget);
+
+	const EPF2ModeOfPlayType ModeOfPlay   = this->GetModeOfPlay();
+	const double             StartTime    = FPlatformTime::Seconds();
+	const double             Budget       = this->GameThreadBudgetMs / 1000.0;
+	int32                    NumThrottled = 0;
+
+	Super::Tick(DeltaTime);
+
+	this->BindToGameState();
+
+	if (this->Entries.Num() == 0)
+	{
+		return;
+	}
+
+	this->UpdateLocallyRelevantCharacters();
+
+	if (ModeOfPlay != this->LastModeOfPlay)
+	{
+		// Everyone's significance depends on the mode of play, so start a new pass from the top.
+		this->LastModeOfPlay = ModeOfPlay;
+		this->NextEntryIndex = 0;
+	}
+
+	for (int32 NumEvaluated = 0; NumEvaluated < this->Entries.Num(); ++NumEvaluated)
+	{
+		if ((NumEvaluated != 0) && ((FPlatformTime::Seconds() - StartTime) >= Budget))
+		{
+			break;
+		}
+
+		if (this->NextEntryIndex >= this->Entries.Num())
+		{
+			this->NextEntryIndex = 0;
+		}
+
+		if (this->EvaluateEntry(this->NextEntryIndex, ModeOfPlay))
+		{
+			++this->NextEntryIndex;
+		}
+		else
+		{
+			this->Entries.RemoveAtSwap(this->NextEntryIndex);
+		}
+	}
+
+	for (const FOpenPF2PlaygroundTickBudgetEntry& Entry : this->Entries)
+	{
+		if (Entry.Significance != EOpenPF2PlaygroundTickSignificance::Full)
+		{
+			++NumThrottled;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_Pf2PlaygroundTickBudgetThrottled, NumThrottled);
+}
+
+TStatId UOpenPF2PlaygroundTickBudgetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UOpenPF2PlaygroundTickBudgetSubsystem, STATGROUP_Tickables);
+}
+
+void UOpenPF2PlaygroundTickBudgetSubsystem::RegisterCharacter(AOpenPF2PlaygroundCharacterBase* Character)
+{
+	const UCharacterMovementComponent* Movement;
+	const USkeletalMeshComponent*      Mesh;
+	FOpenPF2PlaygroundTickBudgetEntry* Entry;
+
+	if ((Character == nullptr) || (this->FindEntryIndex(Character) != INDEX_NONE))
+	{
+		return;
+	}
+
+	Movement = Character->GetCharacterMovement();
+	Mesh     = Character->GetMesh();
+	Entry    = &this->Entries.AddDefaulted_GetRef();
+
+	Entry->Character         = Character;
+	Entry->ActorTickInterval = Character->GetActorTickInterval();
+
+	if (Movement != nullptr)
+	{
+		Entry->MovementTickInterval = Movement->GetComponentTickInterval();
+	}
+
+	if (Mesh != nullptr)
+	{
+		Entry->MeshVisibilityBasedAnimTickOption  = Mesh->VisibilityBasedAnimTickOption;
+		Entry->bMeshEnableUpdateRateOptimizations = Mesh->bEnableUpdateRateOptimizations;
+	}
+}
+
+void UOpenPF2PlaygroundTickBudgetSubsystem::UnregisterCharacter(AOpenPF2PlaygroundCharacterBase* Character)
+{
+	const int32 EntryIndex = this->FindEntryIndex(Character);
+
+	if (EntryIndex != INDEX_NONE)
+	{
+		this->ApplySignificance(this->Entries[EntryIndex], EOpenPF2PlaygroundTickSignificance::Full);
+		this->Entries.RemoveAtSwap(EntryIndex);
+	}
+}
+
+void UOpenPF2PlaygroundTickBudgetSubsystem::RequestEvaluation(const AOpenPF2PlaygroundCharacterBase* Character)
+{
+	const int32 EntryIndex = this->FindEntryIndex(Character);
+
+	if (EntryIndex != INDEX_NONE)
+	{
+		this->EvaluateEntry(EntryIndex, this->GetModeOfPlay());
+	}
+}
+
+EOpenPF2PlaygroundTickSignificance UOpenPF2PlaygroundTickBudgetSubsystem::GetSignificance(
+	const AOpenPF2PlaygroundCharacterBase* Character) const
+{
+	const int32 EntryIndex = this->FindEntryIndex(Character);
+
+	if (EntryIndex == INDEX_NONE)
+	{
+		return EOpenPF2PlaygroundTickSignificance::Full;
+	}
+
+	return this->Entries[EntryIndex].Significance;
+}
+
+EPF2ModeOfPlayType UOpenPF2PlaygroundTickBudgetSubsystem::GetModeOfPlay() const
+{
+	const UWorld*                 World         = this->GetWorld();
+	const IPF2GameStateInterface* GameStateIntf =
+		(World != nullptr) ? Cast<IPF2GameStateInterface>(World->GetGameState()) : nullptr;
+
+	if (GameStateIntf == nullptr)
+	{
+		return EPF2ModeOfPlayType::None;
+	}
+
+	return GameStateIntf->GetModeOfPlay();
+}
+
+void UOpenPF2PlaygroundTickBudgetSubsystem::BindToGameState()
+{
+	AOpenPF2PlaygroundGameState* GameState = Cast<AOpenPF2PlaygroundGameState>(this->GetWorld()->GetGameState());
+
+	if ((GameState == nullptr) || (GameState == this->BoundGameState.Get()))
+	{
+		return;
+	}
+
+	this->BoundGameState = GameState;
+
+	GameState->GetActiveCombatantChangedEvent().AddUniqueDynamic(
+		this,
+		&UOpenPF2PlaygroundTickBudgetSubsystem::Native_OnActiveCombatantChanged
+	);
+
+	// Pick up a turn that was already in progress (e.g., when joining an encounter late).
+	this->Native_OnActiveCombatantChanged(GameState->GetActiveCombatant());
+}
+
+void UOpenPF2PlaygroundTickBudgetSubsystem::UpdateLocallyRelevantCharacters()
+{
+	this->LocallyRelevantCharacters.Reset();
+
+	// A dedicated server has no local players, so this is a no-op there.
+	for (FConstPlayerControllerIterator ControllerIt = this->GetWorld()->GetPlayerControllerIterator();
+	     ControllerIt;
+	     ++ControllerIt)
+	{
+		const APlayerController*             PlayerController = ControllerIt->Get();
+		const IPF2PlayerControllerInterface* PlayerControllerIntf;
+
+		if ((PlayerController == nullptr) || !PlayerController->IsLocalController())
+		{
+			continue;
+		}
+
+		this->LocallyRelevantCharacters.AddUnique(PlayerController->GetViewTarget());
+
+		PlayerControllerIntf = Cast<IPF2PlayerControllerInterface>(PlayerController);
+
+		if (PlayerControllerIntf == nullptr)
+		{
+			continue;
+		}
+
+		// Party members are not possessed most of the time, but players still watch them closely.
+		for (const TScriptInterface<IPF2CharacterInterface>& Character :
+		     PlayerControllerIntf->GetControllableCharacters())
+		{
+			this->LocallyRelevantCharacters.AddUnique(Cast<AActor>(Character.GetObject()));
+		}
+	}
+}
+
+int32 UOpenPF2PlaygroundTickBudgetSubsystem::FindEntryIndex(const AOpenPF2PlaygroundCharacterBase* Character) const
+{
+	if (Character == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	return this->Entries.IndexOfByPredicate(
+		[Character](const FOpenPF2PlaygroundTickBudgetEntry& Entry)
+		{
+			return Entry.Character.Get() == Character;
+		}
+	);
+}
+
+EOpenPF2PlaygroundTickSignificance UOpenPF2PlaygroundTickBudgetSubsystem::EvaluateSignificance(
+	const AOpenPF2PlaygroundCharacterBase* Character,
+	const EPF2ModeOfPlayType               ModeOfPlay) const
+{
+	bool bIsOnScreen,
+	     bIsIdle;
+
+	if (!this->bEnableTickBudgeting || (ModeOfPlay == EPF2ModeOfPlayType::None) || Character->IsPlayerControlled() ||
+	    this->LocallyRelevantCharacters.Contains(Character))
+	{
+		return EOpenPF2PlaygroundTickSignificance::Full;
+	}
+
+	// A dedicated server renders nothing, so only idleness and turn order can be used to throttle characters there.
+	bIsOnScreen = IsRunningDedicatedServer() || Character->WasRecentlyRendered(this->OffScreenTimeout);
+	bIsIdle     = (Character->GetVelocity().SizeSquared() < FMath::Square(this->IdleSpeedThreshold)) &&
+	              (Character->GetCurrentMontage() == nullptr);
+
+	if (ModeOfPlay == EPF2ModeOfPlayType::Encounter)
+	{
+		if (Character == this->ActiveCombatant.Get())
+		{
+			return EOpenPF2PlaygroundTickSignificance::Full;
+		}
+
+		if (!this->ActiveCombatant.IsValid() && !bIsIdle)
+		{
+			// The encounter rule set has not reported whose turn it is, so a combatant that is acting is assumed to be
+			// taking its turn.
+			return EOpenPF2PlaygroundTickSignificance::Full;
+		}
+	}
+
+	if (!bIsOnScreen)
+	{
+		return EOpenPF2PlaygroundTickSignificance::Minimal;
+	}
+
+	if ((ModeOfPlay == EPF2ModeOfPlayType::Encounter) || bIsIdle)
+	{
+		// Combatants that are waiting for their turn stand still, but party members that are exploring may not.
+		return EOpenPF2PlaygroundTickSignificance::Reduced;
+	}
+
+	return EOpenPF2PlaygroundTickSignificance::Full;
+}
+
+bool UOpenPF2PlaygroundTickBudgetSubsystem::EvaluateEntry(const int32 EntryIndex, const EPF2ModeOfPlayType ModeOfPlay)
+{
+	FOpenPF2PlaygroundTickBudgetEntry&     Entry     = this->Entries[EntryIndex];
+	const AOpenPF2PlaygroundCharacterBase* Character = Entry.Character.Get();
+	EOpenPF2PlaygroundTickSignificance     Significance;
+
+	if (Character == nullptr)
+	{
+		return false;
+	}
+
+	Significance = this->EvaluateSignificance(Character, ModeOfPlay);
+
+	if (Significance != Entry.Significance)
+	{
+		this->ApplySignificance(Entry, Significance);
+	}
+
+	return true;
+}
+
+void UOpenPF2PlaygroundTickBudgetSubsystem::ApplySignificance(
+	FOpenPF2PlaygroundTickBudgetEntry&       Entry,
+	const EOpenPF2PlaygroundTickSignificance Significance) const
+{
+	AOpenPF2PlaygroundCharacterBase* Character = Entry.Character.Get();
+	UCharacterMovementComponent*     Movement;
+	USkeletalMeshComponent*          Mesh;
+
+	Entry.Significance = Significance;
+
+	if (Character == nullptr)
+	{
+		return;
+	}
+
+	Movement = Character->GetCharacterMovement();
+	Mesh     = Character->GetMesh();
+
+	switch (Significance)
+	{
+		case EOpenPF2PlaygroundTickSignificance::Full:
+			Character->SetActorTickInterval(Entry.ActorTickInterval);
+
+			if (Movement != nullptr)
+			{
+				Movement->SetComponentTickInterval(Entry.MovementTickInterval);
+			}
+
+			if (Mesh != nullptr)
+			{
+				Mesh->VisibilityBasedAnimTickOption  = Entry.MeshVisibilityBasedAnimTickOption;
+				Mesh->bEnableUpdateRateOptimizations = Entry.bMeshEnableUpdateRateOptimizations;
+			}
+			break;
+
+		case EOpenPF2PlaygroundTickSignificance::Reduced:
+			Character->SetActorTickInterval(FMath::Max(Entry.ActorTickInterval, this->ReducedTickInterval));
+
+			if (Movement != nullptr)
+			{
+				Movement->SetComponentTickInterval(FMath::Max(Entry.MovementTickInterval, this->ReducedTickInterval));
+			}
+
+			if (Mesh != nullptr)
+			{
+				Mesh->VisibilityBasedAnimTickOption  = Entry.MeshVisibilityBasedAnimTickOption;
+				Mesh->bEnableUpdateRateOptimizations = true;
+			}
+			break;
+
+		case EOpenPF2PlaygroundTickSignificance::Minimal:
+			Character->SetActorTickInterval(FMath::Max(Entry.ActorTickInterval, this->MinimalTickInterval));
+
+			if (Movement != nullptr)
+			{
+				// Movement is only throttled to the reduced rate, so that off-screen characters don't tunnel through
+				// geometry while following the party.
+				Movement->SetComponentTickInterval(FMath::Max(Entry.MovementTickInterval, this->ReducedTickInterval));
+			}
+
+			if (Mesh != nullptr)
+			{
+				Mesh->VisibilityBasedAnimTickOption  = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+				Mesh->bEnableUpdateRateOptimizations = true;
+			}
+			break;
+	}
+}
+
+void UOpenPF2PlaygroundTickBudgetSubsystem::Native_OnActiveCombatantChanged(AActor* InActiveCombatant)
+{
+	const AOpenPF2PlaygroundCharacterBase* PreviousCombatant =
+		Cast<AOpenPF2PlaygroundCharacterBase>(this->ActiveCombatant.Get());
+
+	this->ActiveCombatant = InActiveCombatant;
+
+	// Restore full rate for the new turn right away, instead of waiting for the round-robin to get to it.
+	this->RequestEvaluation(PreviousCombatant);
+	this->RequestEvaluation(Cast<AOpenPF2PlaygroundCharacterBase>(InActiveCombatant));
+}
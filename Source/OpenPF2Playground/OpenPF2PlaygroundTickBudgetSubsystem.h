@@ -0,0 +1,367 @@
+﻿// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <Components/SkinnedMeshComponent.h>
+
+#include <Subsystems/WorldSubsystem.h>
+
+#include "PF2GameStateInterface.h"
+
+#include "OpenPF2PlaygroundTickBudgetSubsystem.generated.h"
+
+// =====================================================================================================================
+// Forward Declarations (to minimize header dependencies)
+// =====================================================================================================================
+class AOpenPF2PlaygroundCharacterBase;
+class AOpenPF2PlaygroundGameState;
+
+// =====================================================================================================================
+// Normal Declarations
+// =====================================================================================================================
+/**
+ * How much of its normal tick rate a character is allowed to use.
+ */
+UENUM(BlueprintType)
+enum class EOpenPF2PlaygroundTickSignificance : uint8
+{
+	/**
+	 * The character ticks at full rate (e.g., a character that a local player views or controls, or the combatant whose
+	 * turn it is).
+	 */
+	Full,
+
+	/**
+	 * The character is visible but is idle or waiting for its turn, so it ticks less often.
+	 */
+	Reduced,
+
+	/**
+	 * The character is off-screen, so it ticks rarely and only animates montages.
+	 */
+	Minimal,
+};
+
+/**
+ * The tick settings of a character that the tick budget subsystem manages, as they were before any throttling.
+ */
+USTRUCT()
+struct FOpenPF2PlaygroundTickBudgetEntry
+{
+	GENERATED_BODY()
+
+	// =================================================================================================================
+	// Public Fields
+	// =================================================================================================================
+	/**
+	 * The character being managed.
+	 */
+	UPROPERTY()
+	TWeakObjectPtr<AOpenPF2PlaygroundCharacterBase> Character;
+
+	/**
+	 * The significance that was last applied to the character.
+	 */
+	UPROPERTY()
+	EOpenPF2PlaygroundTickSignificance Significance;
+
+	/**
+	 * The original tick interval of the character itself.
+	 */
+	float ActorTickInterval;
+
+	/**
+	 * The original tick interval of the movement component of the character.
+	 */
+	float MovementTickInterval;
+
+	/**
+	 * The original setting for whether the mesh of the character ticks its pose when it is not rendered.
+	 */
+	EVisibilityBasedAnimTickOption MeshVisibilityBasedAnimTickOption;
+
+	/**
+	 * The original setting for whether the mesh of the character uses animation update rate optimizations.
+	 */
+	bool bMeshEnableUpdateRateOptimizations;
+
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor for FOpenPF2PlaygroundTickBudgetEntry.
+	 */
+	explicit FOpenPF2PlaygroundTickBudgetEntry() :
+		Significance(EOpenPF2PlaygroundTickSignificance::Full),
+		ActorTickInterval(0.0f),
+		MovementTickInterval(0.0f),
+		MeshVisibilityBasedAnimTickOption(EVisibilityBasedAnimTickOption::AlwaysTickPose),
+		bMeshEnableUpdateRateOptimizations(false)
+	{
+	}
+};
+
+/**
+ * A world subsystem that throttles how often characters tick, based on the mode of play and who is being controlled.
+ *
+ * Only a handful of characters need to tick at full rate at any given time:
+ *  - In Exploration mode, the character that a player possesses, plus party members that are moving on-screen.
+ *  - In Encounter mode, the combatant whose turn it is, as reported by the game state.
+ *
+ * The encounter rule set reports whose turn it is by calling AOpenPF2PlaygroundGameState::SetActiveCombatant() at the
+ * start of each turn (the headless simulation does this natively; the Blueprint encounter rule set of the sample has to
+ * be updated to do the same). Until a turn has been reported, any combatant that is moving or playing a montage is
+ * assumed to be taking its turn and ticks at full rate, so that an encounter rule set that does not report turns is
+ * never throttled in the middle of a turn.
+ *
+ * On clients and listen servers, the characters that a local player is viewing or can control are never throttled,
+ * since those are the characters that the player is watching most closely, even if they are not currently possessed.
+ *
+ * Every other character is either idle or waiting for its turn (and ticks at a reduced rate with animation update rate
+ * optimizations enabled), or is off-screen (and ticks rarely, only animating montages). Characters are re-evaluated
+ * round-robin, spending no more than a configurable amount of game thread time per frame. Characters whose controller
+ * changes, and the combatants whose turn starts or ends, are re-evaluated immediately.
+ */
+UCLASS(Config=Game)
+class OPENPF2PLAYGROUND_API UOpenPF2PlaygroundTickBudgetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	// =================================================================================================================
+	// Protected Fields
+	// =================================================================================================================
+	/**
+	 * Whether characters should be throttled at all. If this is false, every character ticks at full rate.
+	 */
+	UPROPERTY(Config)
+	bool bEnableTickBudgeting;
+
+	/**
+	 * The most game thread time (in milliseconds) to spend re-evaluating characters each frame.
+	 *
+	 * At least one character is re-evaluated per frame, regardless of this budget.
+	 */
+	UPROPERTY(Config)
+	float GameThreadBudgetMs;
+
+	/**
+	 * The tick interval (in seconds) of characters that are idle or waiting for their turn.
+	 */
+	UPROPERTY(Config)
+	float ReducedTickInterval;
+
+	/**
+	 * The tick interval (in seconds) of characters that are off-screen.
+	 */
+	UPROPERTY(Config)
+	float MinimalTickInterval;
+
+	/**
+	 * The speed (in cm/s) below which a character is considered to be idle.
+	 */
+	UPROPERTY(Config)
+	float IdleSpeedThreshold;
+
+	/**
+	 * How long (in seconds) after a character was last rendered that it is considered to be off-screen.
+	 */
+	UPROPERTY(Config)
+	float OffScreenTimeout;
+
+	/**
+	 * The characters being managed.
+	 */
+	UPROPERTY()
+	TArray<FOpenPF2PlaygroundTickBudgetEntry> Entries;
+
+	/**
+	 * The combatant whose turn it is in the current encounter (if any).
+	 */
+	UPROPERTY()
+	TWeakObjectPtr<AActor> ActiveCombatant;
+
+	/**
+	 * The game state to which this subsystem is listening for the start of each turn.
+	 *
+	 * On clients, the game state replicates after this subsystem is created, so this is bound lazily.
+	 */
+	UPROPERTY()
+	TWeakObjectPtr<AOpenPF2PlaygroundGameState> BoundGameState;
+
+	/**
+	 * The characters that local players are viewing or can control, refreshed once per frame.
+	 *
+	 * These are only compared against, never dereferenced.
+	 */
+	TArray<const AActor*> LocallyRelevantCharacters;
+
+	/**
+	 * The mode of play as of the last frame, to detect when it changes.
+	 */
+	EPF2ModeOfPlayType LastModeOfPlay;
+
+	/**
+	 * The index of the next entry to re-evaluate.
+	 */
+	int32 NextEntryIndex;
+
+public:
+	// =================================================================================================================
+	// Public Constructors
+	// =================================================================================================================
+	/**
+	 * Default constructor.
+	 */
+	explicit UOpenPF2PlaygroundTickBudgetSubsystem() :
+		bEnableTickBudgeting(true),
+		GameThreadBudgetMs(0.1f),
+		ReducedTickInterval(0.1f),
+		MinimalTickInterval(0.25f),
+		IdleSpeedThreshold(10.0f),
+		OffScreenTimeout(0.5f),
+		LastModeOfPlay(EPF2ModeOfPlayType::None),
+		NextEntryIndex(0)
+	{
+	}
+
+	// =================================================================================================================
+	// Public Methods - USubsystem Overrides
+	// =================================================================================================================
+	virtual void Deinitialize() override;
+
+	// =================================================================================================================
+	// Public Methods - FTickableGameObject Overrides
+	// =================================================================================================================
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	// =================================================================================================================
+	// Public Methods
+	// =================================================================================================================
+	/**
+	 * Starts managing how often the given character ticks.
+	 *
+	 * @param Character
+	 *	The character to manage.
+	 */
+	void RegisterCharacter(AOpenPF2PlaygroundCharacterBase* Character);
+
+	/**
+	 * Stops managing how often the given character ticks, restoring its original tick settings.
+	 *
+	 * @param Character
+	 *	The character to stop managing.
+	 */
+	void UnregisterCharacter(AOpenPF2PlaygroundCharacterBase* Character);
+
+	/**
+	 * Re-evaluates how often the given character should tick right away, rather than waiting for its turn.
+	 *
+	 * @param Character
+	 *	The character to re-evaluate.
+	 */
+	void RequestEvaluation(const AOpenPF2PlaygroundCharacterBase* Character);
+
+	/**
+	 * Gets the significance that was last applied to the given character.
+	 *
+	 * @param Character
+	 *	The character for which significance is desired.
+	 *
+	 * @return
+	 *	The significance of the character; or, Full if the character is not being managed.
+	 */
+	UFUNCTION(BlueprintPure, Category="OpenPF2 Playground|Performance")
+	EOpenPF2PlaygroundTickSignificance GetSignificance(const AOpenPF2PlaygroundCharacterBase* Character) const;
+
+protected:
+	// =================================================================================================================
+	// Protected Methods
+	// =================================================================================================================
+	/**
+	 * Gets the current mode of play.
+	 *
+	 * @return
+	 *	The current mode of play; or, EPF2ModeOfPlayType::None if the game state is not compatible with OpenPF2.
+	 */
+	EPF2ModeOfPlayType GetModeOfPlay() const;
+
+	/**
+	 * Starts listening for the start of each turn, if the game state has changed since the last frame.
+	 */
+	void BindToGameState();
+
+	/**
+	 * Refreshes the list of characters that local players are viewing or can control.
+	 */
+	void UpdateLocallyRelevantCharacters();
+
+	/**
+	 * Finds the entry for the given character.
+	 *
+	 * @param Character
+	 *	The character to find.
+	 *
+	 * @return
+	 *	The index of the entry for the character; or, INDEX_NONE if the character is not being managed.
+	 */
+	int32 FindEntryIndex(const AOpenPF2PlaygroundCharacterBase* Character) const;
+
+	/**
+	 * Determines how often the given character should tick.
+	 *
+	 * @param Character
+	 *	The character to evaluate.
+	 * @param ModeOfPlay
+	 *	The current mode of play.
+	 *
+	 * @return
+	 *	The significance of the character.
+	 */
+	EOpenPF2PlaygroundTickSignificance EvaluateSignificance(const AOpenPF2PlaygroundCharacterBase* Character,
+	                                                        const EPF2ModeOfPlayType               ModeOfPlay) const;
+
+	/**
+	 * Re-evaluates the significance of the entry at the given index, and applies it if it has changed.
+	 *
+	 * @param EntryIndex
+	 *	The index of the entry to re-evaluate.
+	 * @param ModeOfPlay
+	 *	The current mode of play.
+	 *
+	 * @return
+	 *	false if the character of the entry no longer exists (and the entry should be removed); or, true otherwise.
+	 */
+	bool EvaluateEntry(const int32 EntryIndex, const EPF2ModeOfPlayType ModeOfPlay);
+
+	/**
+	 * Applies tick settings to a character according to the given significance.
+	 *
+	 * @param Entry
+	 *	The entry of the character, which holds its original tick settings.
+	 * @param Significance
+	 *	The significance to apply.
+	 */
+	void ApplySignificance(FOpenPF2PlaygroundTickBudgetEntry&       Entry,
+	                       const EOpenPF2PlaygroundTickSignificance Significance) const;
+
+	// =================================================================================================================
+	// Protected Native Event Callbacks
+	// =================================================================================================================
+	/**
+	 * Native callback invoked by the game state when the turn of a combatant starts, or when no combatant is taking a
+	 * turn any longer.
+	 *
+	 * The combatant whose turn it is ticks at full rate for its turn.
+	 *
+	 * @param InActiveCombatant
+	 *	The combatant whose turn it now is; or, nullptr if no combatant is taking a turn.
+	 */
+	UFUNCTION()
+	void Native_OnActiveCombatantChanged(AActor* InActiveCombatant);
+};
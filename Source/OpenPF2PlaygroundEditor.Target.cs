@@ -13,5 +13,6 @@ public class OpenPF2PlaygroundEditorTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V4;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_3;
 		ExtraModuleNames.Add("OpenPF2Playground");
+		bWithPushModel = true;
 	}
 }
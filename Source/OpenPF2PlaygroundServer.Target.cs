@@ -0,0 +1,20 @@
+// OpenPF2 for UE Game Logic, Copyright 2024, Guy Elsmore-Paddock. All Rights Reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0. If a copy of the MPL was not
+// distributed with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+using UnrealBuildTool;
+
+public class OpenPF2PlaygroundServerTarget : TargetRules
+{
+	public OpenPF2PlaygroundServerTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Server;
+		DefaultBuildSettings = BuildSettingsVersion.V4;
+		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_3;
+		ExtraModuleNames.Add("OpenPF2Playground");
+		bWithPushModel = true;
+
+		OpenPF2PlaygroundTarget.ConfigurePrecompiledGameplayTags(this, Target);
+	}
+}